@@ -19,6 +19,13 @@
 CargoPacketPool _cargopacket_pool("CargoPacket");
 INSTANTIATE_POOL_METHODS(CargoPacket)
 
+/**
+ * Number of times cargo on vehicles has aged, i.e. number of 185 tick periods
+ * passed. Aging packets derive their days in transit from it, so that aging
+ * doesn't need to touch every packet.
+ */
+uint32 _cargo_age_epoch;
+
 /**
  * Initialize, i.e. clean, the pool with cargo packets.
  */
@@ -32,6 +39,7 @@ void InitializeCargoPackets()
  */
 CargoPacket::CargoPacket()
 {
+	this->age_epoch   = NOT_AGING;
 	this->source_type = ST_INDUSTRY;
 	this->source_id   = INVALID_SOURCE;
 }
@@ -48,6 +56,7 @@ CargoPacket::CargoPacket()
  * that, in contrary to all other pools, does not memset to 0.
  */
 CargoPacket::CargoPacket(StationID source, TileIndex source_xy, uint16 count, SourceType source_type, SourceID source_id) :
+	age_epoch(NOT_AGING),
 	feeder_share(0),
 	count(count),
 	days_in_transit(0),
@@ -75,6 +84,7 @@ CargoPacket::CargoPacket(StationID source, TileIndex source_xy, uint16 count, So
  * that, in contrary to all other pools, does not memset to 0.
  */
 CargoPacket::CargoPacket(uint16 count, byte days_in_transit, StationID source, TileIndex source_xy, TileIndex loaded_at_xy, Money feeder_share, SourceType source_type, SourceID source_id) :
+		age_epoch(NOT_AGING),
 		feeder_share(feeder_share),
 		count(count),
 		days_in_transit(days_in_transit),
@@ -97,7 +107,7 @@ FORCEINLINE CargoPacket *CargoPacket::Split(uint new_size)
 	if (!CargoPacket::CanAllocateItem()) return NULL;
 
 	Money fs = this->feeder_share * new_size / static_cast<uint>(this->count);
-	CargoPacket *cp_new = new CargoPacket(new_size, this->days_in_transit, this->source, this->source_xy, this->loaded_at_xy, fs, this->source_type, this->source_id);
+	CargoPacket *cp_new = new CargoPacket(new_size, this->DaysInTransit(), this->source, this->source_xy, this->loaded_at_xy, fs, this->source_type, this->source_id);
 	this->feeder_share -= fs;
 	this->count -= new_size;
 	return cp_new;
@@ -158,26 +168,24 @@ CargoList<Tinst, Tcont>::~CargoList()
 
 /**
  * Update the cached values to reflect the removal of this packet.
- * Decreases count and days_in_transit.
+ * Decreases count.
  * @param cp Packet to be removed from cache.
  */
 template <class Tinst, class Tcont>
 void CargoList<Tinst, Tcont>::RemoveFromCache(const CargoPacket *cp)
 {
-	this->count                 -= cp->count;
-	this->cargo_days_in_transit -= cp->days_in_transit * cp->count;
+	this->count -= cp->count;
 }
 
 /**
  * Update the cache to reflect adding of this packet.
- * Increases count and days_in_transit.
+ * Increases count.
  * @param cp New packet to be inserted.
  */
 template <class Tinst, class Tcont>
 void CargoList<Tinst, Tcont>::AddToCache(const CargoPacket *cp)
 {
-	this->count                 += cp->count;
-	this->cargo_days_in_transit += cp->days_in_transit * cp->count;
+	this->count += cp->count;
 }
 
 /**
@@ -194,6 +202,7 @@ void VehicleCargoList::Append(CargoPacket *cp, bool update_cache)
 {
 	assert(cp != NULL);
 	if (update_cache) this->AddToCache(cp);
+	cp->StartAging();
 	for (CargoPacketList::reverse_iterator it(this->packets.rbegin()); it != this->packets.rend(); it++) {
 		CargoPacket *icp = *it;
 		if (VehicleCargoList::AreMergable(icp, cp) && icp->count + cp->count <= CargoPacket::MAX_COUNT) {
@@ -226,10 +235,9 @@ void CargoList<Tinst, Tcont>::Truncate(uint max_remaining)
 
 		uint local_count = cp->count;
 		if (local_count > max_remaining) {
-			uint diff = local_count - max_remaining;
-			this->count -= diff;
-			this->cargo_days_in_transit -= cp->days_in_transit * diff;
+			static_cast<Tinst *>(this)->RemoveFromCache(cp);
 			cp->count = max_remaining;
+			static_cast<Tinst *>(this)->AddToCache(cp);
 			max_remaining = 0;
 		} else {
 			max_remaining -= local_count;
@@ -308,7 +316,7 @@ uint VehicleCargoList::LoadReserved(uint max_move)
 template<class Tinst, class Tcont>
 uint CargoList<Tinst, Tcont>::MovePacket(VehicleCargoList *dest, Iterator &it, uint cap, TileIndex load_place, bool reserve)
 {
-	CargoPacket *packet = this->RemovePacket(it, cap, load_place);
+	CargoPacket *packet = static_cast<Tinst *>(this)->RemovePacket(it, cap, load_place);
 	uint ret = packet->count;
 	if (reserve) {
 		dest->Reserve(packet);
@@ -330,7 +338,7 @@ uint CargoList<Tinst, Tcont>::MovePacket(VehicleCargoList *dest, Iterator &it, u
 template<class Tinst, class Tcont>
 uint CargoList<Tinst, Tcont>::MovePacket(StationCargoList *dest, StationID next, Iterator &it, uint cap)
 {
-	CargoPacket *packet = this->RemovePacket(it, cap);
+	CargoPacket *packet = static_cast<Tinst *>(this)->RemovePacket(it, cap);
 	uint ret = packet->count;
 	dest->Append(next, packet);
 	return ret;
@@ -359,10 +367,9 @@ CargoPacket *CargoList<Tinst, Tcont>::RemovePacket(Iterator &it, uint cap, TileI
 		 */
 		if (packet == NULL) {
 			packet = *it;
-			uint dropped = packet->count - cap;
-			this->count -= dropped;
-			this->cargo_days_in_transit -= dropped * packet->days_in_transit; 
+			static_cast<Tinst *>(this)->RemoveFromCache(packet);
 			packet->count = cap;
+			static_cast<Tinst *>(this)->AddToCache(packet);
 			this->packets.erase(it++);
 		} else {
 			assert(packet->count == cap);
@@ -372,6 +379,7 @@ CargoPacket *CargoList<Tinst, Tcont>::RemovePacket(Iterator &it, uint cap, TileI
 		this->packets.erase(it++);
 	}
 	static_cast<Tinst *>(this)->RemoveFromCache(packet);
+	packet->StopAging();
 	if (load_place != INVALID_TILE) {
 		packet->loaded_at_xy = load_place;
 	}
@@ -385,7 +393,6 @@ template <class Tinst, class Tcont>
 void CargoList<Tinst, Tcont>::InvalidateCache()
 {
 	this->count = 0;
-	this->cargo_days_in_transit = 0;
 
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		static_cast<Tinst *>(this)->AddToCache(*it);
@@ -423,7 +430,7 @@ uint VehicleCargoList::DeliverPacket(Iterator &it, uint cap, CargoPayment *payme
 	} else {
 		payment->PayFinalDelivery(p, cap);
 		this->count -= cap;
-		this->cargo_days_in_transit -= cap * p->days_in_transit;
+		this->cargo_days_in_transit -= cap * p->DaysInTransit();
 		this->feeder_share -= p->feeder_share;
 		p->feeder_share = 0;
 		p->count -= cap;
@@ -442,6 +449,7 @@ uint VehicleCargoList::DeliverPacket(Iterator &it, uint cap, CargoPayment *payme
 uint VehicleCargoList::KeepPacket(Iterator &it)
 {
 	CargoPacket *cp = *it;
+	cp->StopAging();
 	this->reserved.push_back(cp);
 	this->reserved_count += cp->count;
 	this->packets.erase(it++);
@@ -566,6 +574,7 @@ void VehicleCargoList::SwapReserved()
 	assert(this->packets.empty());
 	this->packets.swap(this->reserved);
 	this->reserved_count = 0;
+	this->StartAging();
 }
 
 /**
@@ -599,9 +608,8 @@ uint StationCargoList::TakeFrom(VehicleCargoList *source, uint max_unload, Order
 
 	for (VehicleCargoList::Iterator c = source->packets.begin(); c != source->packets.end() && remaining_unload > 0;) {
 		StationID cargo_source = (*c)->source;
-		FlowStatSet &flows = dest->flows[cargo_source];
-		FlowStatSet::iterator begin = flows.begin();
-		StationID via = (begin != flows.end() ? begin->Via() : INVALID_STATION);
+		FlowStatMap::iterator flows = dest->flows.find(cargo_source);
+		StationID via = (flows != dest->flows.end() ? flows->second.GetVia() : INVALID_STATION);
 		if (via != INVALID_STATION && next != INVALID_STATION) {
 			/* use cargodist unloading*/
 			action = this->WillUnloadCargoDist(flags, next, via, cargo_source);
@@ -613,34 +621,20 @@ uint StationCargoList::TakeFrom(VehicleCargoList *source, uint max_unload, Order
 		switch (action) {
 			case UL_DELIVER:
 				unloaded = source->DeliverPacket(c, remaining_unload, payment);
-				if (via != INVALID_STATION) {
-					if (via == this->station->index) {
-						dest->UpdateFlowStats(flows, begin, unloaded);
-					} else {
-						dest->UpdateFlowStats(flows, unloaded, this->station->index);
-					}
-				}
+				if (via != INVALID_STATION) flows->second.Increase(this->station->index, unloaded);
 				remaining_unload -= unloaded;
 				break;
 			case UL_TRANSFER:
 				/* TransferPacket may split the packet and return the transferred part */
-				if (via == this->station->index) {
-					via = (++begin != flows.end()) ? begin->Via() : INVALID_STATION;
-				}
+				if (via == this->station->index) via = flows->second.GetVia(via);
 				unloaded = source->TransferPacket(c, remaining_unload, this, payment, via);
-				if (via != INVALID_STATION) {
-					dest->UpdateFlowStats(flows, begin, unloaded);
-				}
+				if (via != INVALID_STATION) flows->second.Increase(via, unloaded);
 				remaining_unload -= unloaded;
 				break;
 			case UL_KEEP:
 				unloaded = source->KeepPacket(c);
 				if (via != INVALID_STATION && next != INVALID_STATION && !has_stopped) {
-					if (via == next) {
-						dest->UpdateFlowStats(flows, begin, unloaded);
-					} else {
-						dest->UpdateFlowStats(flows, unloaded, next);
-					}
+					flows->second.Increase(next, unloaded);
 				}
 				break;
 			default:
@@ -658,6 +652,7 @@ uint StationCargoList::TakeFrom(VehicleCargoList *source, uint max_unload, Order
 void VehicleCargoList::RemoveFromCache(const CargoPacket *cp)
 {
 	this->feeder_share -= cp->feeder_share;
+	this->cargo_days_in_transit -= cp->DaysInTransit() * cp->count;
 	this->Parent::RemoveFromCache(cp);
 }
 
@@ -669,6 +664,7 @@ void VehicleCargoList::RemoveFromCache(const CargoPacket *cp)
 void VehicleCargoList::AddToCache(const CargoPacket *cp)
 {
 	this->feeder_share += cp->feeder_share;
+	this->cargo_days_in_transit += cp->DaysInTransit() * cp->count;
 	this->Parent::AddToCache(cp);
 }
 
@@ -689,18 +685,38 @@ uint VehicleCargoList::MoveTo(VehicleCargoList *dest, uint cap)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Let all cargo loaded on the vehicle age from now on. Reserved cargo doesn't
+ * age as it is still waiting at the station.
  */
-void VehicleCargoList::AgeCargo()
+void VehicleCargoList::StartAging()
 {
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
-		CargoPacket *cp = *it;
-		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
+		(*it)->StartAging();
+	}
+}
+
+/**
+ * Returns average number of days in transit for a cargo entity. The sum of
+ * the days in transit is cached, but the packets age without touching the
+ * list. So it is summed up again the first time it is asked for after the
+ * cargo aged, i.e. at most once per 185 ticks.
+ * @return The before mentioned number.
+ */
+uint VehicleCargoList::DaysInTransit() const
+{
+	if (this->count == 0) return 0;
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+	if (this->days_in_transit_epoch != _cargo_age_epoch) {
+		this->cargo_days_in_transit = 0;
+		for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
+			this->cargo_days_in_transit += (*it)->DaysInTransit() * (*it)->count;
+		}
+		for (ConstIterator it(this->reserved.begin()); it != this->reserved.end(); it++) {
+			this->cargo_days_in_transit += (*it)->DaysInTransit() * (*it)->count;
+		}
+		this->days_in_transit_epoch = _cargo_age_epoch;
 	}
+	return this->cargo_days_in_transit / this->count;
 }
 
 /*
@@ -729,6 +745,28 @@ FORCEINLINE byte StationCargoList::GetUnloadFlags(OrderUnloadFlags order_flags)
 	return flags;
 }
 
+/**
+ * Update the cached values to reflect the removal of this packet.
+ * Decreases count and days_in_transit.
+ * @param cp Packet to be removed from cache.
+ */
+void StationCargoList::RemoveFromCache(const CargoPacket *cp)
+{
+	this->cargo_days_in_transit -= cp->days_in_transit * cp->count;
+	this->Parent::RemoveFromCache(cp);
+}
+
+/**
+ * Update the cache to reflect adding of this packet.
+ * Increases count and days_in_transit.
+ * @param cp New packet to be inserted.
+ */
+void StationCargoList::AddToCache(const CargoPacket *cp)
+{
+	this->cargo_days_in_transit += cp->days_in_transit * cp->count;
+	this->Parent::AddToCache(cp);
+}
+
 /**
  * Appends the given cargo packet to the range of packets with the same next station
  * @warning After appending this packet may not exist anymore!
@@ -741,18 +779,50 @@ void StationCargoList::Append(StationID next, CargoPacket *cp)
 {
 	assert(cp != NULL);
 	this->AddToCache(cp);
+	this->packets.Append(next, cp);
+}
 
-	StationCargoPacketMap::List &list = this->packets[next];
-	for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin()); it != list.rend(); it++) {
-		CargoPacket *icp = *it;
-		if (StationCargoList::AreMergable(icp, cp) && icp->count + cp->count <= CargoPacket::MAX_COUNT) {
-			icp->Merge(cp);
-			return;
+/**
+ * Remove a single packet or part of it from this list and increment the given
+ * iterator. Does the same as CargoList::RemovePacket, but also keeps the
+ * amounts of cargo per next hop up to date.
+ * @param it Iterator pointing to the packet.
+ * @param cap Maximum amount of cargo to be moved.
+ * @param load_place New loaded_at for the packet or INVALID_TILE if the current
+ *        one shall be kept.
+ * @return Removed packet.
+ */
+CargoPacket *StationCargoList::RemovePacket(Iterator &it, uint cap, TileIndex load_place)
+{
+	CargoPacket *packet = *it;
+	StationCargoPacketMap::Hop &hop = it.GetMapIter()->second;
+	if (packet->count > cap) {
+		packet = packet->Split(cap);
+
+		/* We could not allocate a CargoPacket? Is the map that full?
+		 * Just remove the whole packet and drop some cargo then.
+		 */
+		if (packet == NULL) {
+			packet = *it;
+			uint dropped = packet->count - cap;
+			this->count -= dropped;
+			this->cargo_days_in_transit -= dropped * packet->days_in_transit;
+			hop.count -= dropped;
+			packet->count = cap;
+			it = this->packets.erase(it);
+		} else {
+			assert(packet->count == cap);
+			hop.count -= cap;
+			++it;
 		}
+	} else {
+		it = this->packets.erase(it);
 	}
-
-	/* The packet could not be merged with another one */
-	list.push_back(cp);
+	this->RemoveFromCache(packet);
+	if (load_place != INVALID_TILE) {
+		packet->loaded_at_xy = load_place;
+	}
+	return packet;
 }
 
 /**
@@ -803,62 +873,118 @@ uint StationCargoList::MoveTo(VehicleCargoList *dest, uint cap, StationID next,
  */
 void StationCargoList::RerouteStalePackets(StationID to)
 {
-	std::pair<Iterator, Iterator> range(this->packets.equal_range(to));
-	for (Iterator it(range.first); it != range.second && it.GetKey() == to;) {
+	StationCargoPacketMap::PacketDeque stale;
+	this->packets.RemoveHop(to, stale);
+	for (StationCargoPacketMap::PacketDeque::iterator it(stale.begin()); it != stale.end(); ++it) {
 		CargoPacket *packet = *it;
-		this->packets.erase(it++);
 		StationID next = this->station->goods[this->cargo].UpdateFlowStatsTransfer(packet->source, packet->count, this->station->index);
 		assert(next != to);
-
-		/* legal, as insert doesn't invalidate iterators in the MultiMap, however
-		 * this might insert the packet between range.first and range.second (which might be end())
-		 * This is why we check for GetKey above to avoid infinite loops
-		 */
-		this->packets.Insert(next, packet);
+		this->packets.Append(next, packet);
 	}
 }
 
 /**
  * Truncate where each destination loses roughly the same percentage of its cargo.
  * This is done by randomizing the selection of packets to be removed. Also count
- * the cargo by origin station.
+ * the cargo by origin station. The packets of each hop are compacted in a single
+ * pass instead of being erased one by one.
  * @param max_remaining Maximum amount of cargo to keep in the station.
  * @param cargo_per_source Container for counting the cargo by origin list.
  */
 void StationCargoList::CountAndTruncate(uint max_remaining, StationCargoAmountMap &cargo_per_source)
 {
+	StationCargoPacketMap::HopMap &hops = this->packets.hops;
 	uint prev_count = this->count;
 	uint loop = 0;
 	while (this->count > max_remaining) {
-		for (Iterator it(this->packets.begin()); it != this->packets.end();) {
-			CargoPacket *packet = *it;
-			if (loop == 0) cargo_per_source[packet->source] += packet->count;
+		for (StationCargoPacketMap::HopMap::iterator hop_it(hops.begin()); hop_it != hops.end();) {
+			StationCargoPacketMap::Hop &hop = hop_it->second;
+			StationCargoPacketMap::PacketDeque::iterator kept(hop.packets.begin());
+			StationCargoPacketMap::PacketDeque::iterator it(hop.packets.begin());
+			bool done = false;
+			while (it != hop.packets.end() && !done) {
+				CargoPacket *packet = *it++;
+				if (loop == 0) cargo_per_source[packet->source] += packet->count;
 
-			if (RandomRange(prev_count) < max_remaining) {
-				++it;
-				continue;
+				if (RandomRange(prev_count) >= max_remaining) {
+					uint diff = this->count - max_remaining;
+					if (packet->count > diff) {
+						packet->count -= diff;
+						hop.count -= diff;
+						this->count = max_remaining;
+						this->cargo_days_in_transit -= packet->days_in_transit * diff;
+						done = (loop > 0);
+					} else {
+						hop.count -= packet->count;
+						this->RemoveFromCache(packet);
+						delete packet;
+						continue;
+					}
+				}
+				*kept++ = packet;
 			}
 
-			uint diff = this->count - max_remaining;
-			if (packet->count > diff) {
-				packet->count -= diff;
-				this->count = max_remaining;
-				this->cargo_days_in_transit -= packet->days_in_transit * diff;
-				if (loop > 0) {
-					return;
-				} else {
-					++it;
-				}
+			hop.packets.erase(kept, it);
+			if (hop.packets.empty()) {
+				hops.erase(hop_it++);
 			} else {
-				this->packets.erase(it++);
-				this->RemoveFromCache(packet);
-				delete packet;
+				++hop_it;
 			}
+			if (done) return;
 		}
 		loop++;
 	}
 }
 
+/**
+ * Truncates the cargo in this list to the given amount. It leaves the
+ * first count cargo entities and removes the rest.
+ * @param max_remaining Maximum amount of entities to be in the list after the command.
+ */
+void StationCargoList::Truncate(uint max_remaining)
+{
+	StationCargoPacketMap::HopMap &hops = this->packets.hops;
+	for (StationCargoPacketMap::HopMap::iterator hop_it(hops.begin()); hop_it != hops.end();) {
+		StationCargoPacketMap::Hop &hop = hop_it->second;
+		StationCargoPacketMap::PacketDeque::iterator it(hop.packets.begin());
+		for (; it != hop.packets.end() && max_remaining > 0; ++it) {
+			CargoPacket *cp = *it;
+			if (cp->count > max_remaining) {
+				uint diff = cp->count - max_remaining;
+				this->count -= diff;
+				this->cargo_days_in_transit -= cp->days_in_transit * diff;
+				hop.count -= diff;
+				cp->count = max_remaining;
+			}
+			max_remaining -= cp->count;
+		}
+
+		for (StationCargoPacketMap::PacketDeque::iterator rest(it); rest != hop.packets.end(); ++rest) {
+			hop.count -= (*rest)->count;
+			this->RemoveFromCache(*rest);
+			delete *rest;
+		}
+		hop.packets.erase(it, hop.packets.end());
+
+		if (hop.packets.empty()) {
+			hops.erase(hop_it++);
+		} else {
+			++hop_it;
+		}
+	}
+}
+
+/**
+ * Invalidates the cached data and rebuilds it, including the amounts of cargo
+ * per next hop.
+ */
+void StationCargoList::InvalidateCache()
+{
+	this->cargo_days_in_transit = 0;
+	this->packets.UpdateCounts();
+	this->Parent::InvalidateCache();
+}
+
 /**
  * Invalidates the cached data and rebuilds it.
  */
@@ -866,6 +992,8 @@ void VehicleCargoList::InvalidateCache()
 {
 	this->feeder_share = 0;
 	this->reserved_count = 0;
+	this->cargo_days_in_transit = 0;
+	this->days_in_transit_epoch = _cargo_age_epoch;
 	this->Parent::InvalidateCache();
 	for (ConstIterator it(this->reserved.begin()); it != this->reserved.end(); it++) {
 		this->AddToCache(*it);
@@ -886,6 +1014,111 @@ void StationCargoList::AssignTo(Station *station, CargoID cargo)
 	this->cargo = cargo;
 }
 
+/**
+ * Remove a packet from the container. The amount of cargo for the packet's
+ * next hop is reduced by the packet's count and the hop is removed if it
+ * becomes empty.
+ * @param it Iterator pointing to the packet.
+ * @return Iterator pointing to the packet after the removed one.
+ */
+StationCargoPacketMap::iterator StationCargoPacketMap::erase(iterator it)
+{
+	Hop &hop = it.map_iter->second;
+	hop.count -= hop.packets[it.index]->count;
+	if (it.index == 0) {
+		hop.packets.pop_front();
+	} else if (it.index == hop.packets.size() - 1) {
+		hop.packets.pop_back();
+	} else {
+		hop.packets.erase(hop.packets.begin() + it.index);
+	}
+
+	if (it.index == hop.packets.size()) {
+		if (hop.packets.empty()) {
+			this->hops.erase(it.map_iter++);
+		} else {
+			++it.map_iter;
+		}
+		it.index = 0;
+	}
+	return it;
+}
+
+/**
+ * Append a packet to the ones for a next hop. Tries to merge it with one of
+ * the last few packets of the hop. Only looking at a bounded number of
+ * packets keeps appending in constant time, even at stations with lots of
+ * waiting cargo.
+ * @warning After appending this packet may not exist anymore!
+ * @param next Next hop of the packet.
+ * @param cp Packet to be appended.
+ */
+void StationCargoPacketMap::Append(StationID next, CargoPacket *cp)
+{
+	Hop &hop = this->hops[next];
+	hop.count += cp->count;
+
+	uint distance = 0;
+	for (PacketDeque::reverse_iterator it(hop.packets.rbegin()); it != hop.packets.rend() && distance < MAX_MERGE_DISTANCE; ++it, ++distance) {
+		CargoPacket *icp = *it;
+		if (StationCargoList::AreMergable(icp, cp) && icp->count + cp->count <= CargoPacket::MAX_COUNT) {
+			icp->Merge(cp);
+			return;
+		}
+	}
+
+	/* The packet could not be merged with another one */
+	hop.packets.push_back(cp);
+}
+
+/**
+ * Take all packets for a next hop out of the container.
+ * @param next Next hop to be removed.
+ * @param packets Deque to move the packets to. Its previous contents are lost.
+ */
+void StationCargoPacketMap::RemoveHop(StationID next, PacketDeque &packets)
+{
+	packets.clear();
+	HopMap::iterator it = this->hops.find(next);
+	if (it == this->hops.end()) return;
+	packets.swap(it->second.packets);
+	this->hops.erase(it);
+}
+
+/**
+ * Exchange the packets for a next hop with the ones in a list. This is used
+ * when saving and loading, where the packets may not be valid yet. Therefore
+ * the amounts of cargo per hop are not updated; call UpdateCounts afterwards.
+ * @param next Next hop to be exchanged.
+ * @param packets List with the new packets, receives the old ones.
+ */
+void StationCargoPacketMap::SwapHop(StationID next, std::list<CargoPacket *> &packets)
+{
+	HopMap::iterator it = this->hops.find(next);
+	if (it == this->hops.end()) {
+		if (packets.empty()) return;
+		it = this->hops.insert(std::make_pair(next, Hop())).first;
+	}
+
+	std::list<CargoPacket *> old(it->second.packets.begin(), it->second.packets.end());
+	it->second.packets.assign(packets.begin(), packets.end());
+	packets.swap(old);
+	if (it->second.packets.empty()) this->hops.erase(it);
+}
+
+/**
+ * Recalculate the amounts of cargo for all next hops.
+ */
+void StationCargoPacketMap::UpdateCounts()
+{
+	for (HopMap::iterator it(this->hops.begin()); it != this->hops.end(); ++it) {
+		Hop &hop = it->second;
+		hop.count = 0;
+		for (PacketDeque::const_iterator p(hop.packets.begin()); p != hop.packets.end(); ++p) {
+			hop.count += (*p)->count;
+		}
+	}
+}
 
 /*
  * We have to instantiate everything we want to be usable.
@@ -19,8 +19,9 @@
 #include "cargo_type.h"
 #include "cargotype.h"
 #include "vehicle_type.h"
-#include "core/multimap.hpp"
 #include <list>
+#include <map>
+#include <deque>
 
 /** Unique identifier for a single cargo packet. */
 typedef uint32 CargoPacketID;
@@ -31,6 +32,8 @@ typedef Pool<CargoPacket, CargoPacketID, 1024, 0xFFF000, true, false> CargoPacke
 /** The actual pool with cargo packets. */
 extern CargoPacketPool _cargopacket_pool;
 
+extern uint32 _cargo_age_epoch;
+
 template <class Tinst, class Tcont> class CargoList;
 class StationCargoList; // forward-declare, so we can use it in VehicleCargoList::Unreserve
 class VehicleCargoList; // forward-declare, so we can use it in CargoList::MovePacket
@@ -41,9 +44,10 @@ extern const struct SaveLoad *GetCargoPacketDesc();
  */
 struct CargoPacket : CargoPacketPool::PoolItem<&_cargopacket_pool> {
 private:
+	uint32 age_epoch;           ///< Cargo aging epoch at which days_in_transit was last updated, or NOT_AGING if the packet isn't aging.
 	Money feeder_share;         ///< Value of feeder pickup to be paid for on delivery of cargo.
 	uint16 count;               ///< The amount of cargo in this packet.
-	byte days_in_transit;       ///< Amount of days this packet has been in transit.
+	byte days_in_transit;       ///< Amount of days this packet has been in transit, as of age_epoch.
 	SourceTypeByte source_type; ///< Type of \c source_id.
 	SourceID source_id;         ///< Index of source, INVALID_SOURCE if unknown/invalid.
 	StationID source;           ///< The station where the cargo came from first.
@@ -54,12 +58,16 @@ private:
 	template <class Tinst, class Tcont> friend class CargoList;
 	friend class VehicleCargoList;
 	friend class StationCargoList;
+	friend class StationCargoPacketMap;
 	/** We want this to be saved, right? */
 	friend const struct SaveLoad *GetCargoPacketDesc();
 public:
 	/** Maximum number of items in a single cargo packet. */
 	static const uint16 MAX_COUNT = UINT16_MAX;
 
+	/** Value of age_epoch for packets which aren't aging, i.e. which aren't loaded on a vehicle. */
+	static const uint32 NOT_AGING = UINT32_MAX;
+
 	CargoPacket();
 	CargoPacket(StationID source, TileIndex source_xy, uint16 count, SourceType source_type, SourceID source_id);
 	CargoPacket(uint16 count, byte days_in_transit, StationID source, TileIndex source_xy, TileIndex loaded_at_xy, Money feeder_share = 0, SourceType source_type = ST_INDUSTRY, SourceID source_id = INVALID_SOURCE);
@@ -92,12 +100,42 @@ public:
 	/**
 	 * Gets the number of days this cargo has been in transit.
 	 * This number isn't really in days, but in 2.5 days (185 ticks) and
-	 * it is capped at 255.
+	 * it is capped at 255. While the packet is aging the days passed since
+	 * it was loaded are derived from the cargo aging epoch.
 	 * @return Length this cargo has been in transit.
 	 */
 	FORCEINLINE byte DaysInTransit() const
 	{
-		return this->days_in_transit;
+		if (this->age_epoch == NOT_AGING) return this->days_in_transit;
+		return (byte)min<uint32>(this->days_in_transit + (_cargo_age_epoch - this->age_epoch), 0xFF);
+	}
+
+	/**
+	 * Let the packet age from now on. Does nothing if it is aging already.
+	 */
+	FORCEINLINE void StartAging()
+	{
+		if (this->age_epoch == NOT_AGING) this->age_epoch = _cargo_age_epoch;
+	}
+
+	/**
+	 * Stop aging the packet and store its current age in days_in_transit.
+	 */
+	FORCEINLINE void StopAging()
+	{
+		this->days_in_transit = this->DaysInTransit();
+		this->age_epoch = NOT_AGING;
+	}
+
+	/**
+	 * Store the current age of an aging packet in days_in_transit without
+	 * stopping it from aging, so that it can be saved.
+	 */
+	FORCEINLINE void UpdateDaysInTransit()
+	{
+		if (this->age_epoch == NOT_AGING) return;
+		this->days_in_transit = this->DaysInTransit();
+		this->age_epoch = _cargo_age_epoch;
 	}
 
 	/**
@@ -182,14 +220,9 @@ public:
 	typedef typename Tcont::iterator Iterator;
 	/** Const iterator for our container. */
 	typedef typename Tcont::const_iterator ConstIterator;
-	/** Reverse iterator for our container. */
-	typedef typename Tcont::reverse_iterator ReverseIterator;
-	/** Const reverse iterator for our container. */
-	typedef typename Tcont::const_reverse_iterator ConstReverseIterator;
 
 protected:
 	uint count;                 ///< Cache for the number of cargo entities.
-	uint cargo_days_in_transit; ///< Cache for the sum of number of days in transit of each entity; comparable to man-hours.
 
 	Tcont packets;              ///< The cargo packets in this list.
 
@@ -236,15 +269,6 @@ public:
 		return this->count;
 	}
 
-	/**
-	 * Returns average number of days in transit for a cargo entity.
-	 * @return The before mentioned number.
-	 */
-	FORCEINLINE uint DaysInTransit() const
-	{
-		return this->count == 0 ? 0 : this->cargo_days_in_transit / this->count;
-	}
-
 	void Append(CargoPacket *cp, bool update_cache = true);
 	void Truncate(uint max_remaining);
 
@@ -268,6 +292,8 @@ protected:
 	CargoPacketList reserved; ///< Packets reserved for unloading in this list.
 	Money feeder_share;       ///< Cache for the feeder share.
 	uint reserved_count;      ///< Cache for the number of reserved cargo entities.
+	mutable uint cargo_days_in_transit;   ///< Cache for the sum of number of days in transit of each entity, as of days_in_transit_epoch.
+	mutable uint32 days_in_transit_epoch; ///< Cargo aging epoch cargo_days_in_transit is up to date for, see DaysInTransit().
 
 	void AddToCache(const CargoPacket *cp);
 	void RemoveFromCache(const CargoPacket *cp);
@@ -347,7 +373,9 @@ public:
 
 	void SwapReserved();
 
-	void AgeCargo();
+	void StartAging();
+
+	uint DaysInTransit() const;
 
 	void InvalidateCache();
 
@@ -363,14 +391,214 @@ public:
 	static bool AreMergable(const CargoPacket *cp1, const CargoPacket *cp2)
 	{
 		return cp1->source_xy    == cp2->source_xy &&
-				cp1->days_in_transit == cp2->days_in_transit &&
+				cp1->DaysInTransit() == cp2->DaysInTransit() &&
 				cp1->source_type     == cp2->source_type &&
 				cp1->source_id       == cp2->source_id &&
 				cp1->loaded_at_xy    == cp2->loaded_at_xy;
 	}
 };
 
-typedef MultiMap<StationID, CargoPacket *> StationCargoPacketMap;
+/**
+ * STL-style iterator over the packets in a StationCargoPacketMap. It walks
+ * the packets of each next hop in order and then continues with the next hop.
+ * @tparam Tmap_iter Iterator type for the map of hops.
+ * @tparam Tvalue Type of the packet pointers, possibly const.
+ */
+template <class Tmap_iter, class Tvalue>
+class StationCargoPacketIterator {
+protected:
+	friend class StationCargoPacketMap;
+	template <class Tother_iter, class Tother_value> friend class StationCargoPacketIterator;
+	typedef StationCargoPacketIterator<Tmap_iter, Tvalue> Self;
+
+	Tmap_iter map_iter; ///< Hop the iterator is pointing into.
+	uint index;         ///< Position of the packet in the hop.
+
+public:
+	/** Simple, dangerous constructor to allow later assignment with operator=. */
+	StationCargoPacketIterator() : index(0) {}
+
+	/**
+	 * Create an iterator pointing to a specific packet.
+	 * @param mi Hop the packet belongs to or end() of the map.
+	 * @param index Position of the packet in the hop.
+	 */
+	StationCargoPacketIterator(Tmap_iter mi, uint index = 0) : map_iter(mi), index(index) {}
+
+	/**
+	 * Create a possibly const iterator from a non-const one.
+	 * @param other Iterator to be copied.
+	 */
+	template <class Tother_iter, class Tother_value>
+	StationCargoPacketIterator(const StationCargoPacketIterator<Tother_iter, Tother_value> &other) :
+		map_iter(other.map_iter), index(other.index) {}
+
+	/**
+	 * Dereference operator.
+	 * @return The packet this iterator points to.
+	 */
+	FORCEINLINE Tvalue &operator*() const
+	{
+		return this->map_iter->second.packets[this->index];
+	}
+
+	/**
+	 * Get the next hop of the packet this iterator points to.
+	 * @return ID of the next hop.
+	 */
+	FORCEINLINE StationID GetKey() const
+	{
+		return this->map_iter->first;
+	}
+
+	/**
+	 * Get the iterator of the hop this iterator points into.
+	 * @return Iterator in the map of hops.
+	 */
+	FORCEINLINE const Tmap_iter &GetMapIter() const
+	{
+		return this->map_iter;
+	}
+
+	/**
+	 * Prefix increment operator. Continues with the first packet of the next
+	 * hop after the last packet of a hop.
+	 * @return This iterator.
+	 */
+	Self &operator++()
+	{
+		if (++this->index == this->map_iter->second.packets.size()) {
+			++this->map_iter;
+			this->index = 0;
+		}
+		return *this;
+	}
+
+	/**
+	 * Postfix increment operator.
+	 * @param dummy Unused.
+	 * @return Iterator before incrementing.
+	 */
+	Self operator++(int dummy)
+	{
+		Self tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	/**
+	 * Compare with another iterator.
+	 * @param other Iterator to compare with.
+	 * @return If both point to the same packet.
+	 */
+	template <class Tother_iter, class Tother_value>
+	FORCEINLINE bool operator==(const StationCargoPacketIterator<Tother_iter, Tother_value> &other) const
+	{
+		return this->map_iter == other.map_iter && this->index == other.index;
+	}
+
+	/**
+	 * Compare with another iterator.
+	 * @param other Iterator to compare with.
+	 * @return If both point to different packets.
+	 */
+	template <class Tother_iter, class Tother_value>
+	FORCEINLINE bool operator!=(const StationCargoPacketIterator<Tother_iter, Tother_value> &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/**
+ * Container for the packets waiting at a station, grouped by next hop. The
+ * packets of each hop are kept in a deque so that they are stored in
+ * contiguous blocks instead of individually allocated list nodes, and the
+ * amount of cargo waiting for each hop is kept up to date. There are no hops
+ * without packets.
+ */
+class StationCargoPacketMap {
+public:
+	/** Packets with the same next hop. */
+	typedef std::deque<CargoPacket *> PacketDeque;
+
+	/** All packets with the same next hop and their amount of cargo. */
+	struct Hop {
+		PacketDeque packets; ///< Packets waiting for the hop.
+		uint count;          ///< Sum of the counts of the packets.
+
+		Hop() : count(0) {}
+	};
+
+	typedef std::map<StationID, Hop> HopMap;
+	typedef StationCargoPacketIterator<HopMap::iterator, CargoPacket *> iterator;
+	typedef StationCargoPacketIterator<HopMap::const_iterator, CargoPacket * const> const_iterator;
+
+	/**
+	 * Number of packets at the end of a hop which are checked for merging
+	 * when appending. Looking further back rarely finds anything as packets
+	 * of the same age and origin are usually appended together.
+	 */
+	static const uint MAX_MERGE_DISTANCE = 8;
+
+	FORCEINLINE iterator begin() {return iterator(this->hops.begin());}
+	FORCEINLINE iterator end() {return iterator(this->hops.end());}
+	FORCEINLINE const_iterator begin() const {return const_iterator(this->hops.begin());}
+	FORCEINLINE const_iterator end() const {return const_iterator(this->hops.end());}
+
+	/**
+	 * Check if there are no packets in this container.
+	 * @return If there are no packets.
+	 */
+	FORCEINLINE bool empty() const {return this->hops.empty();}
+
+	/**
+	 * Get the number of next hops with packets.
+	 * @return Number of hops.
+	 */
+	FORCEINLINE uint MapSize() const {return (uint)this->hops.size();}
+
+	/**
+	 * Get the hops of this container.
+	 * @return Map of next hops to packets.
+	 */
+	FORCEINLINE const HopMap &GetHops() const {return this->hops;}
+
+	/**
+	 * Get the amount of cargo waiting for a next hop.
+	 * @param next Next hop.
+	 * @return Sum of the counts of the packets for next.
+	 */
+	FORCEINLINE uint Count(StationID next) const
+	{
+		HopMap::const_iterator it = this->hops.find(next);
+		return it == this->hops.end() ? 0 : it->second.count;
+	}
+
+	/**
+	 * Get the range of packets with a given next hop.
+	 * @param next Next hop.
+	 * @return Begin and end of the range, which are equal if there are no such packets.
+	 */
+	std::pair<iterator, iterator> equal_range(StationID next)
+	{
+		HopMap::iterator it = this->hops.find(next);
+		if (it == this->hops.end()) return std::make_pair(this->end(), this->end());
+		HopMap::iterator upper = it;
+		return std::make_pair(iterator(it), iterator(++upper));
+	}
+
+	iterator erase(iterator it);
+	void Append(StationID next, CargoPacket *cp);
+	void RemoveHop(StationID next, PacketDeque &packets);
+	void SwapHop(StationID next, std::list<CargoPacket *> &packets);
+	void UpdateCounts();
+
+private:
+	friend class StationCargoList;
+
+	HopMap hops; ///< Packets by next hop.
+};
+
 typedef std::map<StationID, uint> StationCargoAmountMap;
 
 /**
@@ -383,6 +611,9 @@ public:
 	/** The stations, via GoodsEntry, have a CargoList. */
 	friend const struct SaveLoad *GetGoodsDesc();
 
+	/** The (direct) parent of this class. */
+	typedef CargoList<StationCargoList, StationCargoPacketMap> Parent;
+
 	StationCargoList() : station(NULL), cargo(INVALID_CARGO) {}
 
 	/**
@@ -410,13 +641,36 @@ public:
 
 	void CountAndTruncate(uint max_remaining, StationCargoAmountMap &cargo_per_source);
 
+	void Truncate(uint max_remaining);
+
+	void InvalidateCache();
+
 	/**
 	 * Returns source of the first cargo packet in this list.
 	 * @return The before mentioned source.
 	 */
 	FORCEINLINE StationID Source() const
 	{
-		return this->Empty() ? INVALID_STATION : this->packets.begin()->second.front()->source;
+		return this->Empty() ? INVALID_STATION : (*this->packets.begin())->source;
+	}
+
+	/**
+	 * Returns average number of days in transit for a cargo entity.
+	 * @return The before mentioned number.
+	 */
+	FORCEINLINE uint DaysInTransit() const
+	{
+		return this->count == 0 ? 0 : this->cargo_days_in_transit / this->count;
+	}
+
+	/**
+	 * Returns the amount of cargo waiting for a specific next hop.
+	 * @param next ID of the next hop.
+	 * @return Amount of cargo with the given next hop.
+	 */
+	FORCEINLINE uint CountForNext(StationID next) const
+	{
+		return this->packets.Count(next);
 	}
 
 	void AssignTo(Station *station, CargoID cargo);
@@ -426,12 +680,18 @@ public:
 protected:
 	Station *station; ///< Station this cargo list belongs to.
 	CargoID cargo;    ///< Cargo type this list holds.
+	uint cargo_days_in_transit; ///< Cache for the sum of number of days in transit of each entity; comparable to man-hours.
+
+	void AddToCache(const CargoPacket *cp);
+	void RemoveFromCache(const CargoPacket *cp);
 
 	byte GetUnloadFlags(OrderUnloadFlags order_flags);
 
 	UnloadType WillUnloadOld(byte flags, StationID source);
 	UnloadType WillUnloadCargoDist(byte flags, StationID next_station, StationID via, StationID source);
 
+	CargoPacket *RemovePacket(Iterator &it, uint cap, TileIndex load_place = INVALID_TILE);
+
 	uint MovePackets(VehicleCargoList *dest, uint cap, Iterator begin, Iterator end, bool reserve);
 };
 
@@ -37,6 +37,13 @@
 #include "newgrf.h"
 #include "console_func.h"
 #include "engine_base.h"
+#include "vehicle_func.h"
+#include "vehicle_base.h"
+#include "linkgraph/benchmark.h"
+#include "tick_profile.h"
+#include "pathfinder/network_components.h"
+#include "pathfinder/pf_query_log.h"
+#include <time.h>
 
 #ifdef ENABLE_NETWORK
 	#include "table/strings.h"
@@ -1768,6 +1775,198 @@ DEF_CONSOLE_CMD(ConNewGRFReload)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConBenchmarkLinkGraph)
+{
+	if (argc == 0 || argc > 3) {
+		IConsoleHelp("Run the link graph calculations on all components of the current game and print how long they took. Usage: 'benchmark_linkgraph [<iterations>] [<json file>]'");
+		IConsoleHelp("Each component is calculated <iterations> times, 1 by default. If <json file> is given the results are also written to that file.");
+		return true;
+	}
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleWarning("The link graph can only be benchmarked in a game.");
+		return true;
+	}
+
+	uint32 iterations = 1;
+	if (argc > 1 && (!GetArgumentInteger(&iterations, argv[1]) || iterations == 0)) return false;
+
+	return BenchmarkLinkGraphs(iterations, argc > 2 ? argv[2] : NULL);
+}
+
+extern void StateGameLoop();
+extern uint64 ottd_rdtsc();
+
+DEF_CONSOLE_CMD(ConBenchmarkTicks)
+{
+	if (argc == 0 || argc > 2) {
+		IConsoleHelp("Run the game as fast as possible for some ticks and print how long they took. Usage: 'benchmark_ticks [<ticks>]'");
+		IConsoleHelp("<ticks> is 1000 by default. The game continues from the state after the benchmark.");
+		return true;
+	}
+
+	if (_game_mode != GM_NORMAL) {
+		IConsoleWarning("Ticks can only be benchmarked in a game.");
+		return true;
+	}
+
+	if (_networking) {
+		IConsoleError("Ticks can't be benchmarked in a multiplayer game.");
+		return true;
+	}
+
+	uint32 ticks = 1000;
+	if (argc > 1 && (!GetArgumentInteger(&ticks, argv[1]) || ticks == 0)) return false;
+
+	time_t start_time = time(NULL);
+	uint64 start = ottd_rdtsc();
+	for (uint32 i = 0; i < ticks; i++) StateGameLoop();
+	uint64 cycles = ottd_rdtsc() - start;
+	uint seconds = (uint)(time(NULL) - start_time);
+
+	size_t vehicles = max<size_t>(Vehicle::GetNumItems(), 1);
+	IConsolePrintF(CC_DEFAULT, "%u ticks with " PRINTF_SIZE " vehicles: " OTTD_PRINTF64 " cycles per tick, " OTTD_PRINTF64 " cycles per tick and vehicle",
+			ticks, Vehicle::GetNumItems(), cycles / ticks, cycles / ticks / vehicles);
+	/* The wall clock only has a resolution of a second, so only report the rate for long runs. */
+	if (seconds > 0) IConsolePrintF(CC_DEFAULT, "%u seconds, %u ticks per second", seconds, ticks / seconds);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConPoolStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the occupancy of all pools and how many items were allocated in them since the last call. Usage: 'pool_stats'");
+		return true;
+	}
+
+	/* Allocations and game tick at the last call, to calculate the allocation rate. */
+	static SmallVector<uint64, 32> last_allocations;
+	static int64 last_tick = -1;
+
+	int64 tick = (int64)_date * DAY_TICKS + _date_fract;
+	int64 ticks = tick - last_tick;
+
+	PoolVector *pools = PoolBase::GetPools();
+	for (uint i = 0; i < pools->Length(); i++) {
+		const PoolBase *pool = *pools->Get(i);
+		if (last_allocations.Length() <= i) *last_allocations.Append() = pool->allocations;
+
+		/* Occupancy of the used range of indexes; low values mean a fragmented pool. */
+		uint occupancy = pool->first_unused == 0 ? 100 : (uint)(pool->items * 100 / pool->first_unused);
+		IConsolePrintF(CC_DEFAULT, "%-24s " PRINTF_SIZE " items, " PRINTF_SIZE " indexes used, " PRINTF_SIZE " allocated, %u%% occupancy, " PRINTF_SIZE " chunks",
+				pool->name, pool->items, pool->first_unused, pool->size, occupancy, pool->chunks);
+
+		uint64 allocations = pool->allocations - *last_allocations.Get(i);
+		if (last_tick >= 0 && ticks > 0) {
+			IConsolePrintF(CC_DEFAULT, "%-24s " OTTD_PRINTF64 " allocations in " OTTD_PRINTF64 " ticks, " OTTD_PRINTF64 " per 1000 ticks",
+					"", allocations, ticks, allocations * 1000 / ticks);
+		}
+		*last_allocations.Get(i) = pool->allocations;
+	}
+	last_tick = tick;
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConVehicleHashStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Show the lengths of the chains in the vehicle position hashes and how many vehicles were visited per lookup since the last call. Usage: 'vehicle_hash_stats'");
+		return true;
+	}
+
+	/* Lookups and visits at the last call, to calculate the averages since then. */
+	static uint64 last_lookups = 0;
+	static uint64 last_visits = 0;
+
+	VehicleHashStats stats[2];
+	GetVehicleHashStats(&stats[0], &stats[1]);
+	static const char * const names[] = {"tile hash", "viewport hash"};
+
+	for (uint i = 0; i < lengthof(stats); i++) {
+		const VehicleHashStats &s = stats[i];
+		/* Average length of the non-empty chains, in hundredths. */
+		uint avg_chain = s.used_buckets == 0 ? 0 : s.vehicles * 100 / s.used_buckets;
+		IConsolePrintF(CC_DEFAULT, "%-14s %u chains, %u used, %u vehicles, average chain %u.%02u, longest chain %u",
+				names[i], s.buckets, s.used_buckets, s.vehicles, avg_chain / 100, avg_chain % 100, s.max_chain);
+	}
+
+	const VehicleHashStats &s = stats[0];
+	IConsolePrintF(CC_DEFAULT, "%-14s blocks of %ux%u tiles", "", s.block_size, s.block_size);
+	uint64 lookups = s.lookups - last_lookups;
+	uint64 visits = s.visits - last_visits;
+	if (lookups > 0) {
+		IConsolePrintF(CC_DEFAULT, "%-14s " OTTD_PRINTF64 " lookups, " OTTD_PRINTF64 ".%02u vehicles visited per lookup",
+				"", lookups, visits / lookups, (uint)(visits * 100 / lookups % 100));
+	}
+	last_lookups = s.lookups;
+	last_visits = s.visits;
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConTickProfile)
+{
+	if (argc == 0 || argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0)) {
+		IConsoleHelp("Show how long the parts of the last game ticks took, in CPU cycles per tick. Usage: 'tick_profile [reset]'");
+		IConsoleHelp("Indented parts are included in the part above them. 'reset' forgets all measurements.");
+		return true;
+	}
+
+	if (argc == 2) {
+		ResetTickProfile();
+		return true;
+	}
+
+	for (TickProfileSection section = TPS_GAME_LOOP; section < TPS_END; section++) {
+		TickProfileStats stats;
+		uint ticks = GetTickProfileStats(section, &stats);
+		if (ticks == 0) {
+			IConsolePrint(CC_DEFAULT, "No ticks have been measured.");
+			return true;
+		}
+		if (section == TPS_GAME_LOOP) IConsolePrintF(CC_DEFAULT, "Last %u ticks:", ticks);
+
+		uint indent = GetTickProfileSectionDepth(section) * 2;
+		IConsolePrintF(CC_DEFAULT, "%*s%-*s min " OTTD_PRINTF64 ", avg " OTTD_PRINTF64 ", max " OTTD_PRINTF64 ", p99 " OTTD_PRINTF64,
+				indent, "", 20 - indent, GetTickProfileSectionName(section),
+				stats.min_cycles, stats.avg_cycles, stats.max_cycles, stats.p99_cycles);
+	}
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConNetworkComponents)
+{
+	if (argc == 0 || argc > 1) {
+		IConsoleHelp("Show into how many unconnected parts the rail and road networks are split. Usage: 'network_components'");
+		IConsoleHelp("Vehicles heading for another part of their network are known to be lost without searching a path.");
+		return true;
+	}
+
+	IConsolePrintF(CC_DEFAULT, "Rail: %u components", GetNetworkComponentCount(TRANSPORT_RAIL));
+	IConsolePrintF(CC_DEFAULT, "Road: %u components", GetNetworkComponentCount(TRANSPORT_ROAD));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConPathfinderRecord)
+{
+	if (argc != 2) {
+		IConsoleHelp("Record the track choices of all trains and road vehicles to a file, to replay them with '-Q'. Usage: 'pf_record <file> | stop'");
+		IConsoleHelp("The queries can only be replayed on the game as it was when the recording started, so save it then too.");
+		return true;
+	}
+
+	if (strcmp(argv[1], "stop") == 0) {
+		if (!StopPathfinderQueryRecording()) IConsoleError("Not recording pathfinder queries.");
+		return true;
+	}
+
+	if (!StartPathfinderQueryRecording(argv[1])) {
+		IConsolePrintF(CC_ERROR, "Cannot write pathfinder queries to '%s'.", argv[1]);
+		return true;
+	}
+	IConsolePrintF(CC_DEFAULT, "Recording pathfinder queries to '%s'.", argv[1]);
+	return true;
+}
+
 #ifdef _DEBUG
 /******************
  *  debug commands
@@ -1822,6 +2021,13 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("list_settings",ConListSettings);
 	IConsoleCmdRegister("gamelog",      ConGamelogPrint);
 	IConsoleCmdRegister("rescan_newgrf", ConRescanNewGRF);
+	IConsoleCmdRegister("benchmark_linkgraph", ConBenchmarkLinkGraph);
+	IConsoleCmdRegister("benchmark_ticks", ConBenchmarkTicks);
+	IConsoleCmdRegister("pool_stats",   ConPoolStats);
+	IConsoleCmdRegister("vehicle_hash_stats", ConVehicleHashStats);
+	IConsoleCmdRegister("tick_profile", ConTickProfile);
+	IConsoleCmdRegister("network_components", ConNetworkComponents);
+	IConsoleCmdRegister("pf_record",    ConPathfinderRecord);
 
 	IConsoleAliasRegister("dir",          "ls");
 	IConsoleAliasRegister("del",          "rm %+");
@@ -0,0 +1,39 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file pool_func.cpp Implementation of PoolBase methods. */
+
+#include "../stdafx.h"
+#include "pool_type.hpp"
+
+/**
+ * Create an empty pool and register it in the vector of all pools.
+ * @param name The name for the pool.
+ */
+PoolBase::PoolBase(const char *name) :
+		name(name),
+		size(0),
+		first_unused(0),
+		items(0),
+		chunks(0),
+		allocations(0)
+{
+	*PoolBase::GetPools()->Append() = this;
+}
+
+/**
+ * Remove the pool from the vector of all pools. The vector itself is
+ * destroyed with the last pool.
+ */
+PoolBase::~PoolBase()
+{
+	PoolVector *pools = PoolBase::GetPools();
+	pools->Erase(pools->Find(this));
+	if (pools->Length() == 0) delete pools;
+}
@@ -14,6 +14,8 @@
 
 #include "alloc_func.hpp"
 #include "mem_func.hpp"
+#include "bitmath_func.hpp"
+#include "math_func.hpp"
 #include "pool_type.hpp"
 
 #define DEFINE_POOL_METHOD(type) \
@@ -25,16 +27,34 @@
  * @param name The name for the pool.
  */
 DEFINE_POOL_METHOD(inline)::Pool(const char *name) :
-		name(name),
-		size(0),
+		PoolBase(name),
 		first_free(0),
-		first_unused(0),
-		items(0),
 		cleaning(false),
 		data(NULL),
-		alloc_cache(NULL)
+		alloc_cache(NULL),
+		chunk_data(NULL),
+		free_bits(NULL),
+		free_words(NULL)
 { }
 
+/**
+ * Marks an index as free or used in the bitmaps of free indexes.
+ * @param index index to mark
+ * @param free whether the index is free now
+ * @pre index < this->size
+ */
+DEFINE_POOL_METHOD(inline void)::SetFree(size_t index, bool free)
+{
+	size_t word = index / 32;
+	if (free) {
+		SetBit(this->free_bits[word], index % 32);
+		SetBit(this->free_words[word / 32], word % 32);
+	} else {
+		ClrBit(this->free_bits[word], index % 32);
+		if (this->free_bits[word] == 0) ClrBit(this->free_words[word / 32], word % 32);
+	}
+}
+
 /**
  * Resizes the pool so 'index' can be addressed
  * @param index index we will allocate later
@@ -51,6 +71,18 @@ DEFINE_POOL_METHOD(inline void)::ResizeFor(size_t index)
 	this->data = ReallocT(this->data, new_size);
 	MemSetT(this->data + this->size, 0, new_size - this->size);
 
+	uint old_words = CeilDiv(this->size, 32);
+	uint new_words = CeilDiv(new_size, 32);
+	this->free_bits = ReallocT(this->free_bits, new_words);
+	MemSetT(this->free_bits + old_words, 0, new_words - old_words);
+
+	uint old_summaries = CeilDiv(old_words, 32);
+	uint new_summaries = CeilDiv(new_words, 32);
+	this->free_words = ReallocT(this->free_words, new_summaries);
+	MemSetT(this->free_words + old_summaries, 0, new_summaries - old_summaries);
+
+	for (size_t i = this->size; i < new_size; i++) this->SetFree(i, true);
+
 	this->size = new_size;
 }
 
@@ -62,15 +94,24 @@ DEFINE_POOL_METHOD(inline size_t)::FindFirstFree()
 {
 	size_t index = this->first_free;
 
-	for (; index < this->first_unused; index++) {
-		if (this->data[index] == NULL) return index;
-	}
-
 	if (index < this->size) {
-		return index;
+		size_t word = index / 32;
+		uint32 bits = this->free_bits[word] & (UINT32_MAX << (index % 32));
+		if (bits == 0) {
+			/* Nothing free in this word; find the next word with a free index. */
+			size_t num_summaries = CeilDiv(CeilDiv(this->size, 32), 32);
+			size_t summary = ++word / 32;
+			uint32 words = (summary < num_summaries) ? (this->free_words[summary] & (UINT32_MAX << (word % 32))) : 0;
+			while (words == 0 && ++summary < num_summaries) words = this->free_words[summary];
+			if (words != 0) {
+				word = summary * 32 + FindFirstBit(words);
+				bits = this->free_bits[word];
+			}
+		}
+		if (bits != 0) return word * 32 + FindFirstBit(bits);
 	}
 
-	assert(index == this->size);
+	index = this->size;
 	assert(this->first_unused == this->size);
 
 	if (index < Tmax_size) {
@@ -83,6 +124,26 @@ DEFINE_POOL_METHOD(inline size_t)::FindFirstFree()
 	return NO_FREE_ITEM;
 }
 
+/**
+ * Allocates a chunk of memory for Tgrowth_step items and puts them into the
+ * cache of free items. Items allocated from the cache then never move and are
+ * close to each other in memory.
+ * @pre Tcache
+ */
+DEFINE_POOL_METHOD(inline void)::AllocateChunk()
+{
+	byte *chunk = MallocT<byte>(Tgrowth_step * sizeof(Titem));
+	this->chunk_data = ReallocT(this->chunk_data, this->chunks + 1);
+	this->chunk_data[this->chunks++] = chunk;
+
+	/* Push the items in reverse order, so that they are taken from the cache in ascending order. */
+	for (size_t i = Tgrowth_step; i-- > 0;) {
+		AllocCache *ac = (AllocCache *)(chunk + i * sizeof(Titem));
+		ac->next = this->alloc_cache;
+		this->alloc_cache = ac;
+	}
+}
+
 /**
  * Makes given index valid
  * @param size size of item
@@ -96,10 +157,13 @@ DEFINE_POOL_METHOD(inline void *)::AllocateItem(size_t size, size_t index)
 
 	this->first_unused = max(this->first_unused, index + 1);
 	this->items++;
+	this->allocations++;
+	this->SetFree(index, false);
 
 	Titem *item;
-	if (Tcache && this->alloc_cache != NULL) {
+	if (Tcache) {
 		assert(sizeof(Titem) == size);
+		if (this->alloc_cache == NULL) this->AllocateChunk();
 		item = (Titem *)this->alloc_cache;
 		this->alloc_cache = this->alloc_cache->next;
 		if (Tzero) MemSetT(item, 0);
@@ -175,6 +239,7 @@ DEFINE_POOL_METHOD(void)::FreeItem(size_t index)
 		free(this->data[index]);
 	}
 	this->data[index] = NULL;
+	this->SetFree(index, true);
 	this->first_free = min(this->first_free, index);
 	this->items--;
 	if (!this->cleaning) Titem::PostDestructor(index);
@@ -189,16 +254,20 @@ DEFINE_POOL_METHOD(void)::CleanPool()
 	}
 	assert(this->items == 0);
 	free(this->data);
+	free(this->free_bits);
+	free(this->free_words);
 	this->first_unused = this->first_free = this->size = 0;
 	this->data = NULL;
+	this->free_bits = NULL;
+	this->free_words = NULL;
 	this->cleaning = false;
 
 	if (Tcache) {
-		while (this->alloc_cache != NULL) {
-			AllocCache *ac = this->alloc_cache;
-			this->alloc_cache = ac->next;
-			free(ac);
-		}
+		for (size_t i = 0; i < this->chunks; i++) free(this->chunk_data[i]);
+		free(this->chunk_data);
+		this->chunk_data = NULL;
+		this->chunks = 0;
+		this->alloc_cache = NULL;
 	}
 }
 
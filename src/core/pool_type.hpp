@@ -12,26 +12,60 @@
 #ifndef POOL_TYPE_HPP
 #define POOL_TYPE_HPP
 
+#include "smallvec_type.hpp"
+
+struct PoolBase;
+/** Vector of all pools. */
+typedef SmallVector<PoolBase *, 32> PoolVector;
+
+/**
+ * Part of all pools which doesn't depend on the pooled type. It is used to
+ * find all pools and to read their statistics.
+ */
+struct PoolBase {
+	const char * const name; ///< Name of this pool
+
+	size_t size;         ///< Current allocated size
+	size_t first_unused; ///< This and all higher indexes are free (doesn't say anything about first_unused-1 !)
+	size_t items;        ///< Number of used indexes (non-NULL)
+	size_t chunks;       ///< Number of chunks allocated to store the items, for pools caching their items
+	uint64 allocations;  ///< Number of items allocated since the game started; not reset when the pool is cleaned
+
+	/**
+	 * Function used to access the vector of all pools.
+	 * @return Pointer to the vector of all pools.
+	 */
+	static PoolVector *GetPools()
+	{
+		static PoolVector *pools = new PoolVector();
+		return pools;
+	}
+
+	PoolBase(const char *name);
+	~PoolBase();
+};
+
 /**
  * Base class for all pools.
  * @tparam Titem        Type of the class/struct that is going to be pooled
  * @tparam Tindex       Type of the index for this pool
  * @tparam Tgrowth_step Size of growths; if the pool is full increase the size by this amount
  * @tparam Tmax_size    Maximum size of the pool
- * @tparam Tcache       Whether to perform 'alloc' caching, i.e. don't actually free/malloc just reuse the memory
+ * @tparam Tcache       Whether to perform 'alloc' caching, i.e. don't actually free/malloc just reuse the memory;
+ *                      the memory is then allocated in chunks of Tgrowth_step items
  * @tparam Tzero        Whether to zero the memory
  * @warning when Tcache is enabled *all* instances of this pool's item must be of the same size.
+ * @note Free indexes are tracked in a two level bitmap, so that finding the
+ *       lowest free index doesn't need to look at every used one. Items are
+ *       always allocated at the lowest free index, so that the indexes only
+ *       depend on the set of used indexes, which is the same after loading
+ *       a savegame.
  */
 template <class Titem, typename Tindex, size_t Tgrowth_step, size_t Tmax_size, bool Tcache = false, bool Tzero = true>
-struct Pool {
+struct Pool : PoolBase {
 	static const size_t MAX_SIZE = Tmax_size; ///< Make template parameter accessible from outside
 
-	const char * const name; ///< Name of this pool
-
-	size_t size;         ///< Current allocated size
 	size_t first_free;   ///< No item with index lower than this is free (doesn't say anything about this one!)
-	size_t first_unused; ///< This and all higher indexes are free (doesn't say anything about first_unused-1 !)
-	size_t items;        ///< Number of used indexes (non-NULL)
 #ifdef OTTD_ASSERT
 	size_t checked;      ///< Number of items we checked for
 #endif /* OTTD_ASSERT */
@@ -242,8 +276,14 @@ private:
 	/** Cache of freed pointers */
 	AllocCache *alloc_cache;
 
+	void **chunk_data;  ///< Memory chunks the cached items are stored in, if Tcache
+	uint32 *free_bits;  ///< Bitmap of the free indexes below size
+	uint32 *free_words; ///< Bitmap of the words in free_bits with at least one free index
+
 	void *AllocateItem(size_t size, size_t index);
+	void AllocateChunk();
 	void ResizeFor(size_t index);
+	void SetFree(size_t index, bool free);
 	size_t FindFirstFree();
 
 	void *GetNew(size_t size);
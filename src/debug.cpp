@@ -34,6 +34,7 @@ int _debug_sprite_level;
 int _debug_oldloader_level;
 int _debug_npf_level;
 int _debug_yapf_level;
+int _debug_linkgraph_level;
 int _debug_freetype_level;
 int _debug_sl_level;
 int _debug_gamelog_level;
@@ -59,6 +60,7 @@ struct DebugLevel {
 	DEBUG_LEVEL(oldloader),
 	DEBUG_LEVEL(npf),
 	DEBUG_LEVEL(yapf),
+	DEBUG_LEVEL(linkgraph),
 	DEBUG_LEVEL(freetype),
 	DEBUG_LEVEL(sl),
 	DEBUG_LEVEL(gamelog),
@@ -46,6 +46,7 @@
 	extern int _debug_oldloader_level;
 	extern int _debug_npf_level;
 	extern int _debug_yapf_level;
+	extern int _debug_linkgraph_level;
 	extern int _debug_freetype_level;
 	extern int _debug_sl_level;
 	extern int _debug_gamelog_level;
@@ -24,6 +24,7 @@
 #include "thread/thread.h"
 #include "window_func.h"
 #include "newgrf_debug.h"
+#include "tick_profile.h"
 
 #include "table/palettes.h"
 #include "table/sprites.h"
@@ -1585,6 +1586,7 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
  */
 void DrawDirtyBlocks()
 {
+	TickProfileTimer timer(TPS_DRAWING);
 	byte *b = _dirty_blocks;
 	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
 	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
@@ -14,6 +14,7 @@
 #include "roadveh.h"
 #include "vehicle_gui.h"
 #include "window_func.h"
+#include "newgrf_engine.h"
 
 /**
  * Recalculates the cached total power of a vehicle. Should be called when the consist is changed.
@@ -22,19 +23,22 @@ template <class T, VehicleType Type>
 void GroundVehicle<T, Type>::PowerChanged()
 {
 	assert(this->First() == this);
-	const T *v = T::From(this);
+	T *v = T::From(this);
 
 	uint32 total_power = 0;
 	uint32 max_te = 0;
 	uint32 number_of_parts = 0;
 	uint16 max_track_speed = v->GetDisplayMaxSpeed();
 
-	for (const T *u = v; u != NULL; u = u->Next()) {
+	for (T *u = v; u != NULL; u = u->Next()) {
 		uint32 current_power = u->GetPower() + u->GetPoweredPartPower(u);
 		total_power += current_power;
+		u->gcache.cached_part_power = current_power;
 
 		/* Only powered parts add tractive effort. */
 		if (current_power > 0) max_te += u->GetWeight() * u->GetTractiveEffort();
+		/* Without callbacks looking up the tractive effort again has no side effects. */
+		if (!u->gcache.cached_has_callbacks) u->gcache.cached_tractive_effort = current_power > 0 ? u->GetTractiveEffort() : 0;
 		number_of_parts++;
 
 		/* Get minimum max speed for this track. */
@@ -57,6 +61,18 @@ void GroundVehicle<T, Type>::PowerChanged()
 
 	this->gcache.cached_air_drag = air_drag + 3 * air_drag * number_of_parts / 20;
 
+	this->UpdatePower(total_power, max_te);
+	this->gcache.cached_max_track_speed = max_track_speed;
+}
+
+/**
+ * Store the total power and tractive effort of a vehicle in its cache.
+ * @param total_power Total power of all parts.
+ * @param max_te Sum of weight times tractive effort coefficient of all powered parts.
+ */
+template <class T, VehicleType Type>
+void GroundVehicle<T, Type>::UpdatePower(uint32 total_power, uint32 max_te)
+{
 	max_te *= 10000; // Tractive effort in (tonnes * 1000 * 10 =) N.
 	max_te /= 256;   // Tractive effort is a [0-255] coefficient.
 	if (this->gcache.cached_power != total_power || this->gcache.cached_max_te != max_te) {
@@ -68,8 +84,6 @@ void GroundVehicle<T, Type>::PowerChanged()
 		SetWindowDirty(WC_VEHICLE_DETAILS, this->index);
 		SetWindowWidgetDirty(WC_VEHICLE_VIEW, this->index, VVW_WIDGET_START_STOP_VEH);
 	}
-
-	this->gcache.cached_max_track_speed = max_track_speed;
 }
 
 /**
@@ -83,7 +97,9 @@ void GroundVehicle<T, Type>::CargoChanged()
 	uint32 weight = 0;
 
 	for (T *u = T::From(this); u != NULL; u = u->Next()) {
+		u->gcache.cached_has_callbacks = HasVehicleCallbacks(u);
 		uint32 current_weight = u->GetWeight();
+		if (!u->gcache.cached_has_callbacks) u->gcache.cached_base_weight = current_weight - u->GetCargoWeight();
 		weight += current_weight;
 		/* Slope steepness is in percent, result in N. */
 		u->gcache.cached_slope_resistance = current_weight * u->GetSlopeSteepness() * 100;
@@ -98,6 +114,46 @@ void GroundVehicle<T, Type>::CargoChanged()
 	this->PowerChanged();
 }
 
+/**
+ * Recalculates the cached weight and power of a vehicle when only the amounts of cargo
+ * in its parts changed, e.g. by loading. Parts without NewGRF callbacks only get the weight
+ * of their cargo updated; their power and tractive effort don't depend on it and are taken
+ * from the cache. The callbacks of the other parts are run in the same order as by
+ * CargoChanged(), so the result is the same. Power and track speed depending on the rail
+ * type are kept up to date by PowerChanged() when the rail type changes.
+ */
+template <class T, VehicleType Type>
+void GroundVehicle<T, Type>::CargoAmountChanged()
+{
+	assert(this->First() == this);
+	uint32 weight = 0;
+
+	for (T *u = T::From(this); u != NULL; u = u->Next()) {
+		uint32 current_weight = u->gcache.cached_has_callbacks ? u->GetWeight() : (uint16)(u->GetCargoWeight() + u->gcache.cached_base_weight);
+		weight += current_weight;
+		/* Slope steepness is in percent, result in N. */
+		u->gcache.cached_slope_resistance = current_weight * u->GetSlopeSteepness() * 100;
+	}
+
+	this->gcache.cached_weight = max<uint32>(1, weight);
+	this->gcache.cached_axle_resistance = 10 * weight;
+
+	uint32 total_power = 0;
+	uint32 max_te = 0;
+	for (T *u = T::From(this); u != NULL; u = u->Next()) {
+		if (u->gcache.cached_has_callbacks) {
+			u->gcache.cached_part_power = u->GetPower() + u->GetPoweredPartPower(u);
+			if (u->gcache.cached_part_power > 0) max_te += u->GetWeight() * u->GetTractiveEffort();
+		} else {
+			uint16 current_weight = u->GetCargoWeight() + u->gcache.cached_base_weight;
+			max_te += current_weight * u->gcache.cached_tractive_effort;
+		}
+		total_power += u->gcache.cached_part_power;
+	}
+
+	this->UpdatePower(total_power, max_te);
+}
+
 /**
  * Calculates the acceleration of the vehicle under its current conditions.
  * @return Current acceleration of the vehicle.
@@ -39,6 +39,12 @@ struct GroundVehicleCache {
 	uint32 cached_power;            ///< Total power of the consist (valid only for the first engine).
 	uint32 cached_air_drag;         ///< Air drag coefficient of the vehicle (valid only for the first engine).
 
+	/* Cached contributions of this vehicle part to the values above, recalculated together with them. */
+	uint32 cached_part_power;       ///< Power of this vehicle part.
+	uint16 cached_base_weight;      ///< Weight of this vehicle part without cargo, if it has no callbacks.
+	byte cached_tractive_effort;    ///< Tractive effort coefficient of this vehicle part, if it has no callbacks.
+	bool cached_has_callbacks;      ///< Whether NewGRF callbacks may change the properties of this vehicle part.
+
 	/* Cached NewGRF values, recalculated on load and each time a vehicle is added to/removed from the consist. */
 	uint16 cached_total_length;     ///< Length of the whole vehicle (valid only for the first engine).
 	EngineID first_engine;          ///< Cached EngineID of the front vehicle. INVALID_ENGINE for the front vehicle itself.
@@ -63,6 +69,7 @@ enum GroundVehicleFlags {
  * virtual uint16      GetPower() const = 0;
  * virtual uint16      GetPoweredPartPower(const T *head) const = 0;
  * virtual uint16      GetWeight() const = 0;
+ * virtual uint16      GetCargoWeight() const = 0;
  * virtual byte        GetTractiveEffort() const = 0;
  * virtual byte        GetAirDrag() const = 0;
  * virtual byte        GetAirDragArea() const = 0;
@@ -89,6 +96,8 @@ struct GroundVehicle : public SpecializedVehicle<T, Type> {
 
 	void PowerChanged();
 	void CargoChanged();
+	void CargoAmountChanged();
+	void UpdatePower(uint32 total_power, uint32 max_te);
 	int GetAcceleration() const;
 
 	/**
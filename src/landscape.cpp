@@ -32,6 +32,9 @@
 #include "water_map.h"
 #include "economy_func.h"
 #include "company_func.h"
+#include "tick_profile.h"
+#include "pathfinder/water_regions.h"
+#include "pathfinder/network_components.h"
 
 #include "table/strings.h"
 #include "table/sprites.h"
@@ -489,6 +492,9 @@ void DoClearSquare(TileIndex tile)
 	if (_tile_type_procs[GetTileType(tile)]->animate_tile_proc != NULL) DeleteAnimatedTile(tile);
 
 	MakeClear(tile, CLEAR_GRASS, _generating_world ? 3 : 0);
+	InvalidateWaterRegion(tile);
+	NotifyNetworkComponentChange(tile, TRANSPORT_RAIL);
+	NotifyNetworkComponentChange(tile, TRANSPORT_ROAD);
 	MarkTileDirtyByTile(tile);
 }
 
@@ -716,22 +722,68 @@ TileIndex _cur_tileloop_tile;
 #define TILELOOP_ASSERTMASK ((TILELOOP_SIZE - 1) + ((TILELOOP_SIZE - 1) << MapLogX()))
 #define TILELOOP_CHKMASK (((1 << (MapLogX() - TILELOOP_BITS))-1) << TILELOOP_BITS)
 
+/**
+ * Check whether the tile loop of a clear tile would leave it as it is.
+ * This mirrors TileLoop_Clear for climates without snow or desert.
+ * @param tile The clear tile.
+ * @return True if the tile loop has nothing to do for the tile.
+ */
+static inline bool IsIdleClearTile(TileIndex tile)
+{
+	switch (GetClearGround(tile)) {
+		case CLEAR_GRASS:
+			if (GetClearDensity(tile) != 3) return false;
+			break;
+
+		case CLEAR_FIELDS:
+			return false;
+
+		default:
+			break;
+	}
+
+	/* The fences must be where TileLoopClearHelper wants them. */
+	TileIndex sw = TILE_ADDXY(tile, 1, 0);
+	if ((GetFenceSW(tile) != 0) != (IsTileType(sw, MP_CLEAR) && IsClearGround(sw, CLEAR_FIELDS))) return false;
+	TileIndex se = TILE_ADDXY(tile, 0, 1);
+	if ((GetFenceSE(tile) != 0) != (IsTileType(se, MP_CLEAR) && IsClearGround(se, CLEAR_FIELDS))) return false;
+
+	/* Tiles next to the map edge might get flooded. */
+	return !_settings_game.construction.freeform_edges || DistanceFromEdge(tile) != 1;
+}
+
 void RunTileLoop()
 {
+	TickProfileTimer timer(TPS_TILE_LOOP);
 	TileIndex tile = _cur_tileloop_tile;
 
 	assert((tile & ~TILELOOP_ASSERTMASK) == 0);
-	uint count = (MapSizeX() / TILELOOP_SIZE) * (MapSizeY() / TILELOOP_SIZE);
-	do {
-		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
 
-		if (TileX(tile) < MapSizeX() - TILELOOP_SIZE) {
-			tile += TILELOOP_SIZE; // no overflow
-		} else {
-			tile = TILE_MASK(tile - TILELOOP_SIZE * (MapSizeX() / TILELOOP_SIZE - 1) + TileDiffXY(0, TILELOOP_SIZE)); // x would overflow, also increase y
+	/* In climates with snow or desert every clear tile might change. */
+	bool skip_idle_clear = _settings_game.game_creation.landscape == LT_TEMPERATE || _settings_game.game_creation.landscape == LT_TOYLAND;
+
+	/* Visit every TILELOOP_SIZE-th tile of every TILELOOP_SIZE-th row,
+	 * row by row. Tiles whose tile loop provably does nothing are skipped
+	 * without calling their tile loop proc; that does not change the order
+	 * in which the other procs are called, nor their random numbers. */
+	uint row_length = MapSizeX() / TILELOOP_SIZE * TILELOOP_SIZE;
+	for (TileIndex row = tile; row < MapSize(); row += TileDiffXY(0, TILELOOP_SIZE)) {
+		for (TileIndex cur = row; cur < row + row_length; cur += TILELOOP_SIZE) {
+			switch (GetTileType(cur)) {
+				case MP_VOID:
+					/* TileLoop_Void does nothing. */
+					continue;
+
+				case MP_CLEAR:
+					if (skip_idle_clear && IsIdleClearTile(cur)) continue;
+					break;
+
+				default:
+					break;
+			}
+			_tile_type_procs[GetTileType(cur)]->tile_loop_proc(cur);
 		}
-	} while (--count != 0);
-	assert((tile & ~TILELOOP_ASSERTMASK) == 0);
+	}
 
 	tile += 9;
 	if (tile & TILELOOP_CHKMASK) {
@@ -1006,13 +1058,26 @@ void OnTick_Industry();
 void OnTick_Companies();
 void OnTick_LinkGraph();
 
+/**
+ * Run a tick handler and measure how long it takes.
+ * @param section Section of the tick profile to add the time to.
+ * @param proc The tick handler.
+ */
+static void ProfileLandscapeTick(TickProfileSection section, void (*proc)())
+{
+	TickProfileTimer timer(section);
+	proc();
+}
+
 void CallLandscapeTick()
 {
-	OnTick_Town();
-	OnTick_Trees();
-	OnTick_Station();
-	OnTick_Industry();
+	TickProfileTimer timer(TPS_LANDSCAPE);
+
+	ProfileLandscapeTick(TPS_TOWNS, OnTick_Town);
+	ProfileLandscapeTick(TPS_TREES, OnTick_Trees);
+	ProfileLandscapeTick(TPS_STATIONS, OnTick_Station);
+	ProfileLandscapeTick(TPS_INDUSTRIES, OnTick_Industry);
 
-	OnTick_Companies();
-	OnTick_LinkGraph();
+	ProfileLandscapeTick(TPS_COMPANIES, OnTick_Companies);
+	ProfileLandscapeTick(TPS_LINKGRAPH, OnTick_LinkGraph);
 }
@@ -0,0 +1,214 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file benchmark.cpp Benchmark running the link graph calculations on the components of the current game. */
+
+#include "../stdafx.h"
+#include "../console_func.h"
+#include "../core/bitmath_func.hpp"
+#include "linkgraph.h"
+#include "demands.h"
+#include "mcf.h"
+#include "flowmapper.h"
+#include "benchmark.h"
+
+extern uint64 ottd_rdtsc();
+
+/** Stages of a link graph job, in the order they are run. */
+enum BenchmarkStage {
+	BS_DEMANDS, ///< Demand calculation.
+	BS_MCF1,    ///< First pass of the MCF solver.
+	BS_FLOWS1,  ///< Flow mapping after the first pass.
+	BS_MCF2,    ///< Second pass of the MCF solver.
+	BS_FLOWS2,  ///< Flow mapping after the second pass.
+	BS_END,
+};
+
+/** Names of the stages as used in the output. */
+static const char * const _stage_names[BS_END] = {"demands", "mcf1", "flowmapper1", "mcf2", "flowmapper2"};
+
+/** Measurements of one stage, summed up over all iterations. */
+struct StageStats {
+	uint64 cycles;      ///< Time spent in the stage, in CPU cycles.
+	uint64 min_cycles;  ///< Fastest run of the stage, in CPU cycles.
+	uint64 allocations; ///< Number of paths allocated.
+	size_t peak_memory; ///< Maximum memory used by paths at any time, in bytes.
+
+	StageStats() : cycles(0), min_cycles(UINT64_MAX), allocations(0), peak_memory(0) {}
+
+	/**
+	 * Add the measurements of another set of runs.
+	 * @param other Measurements to be added.
+	 */
+	void Add(const StageStats &other)
+	{
+		this->cycles += other.cycles;
+		this->min_cycles = min(this->min_cycles, other.min_cycles);
+		this->allocations += other.allocations;
+		this->peak_memory = max(this->peak_memory, other.peak_memory);
+	}
+};
+
+/** Link graph component which can be built for any cargo outside of a link graph. */
+class BenchmarkComponent : public LinkGraphComponent {
+public:
+	/**
+	 * Create a component for the given cargo.
+	 * @param cargo Cargo of the component.
+	 */
+	BenchmarkComponent(CargoID cargo) {this->cargo = cargo;}
+};
+
+/**
+ * Print the measurements of some stages to the console.
+ * @param stats Measurements of all stages.
+ * @param runs Number of runs the measurements were taken over.
+ */
+static void PrintStageStats(const StageStats *stats, uint runs)
+{
+	for (uint stage = 0; stage < BS_END; ++stage) {
+		IConsolePrintF(CC_DEFAULT, "  %-12s avg " OTTD_PRINTF64 " cycles, min " OTTD_PRINTF64 " cycles, " OTTD_PRINTF64 " path allocations, " PRINTF_SIZE " bytes peak path memory",
+				_stage_names[stage], stats[stage].cycles / runs, stats[stage].min_cycles,
+				stats[stage].allocations / runs, stats[stage].peak_memory);
+	}
+}
+
+/**
+ * Write the measurements of some stages as JSON object members.
+ * @param f File to write to.
+ * @param stats Measurements of all stages.
+ * @param runs Number of runs the measurements were taken over.
+ */
+static void WriteStageStats(FILE *f, const StageStats *stats, uint runs)
+{
+	for (uint stage = 0; stage < BS_END; ++stage) {
+		fprintf(f, "%s\"%s\": {\"avg_cycles\": " OTTD_PRINTF64 ", \"min_cycles\": " OTTD_PRINTF64 ", \"path_allocations\": " OTTD_PRINTF64 ", \"peak_path_memory\": " PRINTF_SIZE "}",
+				stage == 0 ? "" : ", ", _stage_names[stage], stats[stage].cycles / runs, stats[stage].min_cycles,
+				stats[stage].allocations / runs, stats[stage].peak_memory);
+	}
+}
+
+/**
+ * Run all stages of a link graph job on each component of each link graph
+ * with automatic distribution and report how long each stage took. The
+ * components are built from the current link stats, but the game state isn't
+ * modified. Flows taken over from earlier calculations are ignored, so that
+ * each run measures a full recalculation.
+ * @param iterations Number of times the stages are run on each component.
+ * @param json_file File to write the results to in JSON format, or NULL.
+ * @return If the benchmark could be run.
+ */
+bool BenchmarkLinkGraphs(uint iterations, const char *json_file)
+{
+	assert(iterations > 0);
+
+	FILE *f = NULL;
+	if (json_file != NULL) {
+		f = fopen(json_file, "w");
+		if (f == NULL) {
+			IConsoleError("could not open file");
+			return false;
+		}
+		fprintf(f, "{\"iterations\": %u, \"components\": [", iterations);
+	}
+
+	DemandHandler demands;
+	MCFHandler<MCF1stPass> mcf1;
+	FlowMapper flows1;
+	MCFHandler<MCF2ndPass> mcf2;
+	FlowMapper flows2;
+	ComponentHandler *handlers[BS_END] = {&demands, &mcf1, &flows1, &mcf2, &flows2};
+
+	/* Components are grouped by size: bucket n holds the ones with 2^n to 2^(n+1) - 1 nodes. */
+	static const uint NUM_BUCKETS = 32;
+	StageStats bucket_stats[NUM_BUCKETS][BS_END];
+	uint bucket_runs[NUM_BUCKETS] = {};
+	uint num_components = 0;
+
+	for (CargoID cargo = 0; cargo < NUM_CARGO; ++cargo) {
+		if (_settings_game.linkgraph.GetDistributionType(cargo) == DT_MANUAL) continue;
+
+		std::set<StationID> seen;
+		BenchmarkComponent component(cargo);
+		LinkGraphComponent::StationIndex index;
+
+		Station *st;
+		FOR_ALL_STATIONS(st) {
+			if (st->goods[cargo].link_stats.empty() || seen.find(st->index) != seen.end()) continue;
+
+			StageStats stats[BS_END];
+			for (uint i = 0; i < iterations; ++i) {
+				component.Clear();
+				component.Init(num_components);
+				index.clear();
+				component.Build(st, index);
+
+				for (uint stage = 0; stage < BS_END; ++stage) {
+					PathAllocator &allocator = component.GetPathAllocator();
+					allocator.ResetStats();
+					uint64 start = ottd_rdtsc();
+					handlers[stage]->Run(&component);
+					uint64 cycles = ottd_rdtsc() - start;
+
+					stats[stage].cycles += cycles;
+					stats[stage].min_cycles = min(stats[stage].min_cycles, cycles);
+					stats[stage].allocations += allocator.GetAllocations();
+					stats[stage].peak_memory = max(stats[stage].peak_memory, allocator.GetPeakMemory());
+				}
+			}
+
+			for (LinkGraphComponent::StationIndex::iterator i = index.begin(); i != index.end(); ++i) {
+				seen.insert(i->first->index);
+			}
+
+			uint size = component.GetSize();
+			IConsolePrintF(CC_DEFAULT, "Cargo %u, component at station %u: %u nodes, %u edges",
+					cargo, st->index, size, component.GetNumEdges());
+			PrintStageStats(stats, iterations);
+
+			if (f != NULL) {
+				fprintf(f, "%s{\"cargo\": %u, \"station\": %u, \"nodes\": %u, \"edges\": %u, \"stages\": {",
+						num_components == 0 ? "" : ", ", cargo, st->index, size, component.GetNumEdges());
+				WriteStageStats(f, stats, iterations);
+				fprintf(f, "}}");
+			}
+
+			uint bucket = FindLastBit(size);
+			for (uint stage = 0; stage < BS_END; ++stage) bucket_stats[bucket][stage].Add(stats[stage]);
+			bucket_runs[bucket] += iterations;
+			num_components++;
+		}
+	}
+
+	if (f != NULL) fprintf(f, "], \"sizes\": [");
+
+	bool first = true;
+	for (uint bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+		if (bucket_runs[bucket] == 0) continue;
+		IConsolePrintF(CC_DEFAULT, "Components with %u to %u nodes: %u runs",
+				1U << bucket, (2U << bucket) - 1, bucket_runs[bucket]);
+		PrintStageStats(bucket_stats[bucket], bucket_runs[bucket]);
+
+		if (f != NULL) {
+			fprintf(f, "%s{\"min_nodes\": %u, \"max_nodes\": %u, \"runs\": %u, \"stages\": {",
+					first ? "" : ", ", 1U << bucket, (2U << bucket) - 1, bucket_runs[bucket]);
+			WriteStageStats(f, bucket_stats[bucket], bucket_runs[bucket]);
+			fprintf(f, "}}");
+		}
+		first = false;
+	}
+
+	if (f != NULL) {
+		fprintf(f, "]}\n");
+		fclose(f);
+	}
+
+	if (num_components == 0) IConsolePrint(CC_DEFAULT, "No link graph components found.");
+	return true;
+}
@@ -7,9 +7,9 @@
 #include "../cargotype.h"
 #include "../core/math_func.hpp"
 #include "demands.h"
-#include <list>
+#include <deque>
 
-typedef std::list<NodeID> NodeList;
+typedef std::deque<NodeID> NodeList;
 
 /**
  * Set the demands between two nodes using the given base demand. In symmetric mode
@@ -44,10 +44,199 @@ void SymmetricScaler::SetDemands(LinkGraphComponent *graph, NodeID from_id, Node
  */
 FORCEINLINE void Scaler::SetDemands(LinkGraphComponent *graph, NodeID from_id, NodeID to_id, uint demand_forw)
 {
-	Edge &forward = graph->GetEdge(from_id, to_id);
-	forward.demand += demand_forw;
-	forward.unsatisfied_demand += demand_forw;
-	graph->GetNode(from_id).undelivered_supply -= demand_forw;
+	Node &from = graph->GetNode(from_id);
+	from.AddDemand(to_id, demand_forw);
+	from.undelivered_supply -= demand_forw;
+}
+
+/**
+ * Table of the demands between supplying and accepting nodes before any supply
+ * has been distributed. Those only depend on the nodes' supply, acceptance and
+ * distance, so they can be calculated in advance, independent of the order in
+ * which the supply is distributed later on. The properties of the accepting
+ * nodes are kept in flat arrays, so that the compiler can vectorize the
+ * calculation of a row, and blocks of rows are calculated in parallel by the
+ * link graph worker threads.
+ * @tparam Tscaler Scaler for the distribution type.
+ */
+template<class Tscaler>
+class DemandTable {
+public:
+	DemandTable(LinkGraphComponent *graph, const Tscaler &scaler, int32 max_distance, int32 mod_dist, int32 accuracy);
+
+	void Fill(const NodeList &supplies);
+
+	/**
+	 * Get the demand between two nodes before any supply is distributed.
+	 * @param from Supplying node.
+	 * @param to Accepting node.
+	 * @return Demand, or 0 if the nodes are too far apart or too small.
+	 */
+	FORCEINLINE uint Get(NodeID from, NodeID to) const
+	{
+		uint row = this->row_of[from];
+		if (row == UINT_MAX) {
+			return this->Calculate(this->supply[from], TileX(this->xy[from]), TileY(this->xy[from]), this->col_of[to]);
+		}
+		return this->table[row * this->num_cols + this->col_of[to]];
+	}
+
+private:
+	static const uint MAX_TABLE_SIZE = 1 << 24; ///< Maximum number of entries in the table.
+	static const uint MIN_BLOCK_SIZE = 1 << 12; ///< Minimum number of entries calculated in one task.
+
+	/** Rows of the table to be calculated in a worker task. */
+	struct Block {
+		DemandTable *table; ///< Table the rows belong to.
+		uint first_row;     ///< First row of the block.
+		uint end_row;       ///< Row behind the last one of the block.
+	};
+
+	Tscaler scaler;               ///< Scaler with the mean demand already set.
+	int32 max_distance;           ///< Maximum distance possible on the map.
+	int32 mod_dist;               ///< Distance modifier.
+	int32 accuracy;               ///< Accuracy of the calculation.
+	uint num_cols;                ///< Number of accepting nodes.
+	std::vector<NodeID> rows;     ///< Supplying nodes by row.
+	std::vector<uint> row_of;     ///< Row of each node, UINT_MAX if it isn't in the table.
+	std::vector<uint> col_of;     ///< Column of each node.
+	std::vector<uint> supply;     ///< Supply of each node.
+	std::vector<TileIndex> xy;    ///< Location of each node.
+	std::vector<uint> col_x;      ///< X coordinate of the accepting node in each column.
+	std::vector<uint> col_y;      ///< Y coordinate of the accepting node in each column.
+	std::vector<uint> col_factor; ///< Remote factor of the accepting node in each column.
+	std::vector<uint> table;      ///< Demands, row by row.
+
+	/**
+	 * Calculate the demand between a supplying node and the accepting node in
+	 * the given column.
+	 * @param supply Supply of the supplying node.
+	 * @param x X coordinate of the supplying node.
+	 * @param y Y coordinate of the supplying node.
+	 * @param col Column of the accepting node.
+	 * @return Demand, or 0 if the nodes are too far apart or too small.
+	 */
+	FORCEINLINE uint Calculate(uint supply, uint x, uint y, uint col) const
+	{
+		int32 effective_supply = this->scaler.EffectiveSupply(supply, this->col_factor[col]);
+		assert(effective_supply > 0);
+
+		/* scale the distance by mod_dist around max_distance */
+		int32 distance = this->max_distance - (this->max_distance -
+				(int32)(Delta(x, this->col_x[col]) + Delta(y, this->col_y[col]))) * this->mod_dist / 100;
+
+		/* scale the accuracy by distance around accuracy / 2 */
+		int32 divisor = this->accuracy * (this->mod_dist - 50) / 100 +
+				this->accuracy * distance / this->max_distance + 1;
+
+		assert(divisor > 0);
+
+		/* only distribute demand if effective supply / accuracy divisor >= 1 */
+		return divisor <= effective_supply ? effective_supply / divisor : 0;
+	}
+
+	/**
+	 * Fill a block of rows of the table.
+	 * @param first_row First row to be filled.
+	 * @param end_row Row behind the last one to be filled.
+	 */
+	void FillRows(uint first_row, uint end_row)
+	{
+		for (uint row = first_row; row < end_row; ++row) {
+			NodeID from = this->rows[row];
+			uint supply = this->supply[from];
+			uint x = TileX(this->xy[from]);
+			uint y = TileY(this->xy[from]);
+			uint *demands = &this->table[row * this->num_cols];
+			for (uint col = 0; col < this->num_cols; ++col) {
+				demands[col] = this->Calculate(supply, x, y, col);
+			}
+		}
+	}
+
+	/**
+	 * Entry point for the worker tasks.
+	 * @param block Block to be filled.
+	 */
+	static void FillBlock(void *block)
+	{
+		Block *b = (Block *)block;
+		b->table->FillRows(b->first_row, b->end_row);
+	}
+};
+
+/**
+ * Collect the properties of the nodes. Until the table is filled the demands
+ * are calculated on the fly.
+ * @param graph Component to calculate the demands for.
+ * @param scaler Scaler with the mean demand already set.
+ * @param max_distance Maximum distance possible on the map.
+ * @param mod_dist Distance modifier.
+ * @param accuracy Accuracy of the calculation.
+ */
+template<class Tscaler>
+DemandTable<Tscaler>::DemandTable(LinkGraphComponent *graph, const Tscaler &scaler,
+		int32 max_distance, int32 mod_dist, int32 accuracy) :
+	scaler(scaler), max_distance(max_distance), mod_dist(mod_dist), accuracy(accuracy), num_cols(0)
+{
+	uint size = graph->GetSize();
+	this->row_of.resize(size, UINT_MAX);
+	this->col_of.resize(size, UINT_MAX);
+	this->supply.resize(size);
+	this->xy.resize(size);
+	for (NodeID node = 0; node < size; ++node) {
+		Node &n = graph->GetNode(node);
+		this->supply[node] = n.supply;
+		this->xy[node] = n.xy;
+		if (n.demand > 0) {
+			this->col_of[node] = this->num_cols++;
+			this->col_x.push_back(TileX(n.xy));
+			this->col_y.push_back(TileY(n.xy));
+			this->col_factor.push_back(scaler.RemoteFactor(n));
+		}
+	}
+}
+
+/**
+ * Calculate the rows of the given supplying nodes, if the table doesn't get
+ * too large. The rows are split into blocks which are calculated by the
+ * worker threads and the calling thread. As each block is written by only
+ * one task the result doesn't depend on the order the tasks are run in.
+ * @param supplies Nodes to calculate the rows for.
+ */
+template<class Tscaler>
+void DemandTable<Tscaler>::Fill(const NodeList &supplies)
+{
+	if ((uint64)supplies.size() * this->num_cols > MAX_TABLE_SIZE) return;
+
+	for (NodeList::const_iterator i = supplies.begin(); i != supplies.end(); ++i) {
+		this->row_of[*i] = (uint)this->rows.size();
+		this->rows.push_back(*i);
+	}
+	uint num_rows = (uint)this->rows.size();
+	this->table.resize(num_rows * this->num_cols);
+
+	WorkerPool &workers = LinkGraphJob::GetWorkers();
+	uint num_blocks = ClampU(num_rows * this->num_cols / MIN_BLOCK_SIZE, 1, workers.GetNumThreads() + 1);
+	num_blocks = min(num_blocks, num_rows);
+	if (num_blocks <= 1) {
+		this->FillRows(0, num_rows);
+		return;
+	}
+
+	std::vector<Block> blocks(num_blocks);
+	std::vector<WorkerTask> tasks;
+	tasks.reserve(num_blocks);
+	for (uint i = 0; i < num_blocks; ++i) {
+		blocks[i].table = this;
+		blocks[i].first_row = num_rows * i / num_blocks;
+		blocks[i].end_row = num_rows * (i + 1) / num_blocks;
+		tasks.push_back(WorkerTask(&DemandTable::FillBlock, &blocks[i]));
+	}
+	/* queue all blocks but the first one and fill that one in this thread */
+	for (uint i = 1; i < num_blocks; ++i) workers.Enqueue(&tasks[i]);
+	this->FillRows(blocks[0].first_row, blocks[0].end_row);
+	for (uint i = 1; i < num_blocks; ++i) workers.Wait(&tasks[i]);
 }
 
 /**
@@ -82,7 +271,9 @@ void DemandCalculator::CalcDemand(LinkGraphComponent *graph, Tscaler scaler)
 	 * relative to remote demand.
 	 */
 	scaler.SetDemandPerNode(num_demands);
+	DemandTable<Tscaler> table(graph, scaler, this->max_distance, this->mod_dist, this->accuracy);
 	uint chance = 0;
+	uint first_round = num_supplies;
 
 	while (!supplies.empty() && !demands.empty()) {
 		NodeID node1 = supplies.front();
@@ -105,27 +296,12 @@ void DemandCalculator::CalcDemand(LinkGraphComponent *graph, Tscaler scaler)
 			}
 			Node &to = graph->GetNode(node2);
 
-			int32 supply = scaler.EffectiveSupply(from, to);
-			assert(supply > 0);
-
-			/* scale the distance by mod_dist around max_distance */
-			int32 distance = this->max_distance - (this->max_distance -
-					(int32)graph->GetEdge(node1, node2).distance) * this->mod_dist / 100;
-
-			/* scale the accuracy by distance around accuracy / 2 */
-			int32 divisor = this->accuracy * (this->mod_dist - 50) / 100 +
-					this->accuracy * distance / this->max_distance + 1;
-
-			assert(divisor > 0);
-
-			uint demand_forw = 0;
-			if (divisor <= supply) {
-				/* at first only distribute demand if
-				 * effective supply / accuracy divisor >= 1
-				 * Others are too small or too far away to be considered.
-				 */
-				demand_forw = supply / divisor;
-			} else if (++chance > this->accuracy * num_demands * num_supplies) {
+			/* at first only distribute demand if the precalculated demand
+			 * is at least 1. Others are too small or too far away to be
+			 * considered.
+			 */
+			uint demand_forw = table.Get(node1, node2);
+			if (demand_forw == 0 && ++chance > this->accuracy * num_demands * num_supplies) {
 				/* After some trying, if there is still supply left, distribute
 				 * demand also to other nodes.
 				 */
@@ -150,6 +326,12 @@ void DemandCalculator::CalcDemand(LinkGraphComponent *graph, Tscaler scaler)
 		} else {
 			num_supplies--;
 		}
+
+		/* After the first round over all supplying nodes the remaining ones
+		 * will usually be visited many times. Calculate their demands in
+		 * advance instead of again and again.
+		 */
+		if (first_round > 0 && --first_round == 0) table.Fill(supplies);
 	}
 }
 
@@ -160,6 +342,13 @@ void DemandCalculator::CalcDemand(LinkGraphComponent *graph, Tscaler scaler)
 DemandCalculator::DemandCalculator(LinkGraphComponent *graph) :
 	max_distance(MapSizeX() + MapSizeY() + 1)
 {
+	/* nothing to do if all flows have been taken over from the last calculation */
+	bool all_fixed = true;
+	for (NodeID node = 0; node < graph->GetSize() && all_fixed; ++node) {
+		all_fixed = graph->GetNode(node).flows_fixed;
+	}
+	if (all_fixed) return;
+
 	CargoID cargo = graph->GetCargo();
 	const LinkGraphSettings &settings = graph->GetSettings();
 
@@ -181,4 +370,14 @@ DemandCalculator::DemandCalculator(LinkGraphComponent *graph) :
 		default:
 			NOT_REACHED();
 	}
+
+	for (NodeID node = 0; node < graph->GetSize(); ++node) {
+		Node &n = graph->GetNode(node);
+		n.MergeDemands();
+		if (!n.flows_fixed) continue;
+		/* the demands are satisfied by the flows taken over */
+		for (DemandVector::iterator i = n.demands.begin(); i != n.demands.end(); ++i) {
+			i->unsatisfied_demand = 0;
+		}
+	}
 }
@@ -44,16 +44,28 @@ public:
 		this->demand_per_node = max(this->supply_sum / num_demands, 1U);
 	}
 
+	/**
+	 * Get the property of a receiving node that is weighed in when calculating
+	 * the effective supply towards it. In symmetric distribution that's the
+	 * node's supply.
+	 * @param to The receiving node.
+	 * @return Factor for EffectiveSupply.
+	 */
+	FORCEINLINE uint RemoteFactor(const Node &to) const
+	{
+		return max(1U, to.supply);
+	}
+
 	/**
 	 * Get the effective supply of one node towards another one. In symmetric
 	 * distribution the supply of the other node is weighed in.
-	 * @param from The supplying node.
-	 * @param to The receiving node.
+	 * @param supply Supply of the supplying node.
+	 * @param remote_factor RemoteFactor of the receiving node.
 	 * @return Effective supply.
 	 */
-	FORCEINLINE uint EffectiveSupply(const Node &from, const Node &to)
+	FORCEINLINE uint EffectiveSupply(uint supply, uint remote_factor) const
 	{
-		return max(from.supply * max(1U, to.supply) * this->mod_size / 100 / this->demand_per_node, 1U);
+		return max(supply * remote_factor * this->mod_size / 100 / this->demand_per_node, 1U);
 	}
 
 	/**
@@ -99,15 +111,28 @@ public:
 		this->demand_per_node = max(this->demand_sum / num_demands, (uint)1);
 	}
 
+	/**
+	 * Get the property of a receiving node that is weighed in when calculating
+	 * the effective supply towards it. In asymmetric distribution that's the
+	 * node's demand.
+	 * @param to The receiving node.
+	 * @return Factor for EffectiveSupply.
+	 */
+	FORCEINLINE uint RemoteFactor(const Node &to) const
+	{
+		return to.demand;
+	}
+
 	/**
 	 * Get the effective supply of one node towards another one. In asymmetric
 	 * distribution the demand of the other node is weighed in.
-	 * @param from The supplying node.
-	 * @param to The receiving node.
+	 * @param supply Supply of the supplying node.
+	 * @param remote_factor RemoteFactor of the receiving node.
+	 * @return Effective supply.
 	 */
-	FORCEINLINE uint EffectiveSupply(const Node &from, const Node &to)
+	FORCEINLINE uint EffectiveSupply(uint supply, uint remote_factor) const
 	{
-		return max(from.supply * to.demand / this->demand_per_node, (uint)1);
+		return max(supply * remote_factor / this->demand_per_node, (uint)1);
 	}
 
 	/**
@@ -44,10 +44,11 @@ void FlowMapper::Run(LinkGraphComponent *component)
 			}
 		}
 	}
+	PathAllocator &allocator = component->GetPathAllocator();
 	for (NodeID node_id = 0; node_id < component->GetSize(); ++node_id) {
 		PathSet &paths = component->GetNode(node_id).paths;
 		for (PathSet::iterator i = paths.begin(); i != paths.end(); ++i) {
-			delete *i;
+			allocator.Free(*i);
 		}
 		paths.clear();
 	}
@@ -16,11 +16,14 @@
 #include "../window_func.h"
 #include "../window_gui.h"
 #include "../moving_average.h"
+#include "../tick_profile.h"
+#include "../core/math_func.hpp"
 #include "linkgraph.h"
 #include "demands.h"
 #include "mcf.h"
 #include "flowmapper.h"
 #include <queue>
+#include <algorithm>
 
 /**
  * Global array of link graphs, one for each cargo.
@@ -32,81 +35,189 @@ LinkGraph _link_graphs[NUM_CARGO];
  */
 LinkGraphJob::HandlerList LinkGraphJob::_handlers;
 
+/**
+ * Worker threads running the jobs of all link graphs.
+ */
+WorkerPool LinkGraphJob::_workers;
+
+/**
+ * Number of worker threads for link graph jobs; 0 means one per CPU core.
+ */
+uint8 _linkgraph_threads = 0;
+
 /**
  * Create a node or clear it.
  * @param st ID of the associated station.
  * @param sup Supply of cargo at the station last month.
  * @param dem Acceptance for cargo at the station.
+ * @param xy Location of the station.
  */
-void Node::Init(StationID st, uint sup, uint dem)
+void Node::Init(StationID st, uint sup, uint dem, TileIndex xy)
 {
 	this->supply = sup;
 	this->undelivered_supply = sup;
 	this->demand = dem;
 	this->station = st;
+	this->xy = xy;
 
-	for (PathSet::iterator i = this->paths.begin(); i != this->paths.end(); ++i) {
-		delete *i;
-	}
+	/* The paths themselves are owned by the component's path allocator. */
 	this->paths.clear();
 	this->flows.clear();
+	this->demands.clear();
+	this->fixed_flows.clear();
+	this->flows_fixed = false;
 }
 
 /**
- * Create an edge.
- * @param distance Length of the link as manhattan distance.
- * @param capacity Capacity of the link.
+ * Sort the demands by receiving node and merge the ones towards the same node.
  */
-FORCEINLINE void Edge::Init(uint distance, uint capacity)
+void Node::MergeDemands()
 {
-	this->distance = distance;
-	this->capacity = capacity;
-	this->demand = 0;
-	this->unsatisfied_demand = 0;
-	this->flow = 0;
-	this->next_edge = INVALID_NODE;
+	if (this->demands.empty()) return;
+	std::sort(this->demands.begin(), this->demands.end());
+	DemandVector::iterator last = this->demands.begin();
+	for (DemandVector::iterator i = last + 1; i != this->demands.end(); ++i) {
+		if (i->to == last->to) {
+			last->demand += i->demand;
+			last->unsatisfied_demand += i->unsatisfied_demand;
+		} else {
+			*(++last) = *i;
+		}
+	}
+	this->demands.erase(last + 1, this->demands.end());
 }
 
+/**
+ * Check if there is any demand from this node that hasn't been assigned to a
+ * path yet.
+ * @return If there is unsatisfied demand.
+ */
+bool Node::HasUnsatisfiedDemand() const
+{
+	for (DemandVector::const_iterator i = this->demands.begin(); i != this->demands.end(); ++i) {
+		if (i->unsatisfied_demand > 0) return true;
+	}
+	return false;
+}
 
 /**
- * 1. Build the link graph component containing the given station by using BFS on the link stats.
- * 2. Set every included station's last_component to the new component's ID (this->current_component_id).
- * 3. Start a link graph job with the new component.
- * @param first Station to start the search at.
+ * Check if a value has changed enough since the last link graph calculation to
+ * recalculate the flows depending on it.
+ * @param last Value the last calculation was based on.
+ * @param current Current value.
+ * @param threshold Relative change in percent which is considered material.
+ * @return If the change is material.
  */
-void LinkGraph::CreateComponent(Station *first)
+static FORCEINLINE bool IsMaterialChange(uint last, uint current, uint threshold)
 {
-	std::map<Station *, NodeID> index;
-	index[first] = this->AddNode(first);
+	return (uint64)Delta(last, current) * 100 > (uint64)last * threshold;
+}
 
-	std::queue<Station *> search_queue;
-	search_queue.push(first);
+/**
+ * Find the nodes which have changed materially since the last calculation and
+ * take over the flows of all origins that don't pass any of them from the
+ * stations. Only the remaining flows have to be calculated again. If supply or
+ * acceptance of any node has changed, the demands of all nodes change and
+ * nothing is taken over. The values future changes are measured against are
+ * updated for all values the new calculation is based on.
+ * @param index Nodes of the component by station.
+ */
+void LinkGraph::FixUnchangedFlows(const StationIndex &index)
+{
+	uint size = this->GetSize();
+	uint threshold = this->settings.recalc_threshold;
+	std::vector<bool> changed(size, false);
+	bool recalc_all = false;
+
+	for (NodeID node_id = 0; node_id < size; ++node_id) {
+		Node &node = this->nodes[node_id];
+		GoodsEntry &ge = Station::Get(node.station)->goods[this->cargo];
+		if (ge.recalc_acceptance != (node.demand > 0) || IsMaterialChange(ge.recalc_supply, node.supply, threshold)) {
+			recalc_all = true;
+			break;
+		}
 
-	/* find all stations belonging to the current component */
-	while (!search_queue.empty()) {
-		Station *source = search_queue.front();
-		search_queue.pop();
+		for (LinkStatMap::iterator i = ge.link_stats.begin(); i != ge.link_stats.end(); ++i) {
+			if (IsMaterialChange(i->second.RecalcCapacity(), i->second.Capacity(), threshold)) changed[node_id] = true;
+		}
 
-		const LinkStatMap &links = source->goods[this->cargo].link_stats;
-		for (LinkStatMap::const_iterator i = links.begin(); i != links.end(); ++i) {
-			Station *target = Station::GetIfValid(i->first);
-			if (target == NULL) continue;
+		/* Flows via stations that aren't connected anymore can't be kept. */
+		for (FlowStatMap::iterator i = ge.flows.begin(); i != ge.flows.end() && !changed[node_id]; ++i) {
+			for (FlowStatSet::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+				if (j->Via() == node.station) continue;
+				Station *via = Station::GetIfValid(j->Via());
+				if (via == NULL || ge.link_stats.find(j->Via()) == ge.link_stats.end() || index.find(via) == index.end()) {
+					changed[node_id] = true;
+					break;
+				}
+			}
+		}
+	}
 
-			std::map<Station *, NodeID>::iterator index_it = index.find(target);
-			if (index_it == index.end()) {
-				search_queue.push(target);
-				NodeID node = this->AddNode(target);
-				index[target] = node;
+	if (recalc_all) {
+		for (NodeID node_id = 0; node_id < size; ++node_id) {
+			Node &node = this->nodes[node_id];
+			GoodsEntry &ge = Station::Get(node.station)->goods[this->cargo];
+			ge.recalc_supply = node.supply;
+			ge.recalc_acceptance = (node.demand > 0);
+			for (LinkStatMap::iterator i = ge.link_stats.begin(); i != ge.link_stats.end(); ++i) {
+				i->second.SetRecalcCapacity();
+			}
+		}
+		return;
+	}
 
-				this->AddEdge(index[source], node, i->second.Capacity());
-			} else {
-				this->AddEdge(index[source], index_it->second, i->second.Capacity());
+	/* Origins with flows through changed nodes have to be recalculated. */
+	std::vector<bool> fixed(size, true);
+	for (NodeID node_id = 0; node_id < size; ++node_id) {
+		if (!changed[node_id]) continue;
+		fixed[node_id] = false;
+		const FlowStatMap &flows = Station::Get(this->nodes[node_id].station)->goods[this->cargo].flows;
+		for (FlowStatMap::const_iterator i = flows.begin(); i != flows.end(); ++i) {
+			StationIndex::const_iterator origin = index.find(Station::GetIfValid(i->first));
+			if (origin != index.end()) fixed[origin->second] = false;
+		}
+	}
+
+	for (NodeID node_id = 0; node_id < size; ++node_id) {
+		Node &node = this->nodes[node_id];
+		node.flows_fixed = fixed[node_id];
+		GoodsEntry &ge = Station::Get(node.station)->goods[this->cargo];
+		for (FlowStatMap::iterator i = ge.flows.begin(); i != ge.flows.end(); ++i) {
+			StationIndex::const_iterator origin = index.find(Station::GetIfValid(i->first));
+			if (origin == index.end() || !fixed[origin->second]) continue;
+			FlowViaMap &fixed_flows = node.fixed_flows[i->first];
+			for (FlowStatSet::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+				if (j->Planned() > 0) fixed_flows[j->Via()] += j->Planned();
+			}
+		}
+
+		if (changed[node_id]) {
+			for (LinkStatMap::iterator i = ge.link_stats.begin(); i != ge.link_stats.end(); ++i) {
+				i->second.SetRecalcCapacity();
 			}
 		}
 	}
+}
 
-	/* here the list of nodes and edges for this component is complete. */
-	this->SpawnThread();
+
+/**
+ * 1. Build the link graph component containing the given station.
+ * 2. Set every included station's last_component to the new component's ID (this->current_component_id).
+ * 3. Start a link graph job with the new component.
+ * @param first Station to start the search at.
+ */
+void LinkGraph::CreateComponent(Station *first)
+{
+	StationIndex index;
+	this->Build(first, index);
+
+	for (StationIndex::iterator i = index.begin(); i != index.end(); ++i) {
+		i->first->goods[this->cargo].last_component = this->LinkGraphComponent::index;
+	}
+
+	this->FixUnchangedFlows(index);
+	this->Spawn();
 }
 
 /**
@@ -185,6 +296,7 @@ void OnTick_LinkGraph()
 			if (_date_fract == LinkGraph::COMPONENTS_SPAWN_TICK) {
 				_link_graphs[cargo].NextComponent();
 			} else /* LinkGraph::COMPONENTS_JOIN_TICK */ {
+				TickProfileTimer timer(TPS_LINKGRAPH_JOIN);
 				_link_graphs[cargo].Join();
 			}
 		}
@@ -192,83 +304,164 @@ void OnTick_LinkGraph()
 }
 
 /**
- * Add a node to the component and create empty edges associated with it. Set
- * the station's last_component to this component. Calculate the distances to all
- * other nodes. The distances to _all_ nodes are important as the demand
- * calculator relies on their availability.
- * @param st New node's station.
- * @return New node's ID.
+ * Build the component containing the given station by using BFS on the link
+ * stats and index its edges. The game state isn't modified.
+ * @param first Station to start the search at.
+ * @param stations Mapping of stations to nodes, filled with the stations found.
  */
-NodeID LinkGraphComponent::AddNode(Station *st)
+void LinkGraphComponent::Build(Station *first, StationIndex &stations)
 {
-	GoodsEntry &good = st->goods[this->cargo];
-	good.last_component = this->index;
+	stations[first] = this->AddNode(first);
 
-	bool do_resize = (this->nodes.size() == this->num_nodes);
+	std::queue<Station *> search_queue;
+	search_queue.push(first);
 
-	if (do_resize) {
-		this->nodes.push_back(Node());
-		this->edges.push_back(std::vector<Edge>(this->num_nodes + 1));
+	/* find all stations belonging to the current component */
+	while (!search_queue.empty()) {
+		Station *source = search_queue.front();
+		search_queue.pop();
+
+		const LinkStatMap &links = source->goods[this->cargo].link_stats;
+		for (LinkStatMap::const_iterator i = links.begin(); i != links.end(); ++i) {
+			Station *target = Station::GetIfValid(i->first);
+			if (target == NULL) continue;
+
+			StationIndex::iterator stations_it = stations.find(target);
+			if (stations_it == stations.end()) {
+				search_queue.push(target);
+				NodeID node = this->AddNode(target);
+				stations[target] = node;
+
+				this->AddEdge(stations[source], node, i->second.Capacity());
+			} else {
+				this->AddEdge(stations[source], stations_it->second, i->second.Capacity());
+			}
+		}
 	}
 
-	this->nodes[this->num_nodes].Init(st->index, good.supply,
-			HasBit(good.acceptance_pickup, GoodsEntry::ACCEPTANCE));
+	/* here the list of nodes and edges for this component is complete. */
+	this->IndexEdges();
+}
 
-	std::vector<Edge> &new_edges = this->edges[this->num_nodes];
+/**
+ * Add a node to the component.
+ * @param st New node's station.
+ * @return New node's ID.
+ */
+NodeID LinkGraphComponent::AddNode(Station *st)
+{
+	const GoodsEntry &good = st->goods[this->cargo];
 
-	/* reset the first edge starting at the new node */
-	new_edges[this->num_nodes].next_edge = INVALID_NODE;
+	if (this->nodes.size() == this->num_nodes) this->nodes.push_back(Node());
+
+	this->nodes[this->num_nodes].Init(st->index, good.supply,
+			HasBit(good.acceptance_pickup, GoodsEntry::ACCEPTANCE), st->xy);
 
-	for (NodeID i = 0; i < this->num_nodes; ++i) {
-		uint distance = DistanceManhattan(st->xy, Station::Get(this->nodes[i].station)->xy);
-		if (do_resize) this->edges[i].push_back(Edge());
-		new_edges[i].Init(distance);
-		this->edges[i][this->num_nodes].Init(distance);
-	}
 	return this->num_nodes++;
 }
 
 /**
- * Fill an edge with values from a link.
+ * Add an edge for a link. The edges only become accessible after IndexEdges
+ * has been called.
  * @param from Source node of the link.
  * @param to Destination node of the link.
  * @param capacity Capacity of the link.
  */
-FORCEINLINE void LinkGraphComponent::AddEdge(NodeID from, NodeID to, uint capacity)
+void LinkGraphComponent::AddEdge(NodeID from, NodeID to, uint capacity)
 {
 	assert(from != to);
-	Edge &edge = this->edges[from][to];
-	Edge &first = this->edges[from][from];
-	edge.capacity = capacity;
-	edge.next_edge = first.next_edge;
-	first.next_edge = to;
+	this->edges.push_back(Edge());
+	this->edges.back().Init(to, capacity);
+	this->edge_sources.push_back(from);
 }
 
 /**
- * Resize the component and fill it with empty nodes and edges. Used when
- * loading from save games.
- *
- * WARNING: The nodes and edges are expected to contain anything while
- * num_nodes is expected to contain the desired size. Normally this is an
- * invalid state, but just after loading the component's structure it is valid.
- * This method should only be called from Load_LGRP.
+ * Group the edges by source node, keeping the order they were added in for
+ * each node, and calculate their lengths. Has to be called after all nodes
+ * and edges have been added.
  */
-void LinkGraphComponent::SetSize()
+void LinkGraphComponent::IndexEdges()
 {
-	if (this->nodes.size() < this->num_nodes) {
-		for (EdgeMatrix::iterator i = this->edges.begin(); i != this->edges.end(); ++i) {
-			i->resize(this->num_nodes);
+	assert(this->edge_sources.size() == this->edges.size());
+
+	/* count the edges starting at each node */
+	this->first_edge.assign(this->num_nodes + 1, 0);
+	for (std::vector<NodeID>::iterator i = this->edge_sources.begin(); i != this->edge_sources.end(); ++i) {
+		this->first_edge[*i + 1]++;
+	}
+	for (NodeID node = 0; node < this->num_nodes; ++node) {
+		this->first_edge[node + 1] += this->first_edge[node];
+	}
+
+	std::vector<uint> next(this->first_edge.begin(), this->first_edge.end() - 1);
+	EdgeVector sorted(this->edges.size());
+	for (uint i = 0; i < this->edges.size(); ++i) {
+		NodeID from = this->edge_sources[i];
+		Edge &edge = sorted[next[from]++];
+		edge = this->edges[i];
+		edge.distance = this->GetDistance(from, edge.to);
+	}
+
+	this->edges.swap(sorted);
+	this->edge_sources.clear();
+}
+
+/**
+ * Add the flows taken over from the last calculation to the edges they pass,
+ * so that the capacity they use isn't assigned a second time. Has to be called
+ * after IndexEdges.
+ */
+void LinkGraphComponent::ApplyFixedFlows()
+{
+	for (NodeID from = 0; from < this->num_nodes; ++from) {
+		FlowMap &fixed_flows = this->nodes[from].fixed_flows;
+		if (fixed_flows.empty()) continue;
+		EdgeIterator end = this->GetEdgesEnd(from);
+		for (EdgeIterator edge = this->GetEdgesBegin(from); edge != end; ++edge) {
+			StationID via = this->nodes[edge->to].station;
+			for (FlowMap::iterator i = fixed_flows.begin(); i != fixed_flows.end(); ++i) {
+				FlowViaMap::iterator flow = i->second.find(via);
+				if (flow != i->second.end()) edge->flow += flow->second;
+			}
 		}
-		this->nodes.resize(this->num_nodes);
-		this->edges.resize(this->num_nodes, std::vector<Edge>(this->num_nodes));
 	}
+}
+
+/**
+ * Get the edge between two nodes. The edge has to exist.
+ * @param from Source node.
+ * @param to Destination node.
+ * @return Edge between from and to.
+ */
+Edge &LinkGraphComponent::GetEdge(NodeID from, NodeID to)
+{
+	EdgeIterator end = this->GetEdgesEnd(from);
+	for (EdgeIterator i = this->GetEdgesBegin(from); i != end; ++i) {
+		if (i->to == to) return *i;
+	}
+	NOT_REACHED();
+}
+
+/**
+ * Resize the component and fill it with empty nodes. Used when loading from
+ * save games.
+ *
+ * WARNING: The nodes are expected to contain anything while num_nodes is
+ * expected to contain the desired size. Normally this is an invalid state, but
+ * just after loading the component's structure it is valid. This method should
+ * only be called from Load_LGRP.
+ */
+void LinkGraphComponent::SetSize()
+{
+	if (this->nodes.size() < this->num_nodes) this->nodes.resize(this->num_nodes);
 
 	for (uint i = 0; i < this->num_nodes; ++i) {
 		this->nodes[i].Init();
-		for (uint j = 0; j < this->num_nodes; ++j) {
-			this->edges[i][j].Init();
-		}
 	}
+	this->path_allocator.Reset();
+	this->edges.clear();
+	this->edge_sources.clear();
+	this->first_edge.clear();
 }
 
 /**
@@ -319,10 +512,10 @@ void Node::ExportNewFlows(FlowMap::iterator &it, FlowStatSet &dest, CargoID carg
 				if (next != this->station) {
 					const LinkStatMap &ls = curr_station->goods[cargo].link_stats;
 					if (ls.find(next) != ls.end()) {
-						dest.insert(FlowStat(distance, next, planned, 0));
+						dest.Insert(FlowStat(distance, next, planned, 0));
 					}
 				} else {
-					dest.insert(FlowStat(distance, next, planned, 0));
+					dest.Insert(FlowStat(distance, next, planned, 0));
 				}
 			}
 			source_flows.erase(update++);
@@ -339,6 +532,15 @@ void Node::ExportNewFlows(FlowMap::iterator &it, FlowStatSet &dest, CargoID carg
  */
 void Node::ExportFlows(CargoID cargo)
 {
+	/* add the flows taken over from the last calculation */
+	for (FlowMap::iterator i = this->fixed_flows.begin(); i != this->fixed_flows.end(); ++i) {
+		FlowViaMap &via_flows = this->flows[i->first];
+		for (FlowViaMap::iterator j = i->second.begin(); j != i->second.end(); ++j) {
+			via_flows[j->first] += j->second;
+		}
+	}
+	this->fixed_flows.clear();
+
 	FlowStatMap &station_flows = Station::Get(this->station)->goods[cargo].flows;
 	FlowStatSet new_flows;
 	/* loop over all existing flows in the station and update them */
@@ -351,20 +553,19 @@ void Node::ExportFlows(CargoID cargo)
 			FlowViaMap &source = node_outer_it->second;
 			FlowStatSet &dest = station_outer_it->second;
 			/* loop over the station's flow stats for this source node and update them */
-			for (FlowStatSet::iterator station_inner_it(dest.begin()); station_inner_it != dest.end();) {
+			for (FlowStatSet::const_iterator station_inner_it(dest.begin()); station_inner_it != dest.end(); ++station_inner_it) {
 				FlowViaMap::iterator node_inner_it(source.find(station_inner_it->Via()));
 				if (node_inner_it != source.end()) {
 					assert(node_inner_it->second >= 0);
 					if (node_inner_it->second > 0) {
-						new_flows.insert(FlowStat(*station_inner_it, node_inner_it->second));
+						new_flows.Insert(FlowStat(*station_inner_it, node_inner_it->second));
 					}
 					source.erase(node_inner_it);
 				}
-				dest.erase(station_inner_it++);
 			}
-			/* swap takes constant time, so we swap instead of adding all entries */
+			/* swap takes constant time, so we swap instead of copying all entries */
 			dest.swap(new_flows);
-			assert(new_flows.empty());
+			new_flows.clear();
 			/* insert remaining flows for this source node */
 			ExportNewFlows(node_outer_it, dest, cargo);
 			/* careful: source_flows is dangling here */
@@ -385,6 +586,9 @@ void LinkGraph::Join()
 {
 	this->LinkGraphJob::Join();
 
+	if (this->GetSize() > 0) DEBUG(linkgraph, 2, "Joining component %d of cargo %d with %d nodes; queued " OTTD_PRINTF64 ", ran " OTTD_PRINTF64 " cycles",
+			this->GetIndex(), this->GetCargo(), this->GetSize(), this->GetTask().GetQueueTime(), this->GetTask().GetRunTime());
+
 	for (NodeID node_id = 0; node_id < this->GetSize(); ++node_id) {
 		Node &node = this->GetNode(node_id);
 		if (Station::IsValidID(node.station)) {
@@ -406,6 +610,7 @@ void LinkGraph::Join()
 /* static */ void LinkGraphJob::RunLinkGraphJob(void *j)
 {
 	LinkGraphJob *job = (LinkGraphJob *)j;
+	job->ApplyFixedFlows();
 	for (HandlerList::iterator i = _handlers.begin(); i != _handlers.end(); ++i) {
 		(*i)->Run(job);
 	}
@@ -473,6 +678,17 @@ uint Path::AddFlow(uint new_flow, LinkGraphComponent *graph, bool only_positive)
 	return new_flow;
 }
 
+/**
+ * Free all chunks of the allocator. The paths in there don't have to be
+ * destructed.
+ */
+PathAllocator::~PathAllocator()
+{
+	for (std::vector<Block *>::iterator i = this->chunks.begin(); i != this->chunks.end(); ++i) {
+		free(*i);
+	}
+}
+
 /**
  * create a leg of a path in the link graph.
  * @param n id of the link graph node this path passes
@@ -487,35 +703,41 @@ Path::Path(NodeID n, bool source) :
 {}
 
 /**
- * Join the calling thread with this job's thread if threading is enabled.
+ * Wait for this job to finish. If no worker has started it yet it's run in the
+ * calling thread.
  */
 FORCEINLINE void LinkGraphJob::Join()
 {
-	if (this->thread == NULL) return;
-	this->thread->Join();
-	delete this->thread;
-	this->thread = NULL;
+	LinkGraphJob::_workers.Wait(&this->task);
 }
 
 /**
- * Spawn a thread if possible and run the link graph job in the thread. If
- * that's not possible run the job right now in the current thread.
+ * Queue the job for the worker threads. If there are no workers the job is
+ * run right now in the current thread.
  */
-void LinkGraphJob::SpawnThread()
+void LinkGraphJob::Spawn()
 {
-	assert(this->thread == NULL);
-	if (!ThreadObject::New(&(LinkGraphJob::RunLinkGraphJob), this, &(this->thread))) {
-		this->thread = NULL;
-		/* Of course this will hang a bit.
-		 * On the other hand, if you want to play games which make this hang noticably
-		 * on a platform without threads then you'll probably get other problems first.
-		 * OK:
-		 * If someone comes and tells me that this hangs for him/her, I'll implement a
-		 * smaller grained "Step" method for all handlers and add some more ticks where
-		 * "Step" is called. No problem in principle.
-		 */
-		LinkGraphJob::RunLinkGraphJob(this);
-	}
+	LinkGraphJob::_workers.Enqueue(&this->task);
+}
+
+/**
+ * (Re-)Start the worker threads with the configured number of threads. All
+ * jobs have to be joined before.
+ */
+/* static */ void LinkGraphJob::StartWorkers()
+{
+	uint num_threads = _linkgraph_threads != 0 ? _linkgraph_threads : GetCPUCoreCount();
+	if (LinkGraphJob::_workers.GetNumThreads() == num_threads) return;
+	LinkGraphJob::_workers.Start(num_threads);
+	DEBUG(linkgraph, 1, "Started %d link graph worker threads", LinkGraphJob::_workers.GetNumThreads());
+}
+
+/**
+ * Stop the worker threads. All jobs have to be joined before.
+ */
+/* static */ void LinkGraphJob::StopWorkers()
+{
+	LinkGraphJob::_workers.Stop();
 }
 
 /**
@@ -538,6 +760,7 @@ void LinkGraph::Init(CargoID cargo)
 void InitializeLinkGraphs()
 {
 	for (CargoID c = 0; c < NUM_CARGO; ++c) _link_graphs[c].Init(c);
+	LinkGraphJob::StartWorkers();
 
 	LinkGraphJob::ClearHandlers();
 	LinkGraphJob::AddHandler(new DemandHandler);
@@ -546,3 +769,14 @@ void InitializeLinkGraphs()
 	LinkGraphJob::AddHandler(new MCFHandler<MCF2ndPass>);
 	LinkGraphJob::AddHandler(new FlowMapper);
 }
+
+/**
+ * Join all link graph jobs, stop the worker threads and delete the handlers.
+ * Used when shutting down.
+ */
+void UninitializeLinkGraphs()
+{
+	for (CargoID c = 0; c < NUM_CARGO; ++c) _link_graphs[c].Init(c);
+	LinkGraphJob::StopWorkers();
+	LinkGraphJob::ClearHandlers();
+}
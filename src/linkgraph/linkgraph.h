@@ -14,9 +14,10 @@
 
 #include "../station_base.h"
 #include "../cargo_type.h"
-#include "../thread/thread.h"
+#include "../thread/worker_pool.h"
 #include "../settings_type.h"
 #include "../date_func.h"
+#include "../map_func.h"
 #include "linkgraph_type.h"
 #include <list>
 #include <vector>
@@ -24,12 +25,41 @@
 
 struct SaveLoad;
 class Path;
+class PathAllocator;
+class LinkGraphComponent;
 
 typedef std::set<Path *> PathSet;
 typedef std::map<NodeID, Path *> PathViaMap;
 typedef std::map<StationID, int> FlowViaMap;
 typedef std::map<StationID, FlowViaMap> FlowMap;
 
+/**
+ * Demand between two nodes of the link graph, i.e. the amount of cargo to be
+ * sent from one node to another one. Demands are kept at their source node.
+ */
+class Demand {
+public:
+	NodeID to;               ///< Node the cargo is sent to.
+	uint demand;             ///< Transport demand between the nodes.
+	uint unsatisfied_demand; ///< Demand that hasn't been satisfied yet.
+
+	/**
+	 * Create a demand.
+	 * @param to Receiving node.
+	 * @param demand Amount of cargo to be sent there.
+	 */
+	Demand(NodeID to, uint demand) : to(to), demand(demand), unsatisfied_demand(demand) {}
+
+	/**
+	 * Order demands by receiving node.
+	 * @param other Demand to compare with.
+	 * @return If this demand's receiving node has a lower ID than the other one's.
+	 */
+	FORCEINLINE bool operator<(const Demand &other) const {return this->to < other.to;}
+};
+
+typedef std::vector<Demand> DemandVector;
+
 /**
  * Node of the link graph. contains all relevant information from the associated
  * station. It's copied so that the link graph job can work on its own data set
@@ -41,39 +71,253 @@ public:
 	uint undelivered_supply; ///< Amount of supply that hasn't been distributed yet.
 	uint demand;             ///< Acceptance at the station.
 	StationID station;       ///< Station ID.
+	TileIndex xy;            ///< Location of the station, used to calculate distances.
 	PathSet paths;           ///< Paths through this node.
 	FlowMap flows;           ///< Planned flows to other nodes.
+	DemandVector demands;    ///< Demands towards other nodes, ordered by destination.
+	FlowMap fixed_flows;     ///< Flows through this node taken over from the last calculation. Not modified by the job.
+	bool flows_fixed;        ///< If the flows originating at this node are taken over from the last calculation.
+
+	void Init(StationID st = INVALID_STATION, uint sup = 0, uint dem = 0, TileIndex xy = INVALID_TILE);
+	void ExportFlows(CargoID cargo);
 
 	/**
-	 * Clear a node on destruction to delete paths that might remain.
+	 * Add demand towards another node. Multiple demands towards the same
+	 * node are only merged by MergeDemands.
+	 * @param to Receiving node.
+	 * @param amount Amount of cargo to be sent there.
 	 */
-	~Node() {this->Init();}
+	FORCEINLINE void AddDemand(NodeID to, uint amount)
+	{
+		if (amount > 0) this->demands.push_back(Demand(to, amount));
+	}
 
-	void Init(StationID st = INVALID_STATION, uint sup = 0, uint dem = 0);
-	void ExportFlows(CargoID cargo);
+	void MergeDemands();
+
+	bool HasUnsatisfiedDemand() const;
 
 private:
 	void ExportNewFlows(FlowMap::iterator &it, FlowStatSet &via_set, CargoID cargo);
 };
 
 /**
- * An edge in the link graph. Corresponds to a link between two stations or at
- * least the distance between them. Edges from one node to itself contain the
- * ID of the opposite Node of the first active edge (i.e. not just distance) in
- * the column as next_edge.
+ * An edge in the link graph. Corresponds to a link between two stations. The
+ * edges of a component are kept in one array, grouped by source node.
  */
 class Edge {
 public:
+	NodeID to;               ///< Destination of the link.
 	uint distance;           ///< Length of the link.
 	uint capacity;           ///< Capacity of the link.
-	uint demand;             ///< Transport demand between the nodes.
-	uint unsatisfied_demand; ///< Demand over this edge that hasn't been satisfied yet.
 	uint flow;               ///< Planned flow over this edge.
-	NodeID next_edge;        ///< Destination of next valid edge starting at the same source node.
 
-	void Init(uint distance = 0, uint capacity = 0);
+	/**
+	 * Create an edge. The distance is calculated when the edges are indexed.
+	 * @param to Destination node of the link.
+	 * @param capacity Capacity of the link.
+	 */
+	FORCEINLINE void Init(NodeID to = INVALID_NODE, uint capacity = 0)
+	{
+		this->to = to;
+		this->distance = 0;
+		this->capacity = capacity;
+		this->flow = 0;
+	}
 };
 
+/**
+ * A leg of a path in the link graph. Paths can form trees by being "forked".
+ */
+class Path {
+public:
+	Path(NodeID n, bool source = false);
+
+	FORCEINLINE void *operator new(size_t size, PathAllocator &allocator);
+	FORCEINLINE void operator delete(void *p, PathAllocator &allocator);
+
+	/** Get the node this leg passes. */
+	FORCEINLINE NodeID GetNode() const {return this->node;}
+
+	/** Get the overall origin of the path. */
+	FORCEINLINE NodeID GetOrigin() const {return this->origin;}
+
+	/** Get the parent leg of this one. */
+	FORCEINLINE Path *GetParent() {return this->parent;}
+
+	/** Get the overall capacity of the path. */
+	FORCEINLINE uint GetCapacity() const {return this->capacity;}
+
+	/** Get the free capacity of the path. */
+	FORCEINLINE int GetFreeCapacity() const {return this->free_capacity;}
+
+	/**
+	 * Get ratio of free * 16 (so that we get fewer 0) /
+	 * overall capacity + 1 (so that we don't divide by 0).
+	 */
+	FORCEINLINE int GetCapacityRatio() const {return (this->free_capacity << 4) / (this->capacity + 1);}
+
+	/** Get the overall distance of the path. */
+	FORCEINLINE uint GetDistance() const {return this->distance;}
+
+	/** Reduce the flow on this leg only by the specified amount. */
+	FORCEINLINE void ReduceFlow(uint f) {this->flow -= f;}
+
+	/** Increase the flow on this leg only by the specified amount. */
+	FORCEINLINE void AddFlow(uint f) {this->flow += f;}
+
+	/** Get the flow on this leg. */
+	FORCEINLINE uint GetFlow() const {return this->flow;}
+
+	/** Get the number of "forked off" child legs of this one. */
+	FORCEINLINE uint GetNumChildren() const {return this->num_children;}
+
+	/**
+	 * Detach this path from its parent.
+	 */
+	FORCEINLINE void Detach()
+	{
+		if (this->parent != NULL) {
+			this->parent->num_children--;
+			this->parent = NULL;
+		}
+	}
+
+	uint AddFlow(uint f, LinkGraphComponent *graph, bool only_positive);
+	void Fork(Path *base, uint cap, int free_cap, uint dist);
+
+protected:
+	uint distance;     ///< Sum(distance of all legs up to this one).
+	uint capacity;     ///< This capacity is min(capacity) fom all edges.
+	int free_capacity; ///< This capacity is min(edge.capacity - edge.flow) for the current run of Dijkstra.
+	uint flow;         ///< Flow the current run of the mcf solver assigns.
+	NodeID node;       ///< Link graph node this leg passes.
+	NodeID origin;     ///< Link graph node this path originates from.
+	uint num_children; ///< Number of child legs that have been forked from this path.
+	Path *parent;      ///< Parent leg of this one.
+};
+
+/**
+ * Allocator for the paths of a link graph component. Paths are created and
+ * deleted in large numbers while the MCF solver is running. Instead of going
+ * through the heap for each of them they're carved out of chunks owned by the
+ * component and recycled via a free list. The chunks are kept for the next
+ * component calculated in the same job.
+ * @note All classes allocated here must have the same size as Path.
+ */
+class PathAllocator {
+public:
+	PathAllocator() : free_list(NULL), current(0), used(0), in_use(0), peak_in_use(0), allocations(0) {}
+	~PathAllocator();
+
+	/**
+	 * Get a block for a path.
+	 * @return Uninitialized memory of the size of a Path.
+	 */
+	FORCEINLINE void *Allocate()
+	{
+		this->allocations++;
+		if (++this->in_use > this->peak_in_use) this->peak_in_use = this->in_use;
+		if (this->free_list != NULL) {
+			Block *block = this->free_list;
+			this->free_list = block->next;
+			return block;
+		}
+		if (this->used == CHUNK_SIZE) {
+			this->current++;
+			this->used = 0;
+		}
+		if (this->current == this->chunks.size()) this->chunks.push_back(MallocT<Block>(CHUNK_SIZE));
+		return &this->chunks[this->current][this->used++];
+	}
+
+	/**
+	 * Return a path's block to the allocator. Paths don't need to be
+	 * destructed.
+	 * @param path Path to be freed.
+	 */
+	FORCEINLINE void Free(Path *path)
+	{
+		Block *block = reinterpret_cast<Block *>(path);
+		this->in_use--;
+		block->next = this->free_list;
+		this->free_list = block;
+	}
+
+	/**
+	 * Free all paths at once. The memory is kept for reuse.
+	 */
+	FORCEINLINE void Reset()
+	{
+		this->free_list = NULL;
+		this->current = 0;
+		this->used = 0;
+		this->in_use = 0;
+	}
+
+	/**
+	 * Get the number of paths allocated since the last call to ResetStats.
+	 * @return Number of allocations.
+	 */
+	FORCEINLINE uint GetAllocations() const {return this->allocations;}
+
+	/**
+	 * Get the maximum memory used by paths at any time since the last call
+	 * to ResetStats.
+	 * @return Peak memory in bytes.
+	 */
+	FORCEINLINE size_t GetPeakMemory() const {return this->peak_in_use * sizeof(Block);}
+
+	/**
+	 * Reset the allocation statistics.
+	 */
+	FORCEINLINE void ResetStats()
+	{
+		this->allocations = 0;
+		this->peak_in_use = this->in_use;
+	}
+
+private:
+	static const uint CHUNK_SIZE = 1024; ///< Number of paths per chunk.
+
+	/** Memory for one path, or link in the free list if unused. */
+	union Block {
+		Block *next;            ///< Next free block.
+		byte data[sizeof(Path)]; ///< Space for a path.
+	};
+
+	std::vector<Block *> chunks; ///< Chunks of memory blocks.
+	Block *free_list;            ///< Blocks freed since the last reset.
+	uint current;                ///< Chunk blocks are currently taken from.
+	uint used;                   ///< Blocks taken from the current chunk.
+	uint in_use;                 ///< Blocks currently holding paths.
+	uint peak_in_use;            ///< Maximum of in_use since the last call to ResetStats.
+	uint allocations;            ///< Number of calls to Allocate since the last call to ResetStats.
+
+	PathAllocator(const PathAllocator &other);
+};
+
+/**
+ * Allocate a path from the given allocator.
+ * @param size Size of the path; must be sizeof(Path).
+ * @param allocator Allocator to take the memory from.
+ * @return Memory for the path.
+ */
+FORCEINLINE void *Path::operator new(size_t size, PathAllocator &allocator)
+{
+	assert(size == sizeof(Path));
+	return allocator.Allocate();
+}
+
+/**
+ * Give back the memory for a path whose constructor failed.
+ * @param p Memory of the path.
+ * @param allocator Allocator the memory was taken from.
+ */
+FORCEINLINE void Path::operator delete(void *p, PathAllocator &allocator)
+{
+	allocator.Free(static_cast<Path *>(p));
+}
+
 /**
  * A connected component of a link graph. Contains a complete set of stations
  * connected by links as nodes and edges. Each component also holds a copy of
@@ -83,22 +327,46 @@ public:
 class LinkGraphComponent {
 private:
 	typedef std::vector<Node> NodeVector;
-	typedef std::vector<std::vector<Edge> > EdgeMatrix;
+	typedef std::vector<Edge> EdgeVector;
 
 public:
+	typedef EdgeVector::iterator EdgeIterator;
+
 	LinkGraphComponent();
 
 	void Init(LinkGraphComponentID id);
 
+	Edge &GetEdge(NodeID from, NodeID to);
+
+	/**
+	 * Get the first edge starting at the specified node.
+	 * @param from ID of the source node.
+	 * @return Iterator pointing to the first edge.
+	 */
+	FORCEINLINE EdgeIterator GetEdgesBegin(NodeID from)
+	{
+		return this->edges.begin() + this->first_edge[from];
+	}
+
 	/**
-	 * Get a reference to an edge.
-	 * @param from Origin node.
-	 * @param to Destination node.
-	 * @return Edge between from and to.
+	 * Get the end of the edges starting at the specified node.
+	 * @param from ID of the source node.
+	 * @return Iterator pointing behind the last edge.
 	 */
-	FORCEINLINE Edge &GetEdge(NodeID from, NodeID to)
+	FORCEINLINE EdgeIterator GetEdgesEnd(NodeID from)
 	{
-		return this->edges[from][to];
+		return this->edges.begin() + this->first_edge[from + 1];
+	}
+
+	/**
+	 * Get the distance between two nodes, whether they're connected or not.
+	 * @param from First node.
+	 * @param to Second node.
+	 * @return Manhattan distance between the nodes' stations.
+	 */
+	FORCEINLINE uint GetDistance(NodeID from, NodeID to) const
+	{
+		return DistanceManhattan(this->nodes[from].xy, this->nodes[to].xy);
 	}
 
 	/**
@@ -120,12 +388,30 @@ public:
 		return this->num_nodes;
 	}
 
+	/**
+	 * Get the number of edges in the component.
+	 * @return Number of edges.
+	 */
+	FORCEINLINE uint GetNumEdges() const
+	{
+		return (uint)this->edges.size();
+	}
+
 	void SetSize();
 
+	/** Mapping of stations to the nodes representing them. */
+	typedef std::map<Station *, NodeID> StationIndex;
+
+	void Build(Station *first, StationIndex &stations);
+
 	NodeID AddNode(Station *st);
 
 	void AddEdge(NodeID from, NodeID to, uint capacity);
 
+	void IndexEdges();
+
+	void ApplyFixedFlows();
+
 	/**
 	 * Get the ID of this component.
 	 * @return ID.
@@ -154,11 +440,13 @@ public:
 	}
 
 	/**
-	 * Get the first valid edge starting at the specified node.
-	 * @param from ID of the source node
-	 * @return ID of the destination node
+	 * Get the allocator for the paths in this component.
+	 * @return Path allocator.
 	 */
-	FORCEINLINE NodeID GetFirstEdge(NodeID from) {return edges[from][from].next_edge;}
+	FORCEINLINE PathAllocator &GetPathAllocator()
+	{
+		return this->path_allocator;
+	}
 
 	/**
 	 * Set the number of nodes to 0 to mark this component as done.
@@ -166,6 +454,10 @@ public:
 	FORCEINLINE void Clear()
 	{
 		this->num_nodes = 0;
+		this->path_allocator.Reset();
+		this->edges.clear();
+		this->edge_sources.clear();
+		this->first_edge.clear();
 	}
 
 protected:
@@ -174,7 +466,10 @@ protected:
 	uint num_nodes;             ///< Number of nodes in the component.
 	LinkGraphComponentID index; ///< ID of the component.
 	NodeVector nodes;           ///< Nodes in the component.
-	EdgeMatrix edges;           ///< Edges in the component.
+	EdgeVector edges;           ///< Edges in the component, grouped by source node after IndexEdges.
+	std::vector<NodeID> edge_sources; ///< Source nodes of the edges while the component is being built.
+	std::vector<uint> first_edge;     ///< Index of each node's first edge in edges plus the number of edges as last entry.
+	PathAllocator path_allocator;     ///< Memory for the paths calculated on this component.
 };
 
 /**
@@ -198,8 +493,9 @@ public:
 
 /**
  * A job to be executed on a link graph component. It inherits a component and
- * keeps a static list of handlers to be run on it. It may or may not run in a
- * thread and contains a thread object for this option.
+ * keeps a static list of handlers to be run on it. Jobs are queued in a pool
+ * of persistent worker threads shared by all link graphs, or run right away if
+ * there are no workers.
  */
 class LinkGraphJob : public LinkGraphComponent {
 private:
@@ -207,10 +503,10 @@ private:
 
 public:
 
-	LinkGraphJob() : thread(NULL) {}
+	LinkGraphJob() : task(&LinkGraphJob::RunLinkGraphJob, this) {}
 
 	/**
-	 * Destructor; Clean up the thread if it's there.
+	 * Destructor; Wait for the job if it's still queued or running.
 	 */
 	~LinkGraphJob()
 	{
@@ -230,20 +526,44 @@ public:
 
 	static void ClearHandlers();
 
-	void SpawnThread();
+	static void StartWorkers();
+
+	static void StopWorkers();
+
+	/**
+	 * Get the worker threads, so that handlers can split their work into
+	 * smaller tasks. Those have to be waited for before the handler returns.
+	 * @return Worker pool of the link graph jobs.
+	 */
+	static FORCEINLINE WorkerPool &GetWorkers()
+	{
+		return LinkGraphJob::_workers;
+	}
+
+	void Spawn();
 
 	void Join();
 
+	/**
+	 * Get the task this job is executed in, for timing information.
+	 * @return Worker task of the job.
+	 */
+	FORCEINLINE const WorkerTask &GetTask() const
+	{
+		return this->task;
+	}
+
 private:
 	static HandlerList _handlers;   ///< Handlers the job is executing.
-	ThreadObject *thread;           ///< Thread the job is running in or NULL if it's running in the main thread.
+	static WorkerPool _workers;     ///< Worker threads shared by all jobs.
+	WorkerTask task;                ///< Task the job is queued as in _workers.
 
 	/**
 	 * Private Copy-Constructor: there cannot be two identical LinkGraphJobs.
 	 * @param other hypothetical other job to be copied.
 	 * @note It's necessary to explicitly initialize the link graph component in order to silence some compile warnings.
 	 */
-	LinkGraphJob(const LinkGraphJob &other) : LinkGraphComponent(other) {NOT_REACHED();}
+	LinkGraphJob(const LinkGraphJob &other) : LinkGraphComponent(), task(other.task) {NOT_REACHED();}
 };
 
 /**
@@ -272,77 +592,12 @@ private:
 	friend const SaveLoad *GetLinkGraphDesc();
 
 	void CreateComponent(Station *first);
-};
-
-/**
- * A leg of a path in the link graph. Paths can form trees by being "forked".
- */
-class Path {
-public:
-	Path(NodeID n, bool source = false);
-
-	/** Get the node this leg passes. */
-	FORCEINLINE NodeID GetNode() const {return this->node;}
-
-	/** Get the overall origin of the path. */
-	FORCEINLINE NodeID GetOrigin() const {return this->origin;}
-
-	/** Get the parent leg of this one. */
-	FORCEINLINE Path *GetParent() {return this->parent;}
-
-	/** Get the overall capacity of the path. */
-	FORCEINLINE uint GetCapacity() const {return this->capacity;}
-
-	/** Get the free capacity of the path. */
-	FORCEINLINE int GetFreeCapacity() const {return this->free_capacity;}
-
-	/**
-	 * Get ratio of free * 16 (so that we get fewer 0) /
-	 * overall capacity + 1 (so that we don't divide by 0).
-	 */
-	FORCEINLINE int GetCapacityRatio() const {return (this->free_capacity << 4) / (this->capacity + 1);}
-
-	/** Get the overall distance of the path. */
-	FORCEINLINE uint GetDistance() const {return this->distance;}
-
-	/** Reduce the flow on this leg only by the specified amount. */
-	FORCEINLINE void ReduceFlow(uint f) {this->flow -= f;}
-
-	/** Increase the flow on this leg only by the specified amount. */
-	FORCEINLINE void AddFlow(uint f) {this->flow += f;}
-
-	/** Get the flow on this leg. */
-	FORCEINLINE uint GetFlow() const {return this->flow;}
-
-	/** Get the number of "forked off" child legs of this one. */
-	FORCEINLINE uint GetNumChildren() const {return this->num_children;}
-
-	/**
-	 * Detach this path from its parent.
-	 */
-	FORCEINLINE void Detach()
-	{
-		if (this->parent != NULL) {
-			this->parent->num_children--;
-			this->parent = NULL;
-		}
-	}
-
-	uint AddFlow(uint f, LinkGraphComponent *graph, bool only_positive);
-	void Fork(Path *base, uint cap, int free_cap, uint dist);
-
-protected:
-	uint distance;     ///< Sum(distance of all legs up to this one).
-	uint capacity;     ///< This capacity is min(capacity) fom all edges.
-	int free_capacity; ///< This capacity is min(edge.capacity - edge.flow) for the current run of Dijkstra.
-	uint flow;         ///< Flow the current run of the mcf solver assigns.
-	NodeID node;       ///< Link graph node this leg passes.
-	NodeID origin;     ///< Link graph node this path originates from.
-	uint num_children; ///< Number of child legs that have been forked from this path.
-	Path *parent;      ///< Parent leg of this one.
+	void FixUnchangedFlows(const StationIndex &index);
 };
 
 void InitializeLinkGraphs();
+void UninitializeLinkGraphs();
+extern uint8 _linkgraph_threads;
 extern LinkGraph _link_graphs[NUM_CARGO];
 
 #endif /* LINKGRAPH_H_ */
@@ -65,6 +65,146 @@ bool CapacityAnnotation::IsBetter(const CapacityAnnotation *base, uint cap,
 	}
 }
 
+/* The annotations are allocated in the same blocks as plain paths. */
+assert_compile(sizeof(DistanceAnnotation) == sizeof(Path));
+assert_compile(sizeof(CapacityAnnotation) == sizeof(Path));
+
+/**
+ * Binary heap of annotations, ordered by Tannotation::Comparator. It keeps
+ * track of each annotation's position so that annotations can be updated in
+ * place. As the comparators define a strict total order annotations are
+ * popped in the same order as from a std::set with the same comparator.
+ * @tparam Tannotation Annotation to be kept in the heap.
+ */
+template<class Tannotation>
+class AnnotationHeap {
+public:
+	/**
+	 * Create an empty heap for the annotations of a component's nodes.
+	 * @param size Number of nodes in the component.
+	 */
+	AnnotationHeap(uint size) : positions(size, NOT_CONTAINED)
+	{
+		this->items.reserve(size);
+	}
+
+	/**
+	 * Check if the heap is empty.
+	 * @return If there are no annotations in the heap.
+	 */
+	FORCEINLINE bool IsEmpty() const {return this->items.empty();}
+
+	/**
+	 * Check if an annotation is in the heap.
+	 * @param anno Annotation to look for.
+	 * @return If the annotation is in the heap.
+	 */
+	FORCEINLINE bool Contains(const Tannotation *anno) const
+	{
+		return this->positions[anno->GetNode()] != NOT_CONTAINED;
+	}
+
+	/**
+	 * Add an annotation to the heap. It must not be in the heap already.
+	 * @param anno Annotation to be added.
+	 */
+	void Push(Tannotation *anno)
+	{
+		assert(!this->Contains(anno));
+		uint pos = (uint)this->items.size();
+		this->items.push_back(anno);
+		this->positions[anno->GetNode()] = pos;
+		this->SiftUp(pos);
+	}
+
+	/**
+	 * Remove the best annotation from the heap.
+	 * @return Annotation that has been removed.
+	 */
+	Tannotation *Pop()
+	{
+		assert(!this->IsEmpty());
+		Tannotation *best = this->items.front();
+		this->positions[best->GetNode()] = NOT_CONTAINED;
+		Tannotation *last = this->items.back();
+		this->items.pop_back();
+		if (!this->items.empty()) {
+			this->Place(last, 0);
+			this->SiftDown(0);
+		}
+		return best;
+	}
+
+	/**
+	 * Restore the heap order after an annotation in the heap has changed.
+	 * @param anno Annotation that has changed.
+	 */
+	void Update(Tannotation *anno)
+	{
+		assert(this->Contains(anno));
+		uint pos = this->positions[anno->GetNode()];
+		if (!this->SiftUp(pos)) this->SiftDown(pos);
+	}
+
+private:
+	static const uint NOT_CONTAINED = UINT_MAX; ///< Position of annotations not in the heap.
+
+	std::vector<Tannotation *> items; ///< Annotations in heap order.
+	std::vector<uint> positions;      ///< Position of each node's annotation in items.
+	typename Tannotation::Comparator comp; ///< Comparator defining the order.
+
+	/**
+	 * Put an annotation at a position in the heap.
+	 * @param anno Annotation to be placed.
+	 * @param pos Position to place it at.
+	 */
+	FORCEINLINE void Place(Tannotation *anno, uint pos)
+	{
+		this->items[pos] = anno;
+		this->positions[anno->GetNode()] = pos;
+	}
+
+	/**
+	 * Move an annotation towards the top of the heap as far as necessary.
+	 * @param pos Position of the annotation.
+	 * @return If the annotation has been moved.
+	 */
+	bool SiftUp(uint pos)
+	{
+		Tannotation *anno = this->items[pos];
+		uint start = pos;
+		while (pos > 0) {
+			uint parent = (pos - 1) / 2;
+			if (!this->comp(anno, this->items[parent])) break;
+			this->Place(this->items[parent], pos);
+			pos = parent;
+		}
+		this->Place(anno, pos);
+		return pos != start;
+	}
+
+	/**
+	 * Move an annotation towards the bottom of the heap as far as necessary.
+	 * @param pos Position of the annotation.
+	 */
+	void SiftDown(uint pos)
+	{
+		Tannotation *anno = this->items[pos];
+		uint size = (uint)this->items.size();
+		for (;;) {
+			uint child = 2 * pos + 1;
+			if (child >= size) break;
+			if (child + 1 < size && this->comp(this->items[child + 1], this->items[child])) child++;
+			if (!this->comp(this->items[child], anno)) break;
+			this->Place(this->items[child], pos);
+			pos = child;
+		}
+		this->Place(anno, pos);
+	}
+};
+
+template<class Tannotation> const uint AnnotationHeap<Tannotation>::NOT_CONTAINED;
+
 /**
  * A slightly modified Dijkstra algorithm. Grades the paths not necessarily by
  * distance, but by the value Tannotation computes. It can also be configured
@@ -82,24 +222,23 @@ template<class Tannotation>
 void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths,
 		bool create_new_paths)
 {
-	typedef std::set<Tannotation *, typename Tannotation::Comparator> AnnoSet;
 	uint size = this->graph->GetSize();
 	StationID source_station = this->graph->GetNode(source_node).station;
-	AnnoSet annos;
+	PathAllocator &allocator = this->graph->GetPathAllocator();
+	AnnotationHeap<Tannotation> annos(size);
 	paths.resize(size, NULL);
 	for (NodeID node = 0; node < size; ++node) {
-		Tannotation *anno = new Tannotation(node, node == source_node);
-		annos.insert(anno);
+		Tannotation *anno = new (allocator) Tannotation(node, node == source_node);
+		annos.Push(anno);
 		paths[node] = anno;
 	}
-	while (!annos.empty()) {
-		typename AnnoSet::iterator i = annos.begin();
-		Tannotation *source = *i;
-		annos.erase(i);
+	while (!annos.IsEmpty()) {
+		Tannotation *source = annos.Pop();
 		NodeID from = source->GetNode();
-		NodeID to = this->graph->GetFirstEdge(from);
-		while (to != INVALID_NODE) {
-			Edge &edge = this->graph->GetEdge(from, to);
+		LinkGraphComponent::EdgeIterator end = this->graph->GetEdgesEnd(from);
+		for (LinkGraphComponent::EdgeIterator i = this->graph->GetEdgesBegin(from); i != end; ++i) {
+			Edge &edge = *i;
+			NodeID to = edge.to;
 			assert(edge.distance < UINT_MAX);
 			if (create_new_paths || this->graph->GetNode(from)
 					.flows[source_station][this->graph->GetNode(to).station] > 0) {
@@ -113,12 +252,15 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths,
 				uint distance = edge.distance + 1;
 				Tannotation *dest = static_cast<Tannotation *>(paths[to]);
 				if (dest->IsBetter(source, capacity, capacity - edge.flow, distance)) {
-					annos.erase(dest);
 					dest->Fork(source, capacity, capacity - edge.flow, distance);
-					annos.insert(dest);
+					/* Nodes that have already been visited are visited again. */
+					if (annos.Contains(dest)) {
+						annos.Update(dest);
+					} else {
+						annos.Push(dest);
+					}
 				}
 			}
-			to = edge.next_edge;
 		}
 	}
 }
@@ -130,6 +272,7 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths,
  */
 void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
 {
+	PathAllocator &allocator = this->graph->GetPathAllocator();
 	Path *source = paths[source_id];
 	paths[source_id] = NULL;
 	for (PathVector::iterator i = paths.begin(); i != paths.end(); ++i) {
@@ -141,31 +284,31 @@ void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
 			path->Detach();
 			if (path->GetNumChildren() == 0) {
 				paths[path->GetNode()] = NULL;
-				delete path;
+				allocator.Free(path);
 			}
 			path = parent;
 		}
 	}
-	delete source;
+	allocator.Free(source);
 	paths.clear();
 }
 
 /**
  * Push flow along a path and update the unsatisfied_demand of the associated
- * edge.
- * @param edge Edge whose ends the path connects.
+ * demand.
+ * @param demand Demand between the nodes the path connects.
  * @param path End of the path the flow should be pushed on.
  * @param accuracy Accuracy of the calculation.
  * @param positive_cap If true only push flow up to the paths capacity,
  *                     otherwise the path can be "overloaded".
  */
-uint MultiCommodityFlow::PushFlow(Edge &edge, Path *path, uint accuracy,
+uint MultiCommodityFlow::PushFlow(Demand &demand, Path *path, uint accuracy,
 		bool positive_cap)
 {
-	assert(edge.unsatisfied_demand > 0);
-	uint flow = Clamp(edge.demand / accuracy, 1, edge.unsatisfied_demand);
+	assert(demand.unsatisfied_demand > 0);
+	uint flow = Clamp(demand.demand / accuracy, 1, demand.unsatisfied_demand);
 	flow = path->AddFlow(flow, this->graph, positive_cap);
-	edge.unsatisfied_demand -= flow;
+	demand.unsatisfied_demand -= flow;
 	return flow;
 }
 
@@ -215,9 +358,9 @@ void MCF1stPass::EliminateCycle(PathVector &path, Path *cycle_begin, uint flow)
  */
 bool MCF1stPass::EliminateCycles(PathVector &path, NodeID origin_id, NodeID next_id)
 {
-	static Path *invalid_path = new Path(INVALID_NODE, true);
+	static Path invalid_path(INVALID_NODE, true);
 	Path *at_next_pos = path[next_id];
-	if (at_next_pos == invalid_path) {
+	if (at_next_pos == &invalid_path) {
 		/* this node has already been searched */
 		return false;
 	} else if (at_next_pos == NULL) {
@@ -258,7 +401,7 @@ bool MCF1stPass::EliminateCycles(PathVector &path, NodeID origin_id, NodeID next
 		 * could be found in this branch, thus it has to be searched again next
 		 * time we spot it.
 		 */
-		path[next_id] = found ? NULL : invalid_path;
+		path[next_id] = found ? NULL : &invalid_path;
 		return found;
 	} else {
 		/* this node has already been visited => we have a cycle
@@ -309,27 +452,30 @@ MCF1stPass::MCF1stPass(LinkGraphComponent *graph) : MultiCommodityFlow(graph)
 		more_loops = false;
 
 		for (NodeID source = 0; source < size; ++source) {
+			if (!this->graph->GetNode(source).HasUnsatisfiedDemand()) continue;
+
 			/* first saturate the shortest paths */
 			this->Dijkstra<DistanceAnnotation>(source, paths, true);
 
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge &edge = this->graph->GetEdge(source, dest);
-				if (edge.unsatisfied_demand > 0) {
-					Path *path = paths[dest];
+			DemandVector &demands = this->graph->GetNode(source).demands;
+			for (DemandVector::iterator i = demands.begin(); i != demands.end(); ++i) {
+				Demand &demand = *i;
+				if (demand.unsatisfied_demand > 0) {
+					Path *path = paths[demand.to];
 					assert(path != NULL);
 					/* generally only allow paths that don't exceed the
 					 * available capacity. But if no demand has been assigned
 					 * yet, make an exception and allow any valid path *once*.
 					 */
-					if (path->GetFreeCapacity() > 0 && this->PushFlow(edge, path,
+					if (path->GetFreeCapacity() > 0 && this->PushFlow(demand, path,
 							accuracy, true) > 0) {
 						/* if a path has been found there is a chance we can
 						 * find more
 						 */
-						more_loops = (edge.unsatisfied_demand > 0);
-					} else if (edge.unsatisfied_demand == edge.demand &&
+						more_loops = (demand.unsatisfied_demand > 0);
+					} else if (demand.unsatisfied_demand == demand.demand &&
 							path->GetFreeCapacity() > INT_MIN) {
-						this->PushFlow(edge, path, accuracy, false);
+						this->PushFlow(demand, path, accuracy, false);
 					}
 				}
 			}
@@ -353,13 +499,16 @@ MCF2ndPass::MCF2ndPass(LinkGraphComponent *graph) : MultiCommodityFlow(graph)
 	while (demand_left) {
 		demand_left = false;
 		for (NodeID source = 0; source < size; ++source) {
+			if (!this->graph->GetNode(source).HasUnsatisfiedDemand()) continue;
+
 			this->Dijkstra<CapacityAnnotation>(source, paths, false);
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge &edge = this->graph->GetEdge(source, dest);
-				Path *path = paths[dest];
-				if (edge.unsatisfied_demand > 0 && path->GetFreeCapacity() > INT_MIN) {
-					this->PushFlow(edge, path, accuracy, false);
-					if (edge.unsatisfied_demand > 0) demand_left = true;
+			DemandVector &demands = this->graph->GetNode(source).demands;
+			for (DemandVector::iterator i = demands.begin(); i != demands.end(); ++i) {
+				Demand &demand = *i;
+				Path *path = paths[demand.to];
+				if (demand.unsatisfied_demand > 0 && path->GetFreeCapacity() > INT_MIN) {
+					this->PushFlow(demand, path, accuracy, false);
+					if (demand.unsatisfied_demand > 0) demand_left = true;
 				}
 			}
 			CleanupPaths(source, paths);
@@ -65,7 +65,7 @@ protected:
 
 	template<class ANNOTATION> void Dijkstra(NodeID from, PathVector &paths, bool create_new_paths);
 
-	uint PushFlow(Edge &edge, Path *path, uint accuracy, bool positive_cap);
+	uint PushFlow(Demand &demand, Path *path, uint accuracy, bool positive_cap);
 
 	void CleanupPaths(NodeID source, PathVector &paths);
 
@@ -25,6 +25,10 @@
 #include "tilehighlight_func.h"
 #include "network/network_func.h"
 #include "window_func.h"
+#include "pathfinder/yapf/yapf_cache.h"
+#include "pathfinder/water_regions.h"
+#include "pathfinder/network_components.h"
+#include "pathfinder/pf_query_log.h"
 
 
 extern TileIndex _cur_tileloop_tile;
@@ -65,6 +69,13 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	UnInitWindowSystem();
 
 	AllocateMap(size_x, size_y);
+	/* Nothing the pathfinders cached about the old map is valid anymore. */
+	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+	YapfNotifyRoadLayoutChange(INVALID_TILE);
+	InitializeWaterRegions();
+	InitializeNetworkComponents();
+	/* Recorded queries can only be replayed on the map they were asked on. */
+	StopPathfinderQueryRecording();
 
 	_pause_mode = PM_UNPAUSED;
 	_fast_forward = 0;
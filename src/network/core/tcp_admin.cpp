@@ -82,6 +82,7 @@ NetworkRecvStatus NetworkAdminSocketHandler::HandlePacket(Packet *p)
 		ADMIN_COMMAND(ADMIN_PACKET_SERVER_CONSOLE)
 		ADMIN_COMMAND(ADMIN_PACKET_SERVER_CMD_NAMES)
 		ADMIN_COMMAND(ADMIN_PACKET_SERVER_CMD_LOGGING)
+		ADMIN_COMMAND(ADMIN_PACKET_SERVER_TICK_PROFILE)
 
 		default:
 			if (this->HasClientQuit()) {
@@ -159,5 +160,6 @@ DEFINE_UNAVAILABLE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_RCON)
 DEFINE_UNAVAILABLE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_CONSOLE)
 DEFINE_UNAVAILABLE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_CMD_NAMES)
 DEFINE_UNAVAILABLE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_CMD_LOGGING)
+DEFINE_UNAVAILABLE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_TICK_PROFILE)
 
 #endif /* ENABLE_NETWORK */
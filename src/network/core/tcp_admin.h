@@ -58,6 +58,7 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_CONSOLE,         ///< The server gives the admin the data that got printed to its console.
 	ADMIN_PACKET_SERVER_CMD_NAMES,       ///< The server sends out the names of the DoCommands to the admins.
 	ADMIN_PACKET_SERVER_CMD_LOGGING,     ///< The server gives the admin copies of incoming command packets.
+	ADMIN_PACKET_SERVER_TICK_PROFILE,    ///< The server gives the admin how long the parts of the last ticks took.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -80,6 +81,7 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CONSOLE,         ///< The admin would like to have console messages.
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
+	ADMIN_UPDATE_TICK_PROFILE,    ///< The admin would like to have the tick profile.
 	ADMIN_UPDATE_END              ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -381,6 +383,27 @@ protected:
 	 */
 	DECLARE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_CMD_LOGGING);
 
+	/**
+	 * Send how long the parts of the last ticks took, in CPU cycles per tick.
+	 *
+	 * NOTICE: The parts are not stable and will not be treated as such. Do
+	 *         not rely on their names or order to be constant across
+	 *         different versions / revisions of OpenTTD. Parts are nested;
+	 *         the time of a part includes the time of the parts with a
+	 *         larger depth following it.
+	 *
+	 * uint16  Number of ticks the statistics are taken over.
+	 * These seven fields are repeated for each part:
+	 * bool    Data to follow.
+	 * string  Name of the part.
+	 * uint8   Nesting depth of the part.
+	 * uint64  Minimum time of the part in a tick.
+	 * uint64  Average time of the part in a tick.
+	 * uint64  Maximum time of the part in a tick.
+	 * uint64  99th percentile of the time of the part in a tick.
+	 */
+	DECLARE_ADMIN_RECEIVE_COMMAND(ADMIN_PACKET_SERVER_TICK_PROFILE);
+
 	NetworkRecvStatus HandlePacket(Packet *p);
 public:
 	NetworkRecvStatus CloseConnection(bool error = true);
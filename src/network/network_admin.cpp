@@ -23,6 +23,7 @@
 #include "../core/pool_func.hpp"
 #include "../map_func.h"
 #include "../rev.h"
+#include "../tick_profile.h"
 
 
 /* This file handles all the admin network commands. */
@@ -51,6 +52,7 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CONSOLE
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_TICK_PROFILE
 };
 assert_compile(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
 
@@ -496,6 +498,33 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdLogging(ClientID clien
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendTickProfile()
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_TICK_PROFILE);
+
+	TickProfileStats stats[TPS_END];
+	uint ticks = 0;
+	for (TickProfileSection section = TPS_GAME_LOOP; section < TPS_END; section++) {
+		ticks = GetTickProfileStats(section, &stats[section]);
+	}
+
+	p->Send_uint16(ticks);
+	for (TickProfileSection section = TPS_GAME_LOOP; section < TPS_END; section++) {
+		p->Send_bool  (true);
+		p->Send_string(GetTickProfileSectionName(section));
+		p->Send_uint8 (GetTickProfileSectionDepth(section));
+		p->Send_uint64(stats[section].min_cycles);
+		p->Send_uint64(stats[section].avg_cycles);
+		p->Send_uint64(stats[section].max_cycles);
+		p->Send_uint64(stats[section].p99_cycles);
+	}
+	p->Send_bool(false);
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /***********
  * Receiving functions
  ************/
@@ -604,6 +633,11 @@ DEF_ADMIN_RECEIVE_COMMAND(Server, ADMIN_PACKET_ADMIN_POLL)
 			this->SendCmdNames();
 			break;
 
+		case ADMIN_UPDATE_TICK_PROFILE:
+			/* The admin is requesting the tick profile. */
+			this->SendTickProfile();
+			break;
+
 		default:
 			/* An unsupported "poll" update type. */
 			DEBUG(net, 3, "[admin] Not supported poll %d (%d) from '%s' (%s).", type, d1, this->admin_name, this->admin_version);
@@ -851,6 +885,10 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_TICK_PROFILE:
+						as->SendTickProfile();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
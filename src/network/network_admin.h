@@ -66,6 +66,7 @@ public:
 	NetworkRecvStatus SendConsole(const char *origin, const char *command);
 	NetworkRecvStatus SendCmdNames();
 	NetworkRecvStatus SendCmdLogging(ClientID client_id, const CommandPacket *cp);
+	NetworkRecvStatus SendTickProfile();
 
 	static void Send();
 	static void AcceptConnection(SOCKET s, const NetworkAddress &address);
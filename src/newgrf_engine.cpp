@@ -710,7 +710,11 @@ static uint32 VehicleGetVariable(const ResolverObject *object, byte variable, by
 		case 0x14: return v->service_interval;
 		case 0x15: return GB(v->service_interval, 8, 8);
 		case 0x16: return v->last_station_visited;
-		case 0x17: return v->tick_counter;
+		case 0x17: {
+			/* The parts of road vehicles don't tick on their own, see WakeVehicle(). */
+			uint32 slept = (v->type == VEH_ROAD && !RoadVehicle::From(v)->IsFrontEngine()) ? 0 : GetSleptTicks(v->First());
+			return (byte)(v->tick_counter + slept);
+		}
 		case 0x18:
 		case 0x19: {
 			uint max_speed;
@@ -1047,6 +1051,17 @@ uint GetVehicleProperty(const Vehicle *v, PropertyID property, uint orig_value)
 }
 
 
+/**
+ * Check whether NewGRF callbacks, e.g. callback 36 for properties, can give a
+ * result for a vehicle. If not, all callbacks for it fail.
+ * @param v The vehicle.
+ * @return True if the vehicle has a sprite group to resolve callbacks with.
+ */
+bool HasVehicleCallbacks(const Vehicle *v)
+{
+	return GetVehicleSpriteGroup(v->engine_type, v, false) != NULL;
+}
+
 uint GetEngineProperty(EngineID engine, PropertyID property, uint orig_value)
 {
 	uint16 callback = GetVehicleCallback(CBID_VEHICLE_MODIFY_PROPERTY, property, 0, engine, NULL);
@@ -48,6 +48,7 @@ bool UsesWagonOverride(const Vehicle *v);
 /* Handler to Evaluate callback 36. If the callback fails (i.e. most of the
  * time) orig_value is returned */
 uint GetVehicleProperty(const Vehicle *v, PropertyID property, uint orig_value);
+bool HasVehicleCallbacks(const Vehicle *v);
 uint GetEngineProperty(EngineID engine, PropertyID property, uint orig_value);
 
 enum VehicleTrigger {
@@ -59,6 +59,9 @@
 #include "core/backup_type.hpp"
 #include "hotkeys.h"
 #include "newgrf.h"
+#include "tick_profile.h"
+#include "tick_benchmark.h"
+#include "pathfinder/pf_query_log.h"
 
 
 #include "town.h"
@@ -163,6 +166,12 @@ static void ShowHelp()
 		"  -e                  = Start Editor\n"
 		"  -g [savegame]       = Start new/save game immediately\n"
 		"  -G seed             = Set random seed\n"
+		"  -B ticks            = Run the savegame given with -g for 'ticks' ticks\n"
+		"                          as fast as possible without video, sound and\n"
+		"                          music, print how long they took, then quit\n"
+		"  -Q queries          = Let YAPF and NPF answer the pathfinder queries\n"
+		"                          recorded with 'pf_record' on the savegame given\n"
+		"                          with -g, print how long that took, then quit\n"
 #if defined(ENABLE_NETWORK)
 		"  -n [ip:port#company]= Start networkgame\n"
 		"  -p password         = Password to join server\n"
@@ -334,11 +343,11 @@ static void ShutdownGame()
 	/* Uninitialize variables that are allocated dynamically */
 	GamelogReset();
 
-	/* Reinitialize the link graphs to forcibly stop the threads.
+	/* Uninitialize the link graphs to forcibly stop the threads.
 	 * If a link graph thread is running while the link graph handlers are
 	 * deleted we get a crash.
 	 */
-	InitializeLinkGraphs();
+	UninitializeLinkGraphs();
 
 	_town_pool.CleanPool();
 	_industry_pool.CleanPool();
@@ -432,6 +441,8 @@ int ttd_main(int argc, char *argv[])
 	Year startyear = INVALID_YEAR;
 	uint generation_seed = GENERATE_NEW_SEED;
 	bool save_config = true;
+	uint benchmark_ticks = 0;
+	char *replay_queries = NULL;
 #if defined(ENABLE_NETWORK)
 	bool dedicated = false;
 	bool network   = false;
@@ -455,7 +466,7 @@ int ttd_main(int argc, char *argv[])
 	 *   a letter means: it accepts that param (e.g.: -h)
 	 *   a ':' behind it means: it need a param (e.g.: -m<driver>)
 	 *   a '::' behind it means: it can optional have a param (e.g.: -d<debug>) */
-	optformat = "m:s:v:b:hD::n::ei::I:S:M:t:d::r:g::G:c:xl:p:P:"
+	optformat = "m:s:v:b:hD::n::ei::I:S:M:t:d::r:g::G:B:Q:c:xl:p:P:"
 #if !defined(__MORPHOS__) && !defined(__AMIGA__) && !defined(WIN32)
 		"f"
 #endif
@@ -553,6 +564,11 @@ int ttd_main(int argc, char *argv[])
 			}
 			break;
 		case 'G': generation_seed = atoi(mgo.opt); break;
+		case 'B':
+			benchmark_ticks = atoi(mgo.opt);
+			if (benchmark_ticks == 0) usererror("Valid values for '-B' are positive numbers of ticks");
+			break;
+		case 'Q': free(replay_queries); replay_queries = strdup(mgo.opt); break;
 		case 'c': _config_file = strdup(mgo.opt); break;
 		case 'x': save_config = false; break;
 		case -2:
@@ -569,6 +585,17 @@ int ttd_main(int argc, char *argv[])
 		}
 	}
 
+	if (benchmark_ticks != 0 || replay_queries != NULL) {
+		/* Benchmarks run without any output, and should not change the configuration. */
+		free(musicdriver);
+		free(sounddriver);
+		free(videodriver);
+		musicdriver = strdup("null");
+		sounddriver = strdup("null");
+		videodriver = strdup("null");
+		save_config = false;
+	}
+
 #if defined(WINCE) && defined(_DEBUG)
 	/* Switch on debug lvl 4 for WinCE if Debug release, as you can't give params, and you most likely do want this information */
 	SetDebugString("4");
@@ -771,7 +798,14 @@ int ttd_main(int argc, char *argv[])
 	}
 #endif /* ENABLE_NETWORK */
 
-	_video_driver->MainLoop();
+	if (benchmark_ticks != 0) {
+		RunTickBenchmark(benchmark_ticks);
+	} else if (replay_queries != NULL) {
+		RunPathfinderReplayBenchmark(replay_queries);
+		free(replay_queries);
+	} else {
+		_video_driver->MainLoop();
+	}
 
 	WaitTillSaved();
 
@@ -1198,12 +1232,15 @@ void StateGameLoop()
 {
 	/* dont execute the state loop during pause */
 	if (_pause_mode != PM_UNPAUSED) {
+		/* Only the windows were updated, so the tick is not representative. */
+		FinishTickProfile(false);
 		UpdateLandscapingLimits();
 		CallWindowTickEvent();
 		return;
 	}
 	if (IsGeneratingWorld()) return;
 
+	uint64 start = ottd_rdtsc();
 	ClearStorageChanges(false);
 
 	if (_game_mode == GM_EDITOR) {
@@ -1236,7 +1273,10 @@ void StateGameLoop()
 		CallLandscapeTick();
 		ClearStorageChanges(true);
 
-		AI::GameLoop();
+		{
+			TickProfileTimer timer(TPS_AI);
+			AI::GameLoop();
+		}
 		UpdateLandscapingLimits();
 
 		CallWindowTickEvent();
@@ -1245,6 +1285,9 @@ void StateGameLoop()
 	}
 
 	assert(IsLocalCompany());
+
+	_tick_profile_current[TPS_GAME_LOOP] += ottd_rdtsc() - start;
+	FinishTickProfile(true);
 }
 
 /**
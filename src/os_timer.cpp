@@ -11,6 +11,14 @@
 
 #include "stdafx.h"
 
+#if defined(WIN32)
+#	include <windows.h>
+#elif defined(UNIX)
+#	include <sys/time.h>
+#else
+#	include <time.h>
+#endif
+
 #undef RDTSC_AVAILABLE
 
 /* rdtsc for MSC_VER, uses simple inline assembly, or _rdtsc
@@ -74,3 +82,25 @@ uint64 ottd_rdtsc()
 # endif
 uint64 ottd_rdtsc() {return 0;}
 #endif
+
+/**
+ * Get a monotonic time with a resolution good enough to measure single
+ * pathfinder runs or game ticks. Unlike ottd_rdtsc() its unit does not
+ * depend on the clock speed of the processor.
+ * @return The time in microseconds since some arbitrary moment.
+ */
+uint64 ottd_microseconds()
+{
+#if defined(WIN32)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#elif defined(UNIX)
+	struct timeval tim;
+	gettimeofday(&tim, NULL);
+	return (uint64)tim.tv_sec * 1000000 + tim.tv_usec;
+#else
+	return (uint64)clock() * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
@@ -0,0 +1,446 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_components.cpp Connected components of the rail and road networks, to tell unreachable destinations apart without searching. */
+
+#include "../stdafx.h"
+#include "../map_func.h"
+#include "../tile_cmd.h"
+#include "../track_func.h"
+#include "../tunnelbridge_map.h"
+#include "../station_base.h"
+#include "../roadveh.h"
+#include "../road_func.h"
+#include "../road_map.h"
+#include "../core/alloc_func.hpp"
+#include "../core/mem_func.hpp"
+#include "../core/smallvec_type.hpp"
+#include "network_components.h"
+
+#include <map>
+#include <set>
+
+/** Maximum number of changed tiles kept before the components are simply worked out again. */
+static const uint MAX_NETWORK_CHANGES = 4096;
+/** Maximum number of tiles looked at to find out whether removing some track split a component. */
+static const uint MAX_NETWORK_SPLIT_SEARCH_TILES = 8192;
+
+/** Bit of the edges of a tile telling it leads into a tunnel or onto a bridge. */
+static const uint NETWORK_EDGE_WORMHOLE = DIAGDIR_END;
+
+/**
+ * Get the edges of a tile a network crosses; also when the network only
+ * leads out of the tile over that edge in one direction. Each tile is seen
+ * as a single junction, regardless of how the tracks on it connect.
+ * @param tile The tile.
+ * @param type The network.
+ * @return Bit per DiagDirection, plus #NETWORK_EDGE_WORMHOLE; 0 if the tile is not part of the network.
+ */
+static byte GetNetworkEdges(TileIndex tile, TransportType type)
+{
+	byte edges = 0;
+	TrackBits tracks = TRACK_BIT_NONE;
+	if (type == TRANSPORT_ROAD) {
+		for (RoadType rt = ROADTYPE_ROAD; rt < ROADTYPE_END; rt++) {
+			if (IsNormalRoadTile(tile)) {
+				/* Road works block the road for a while, without the road itself changing;
+				 * use the road bits, where a single piece lets vehicles turn around. */
+				if (!HasTileRoadType(tile, rt)) continue;
+				RoadBits bits = GetRoadBits(tile, rt);
+				if (HasExactlyOneBit(bits)) bits |= MirrorRoadBits(bits);
+				for (DiagDirection dir = DIAGDIR_BEGIN; dir < DIAGDIR_END; dir++) {
+					if (bits & DiagDirToRoadBits(dir)) SetBit(edges, dir);
+				}
+			} else {
+				/* Trams can use track road vehicles can't, and the other way around. */
+				tracks |= TrackStatusToTrackBits(GetTileTrackStatus(tile, type, RoadTypeToRoadTypes(rt)));
+			}
+		}
+	} else {
+		tracks = TrackStatusToTrackBits(GetTileTrackStatus(tile, type, 0));
+	}
+	if (tracks == TRACK_BIT_NONE && edges == 0) return 0;
+
+	TrackdirBits trackdirs = TrackBitsToTrackdirBits(tracks);
+	while (trackdirs != TRACKDIR_BIT_NONE) {
+		SetBit(edges, TrackdirToExitdir(RemoveFirstTrackdir(&trackdirs)));
+	}
+
+	/* The edge into a tunnel or onto a bridge leads to the other end, not to the next tile. */
+	if (IsTileType(tile, MP_TUNNELBRIDGE)) {
+		ClrBit(edges, GetTunnelBridgeDirection(tile));
+		SetBit(edges, NETWORK_EDGE_WORMHOLE);
+	}
+	return edges;
+}
+
+/**
+ * The connected components of one network. Adding track only joins
+ * components, so that is handled right away. When track is removed, a
+ * short search finds out whether that split a component; only then all
+ * components are worked out again. Either way the components only depend
+ * on the map, and not on when they were updated.
+ */
+struct NetworkComponents {
+	TransportType type;                           ///< The network.
+	byte *edges;                                  ///< Edges of each tile as of the last update.
+	NetworkComponentID *labels;                   ///< Component each tile was put in; look up the actual component with Find().
+	SmallVector<NetworkComponentID, 64> parents;  ///< Union-find forest of the labels.
+	uint count;                                   ///< Number of components.
+	bool rebuild;                                 ///< Whether everything has to be worked out again.
+	SmallVector<TileIndex, 64> changes;           ///< Tiles changed since the last update.
+
+	/**
+	 * Create the (not yet worked out) components of a network.
+	 * @param type The network.
+	 */
+	NetworkComponents(TransportType type) : type(type), edges(NULL), labels(NULL), count(0), rebuild(true) {}
+
+	/**
+	 * Find the component of a label.
+	 * @param label The label.
+	 * @return The label representing the component.
+	 */
+	FORCEINLINE NetworkComponentID Find(NetworkComponentID label)
+	{
+		while (this->parents[label] != label) {
+			this->parents[label] = this->parents[this->parents[label]];
+			label = this->parents[label];
+		}
+		return label;
+	}
+
+	/**
+	 * Join the components of two labels.
+	 * @param a The first label.
+	 * @param b The second label.
+	 */
+	FORCEINLINE void Union(NetworkComponentID a, NetworkComponentID b)
+	{
+		a = this->Find(a);
+		b = this->Find(b);
+		if (a == b) return;
+		this->parents[max(a, b)] = min(a, b);
+		this->count--;
+	}
+
+	/**
+	 * Start a new component.
+	 * @return The label of the component.
+	 */
+	FORCEINLINE NetworkComponentID NewLabel()
+	{
+		NetworkComponentID label = this->parents.Length();
+		*this->parents.Append() = label;
+		this->count++;
+		return label;
+	}
+
+	/**
+	 * Get the tiles a tile is connected to, going by the stored edges.
+	 * @param tile The tile.
+	 * @param neighbours Array of at least 5 tiles to store the connected tiles in.
+	 * @return Number of connected tiles.
+	 */
+	uint GetConnectedTiles(TileIndex tile, TileIndex *neighbours) const
+	{
+		uint n = 0;
+		byte edges = this->edges[tile];
+		for (DiagDirection dir = DIAGDIR_BEGIN; dir < DIAGDIR_END; dir++) {
+			if (!HasBit(edges, dir)) continue;
+			TileIndexDiffC diff = TileIndexDiffCByDiagDir(dir);
+			TileIndex neighbour = TileAddWrap(tile, diff.x, diff.y);
+			if (neighbour != INVALID_TILE && HasBit(this->edges[neighbour], ReverseDiagDir(dir))) neighbours[n++] = neighbour;
+		}
+		if (HasBit(edges, NETWORK_EDGE_WORMHOLE)) neighbours[n++] = GetOtherTunnelBridgeEnd(tile);
+		return n;
+	}
+
+	/** Work out all components from scratch. */
+	void Rebuild()
+	{
+		if (this->edges == NULL) {
+			this->edges = MallocT<byte>(MapSize());
+			this->labels = MallocT<NetworkComponentID>(MapSize());
+		}
+		for (TileIndex tile = 0; tile < MapSize(); tile++) {
+			this->edges[tile] = GetNetworkEdges(tile, this->type);
+		}
+		MemSetT(this->labels, INVALID_NETWORK_COMPONENT, MapSize());
+		this->parents.Clear();
+		*this->parents.Append() = INVALID_NETWORK_COMPONENT;
+		this->count = 0;
+
+		SmallVector<TileIndex, 256> todo;
+		for (TileIndex start = 0; start < MapSize(); start++) {
+			if (this->edges[start] == 0 || this->labels[start] != INVALID_NETWORK_COMPONENT) continue;
+
+			NetworkComponentID label = this->NewLabel();
+			this->labels[start] = label;
+			*todo.Append() = start;
+			while (todo.Length() != 0) {
+				TileIndex tile = todo[todo.Length() - 1];
+				todo.Erase(todo.End() - 1);
+
+				TileIndex neighbours[5];
+				uint n = this->GetConnectedTiles(tile, neighbours);
+				for (uint i = 0; i < n; i++) {
+					if (this->labels[neighbours[i]] != INVALID_NETWORK_COMPONENT) continue;
+					this->labels[neighbours[i]] = label;
+					*todo.Append() = neighbours[i];
+				}
+			}
+		}
+
+		this->changes.Clear();
+		this->rebuild = false;
+	}
+
+	/**
+	 * Check whether some tiles are connected, looking at a limited number of tiles.
+	 * @param tiles The tiles.
+	 * @return True if they are certainly connected, false if they are not or it is not known.
+	 */
+	bool AreConnected(const SmallVector<TileIndex, 8> &tiles) const
+	{
+		std::set<TileIndex> seen;
+		SmallVector<TileIndex, 256> todo;
+		uint found = 1;
+		seen.insert(tiles[0]);
+		*todo.Append() = tiles[0];
+		while (todo.Length() != 0 && seen.size() < MAX_NETWORK_SPLIT_SEARCH_TILES) {
+			TileIndex tile = todo[todo.Length() - 1];
+			todo.Erase(todo.End() - 1);
+
+			TileIndex neighbours[5];
+			uint n = this->GetConnectedTiles(tile, neighbours);
+			for (uint i = 0; i < n; i++) {
+				if (!seen.insert(neighbours[i]).second) continue;
+				if (tiles.Contains(neighbours[i]) && ++found == tiles.Length()) return true;
+				*todo.Append() = neighbours[i];
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Bring the components up to date with the changed tiles.
+	 * @return False if a component may have been split, so everything has to be worked out again.
+	 */
+	bool ApplyChanges()
+	{
+		/* First update the edges of all changed tiles, so the checks below see the current network. */
+		SmallVector<TileIndex, 64> removed;
+		SmallVector<TileIndex, 64> added;
+		std::map<NetworkComponentID, SmallVector<TileIndex, 8> > remaining;
+		std::set<NetworkComponentID> shrunk;
+		for (const TileIndex *it = this->changes.Begin(); it != this->changes.End(); it++) {
+			TileIndex tile = *it;
+			byte old_edges = this->edges[tile];
+			byte new_edges = GetNetworkEdges(tile, this->type);
+			if (old_edges == new_edges) continue;
+			this->edges[tile] = new_edges;
+			if (new_edges != 0) *added.Append() = tile;
+			if ((old_edges & ~new_edges) == 0) continue;
+
+			/* The other end of a removed tunnel or bridge cannot be found anymore. */
+			if (HasBit(old_edges & ~new_edges, NETWORK_EDGE_WORMHOLE)) return false;
+			*removed.Append() = tile;
+			if (this->labels[tile] != INVALID_NETWORK_COMPONENT) shrunk.insert(this->Find(this->labels[tile]));
+		}
+
+		/* When track was removed, all tiles next to it that were in the same
+		 * component before must still be connected; otherwise the component
+		 * has been split. Components none of those tiles are left of are gone. */
+		for (const TileIndex *it = removed.Begin(); it != removed.End(); it++) {
+			TileIndex tile = *it;
+			for (DiagDirection dir = DIAGDIR_BEGIN; dir <= DIAGDIR_END; dir++) {
+				TileIndex neighbour = tile;
+				if (dir != DIAGDIR_END) {
+					TileIndexDiffC diff = TileIndexDiffCByDiagDir(dir);
+					neighbour = TileAddWrap(tile, diff.x, diff.y);
+				}
+				if (neighbour == INVALID_TILE || this->edges[neighbour] == 0 || this->labels[neighbour] == INVALID_NETWORK_COMPONENT) continue;
+				remaining[this->Find(this->labels[neighbour])].Include(neighbour);
+			}
+			if (this->edges[tile] == 0) this->labels[tile] = INVALID_NETWORK_COMPONENT;
+		}
+		for (std::set<NetworkComponentID>::iterator it = shrunk.begin(); it != shrunk.end(); it++) {
+			if (remaining.find(*it) == remaining.end()) this->count--;
+		}
+		for (std::map<NetworkComponentID, SmallVector<TileIndex, 8> >::iterator it = remaining.begin(); it != remaining.end(); it++) {
+			if (it->second.Length() > 1 && !this->AreConnected(it->second)) return false;
+		}
+
+		/* Added track can only join components. */
+		for (const TileIndex *it = added.Begin(); it != added.End(); it++) {
+			if (this->labels[*it] == INVALID_NETWORK_COMPONENT) this->labels[*it] = this->NewLabel();
+		}
+		for (const TileIndex *it = added.Begin(); it != added.End(); it++) {
+			TileIndex neighbours[5];
+			uint n = this->GetConnectedTiles(*it, neighbours);
+			for (uint i = 0; i < n; i++) {
+				if (this->labels[neighbours[i]] != INVALID_NETWORK_COMPONENT) this->Union(this->labels[*it], this->labels[neighbours[i]]);
+			}
+		}
+
+		this->changes.Clear();
+		return true;
+	}
+
+	/** Make sure the components match the map. */
+	void Update()
+	{
+		/* Every added tile takes a label; don't let them pile up forever. */
+		if (this->edges == NULL || this->rebuild || this->parents.Length() > MapSize()) {
+			this->Rebuild();
+		} else if (this->changes.Length() != 0 && !this->ApplyChanges()) {
+			this->Rebuild();
+		}
+	}
+
+	/** Forget everything, e.g. because a new map is loaded. */
+	void Reset()
+	{
+		free(this->edges);
+		free(this->labels);
+		this->edges = NULL;
+		this->labels = NULL;
+		this->parents.Reset();
+		this->changes.Reset();
+		this->count = 0;
+		this->rebuild = true;
+	}
+};
+
+/** Components of the rail and the road network, in that order. */
+static NetworkComponents _network_components[] = {
+	NetworkComponents(TRANSPORT_RAIL),
+	NetworkComponents(TRANSPORT_ROAD),
+};
+
+/**
+ * Get the up to date components of a network.
+ * @param type The network; rail or road.
+ * @return The components.
+ */
+static NetworkComponents &GetNetworkComponents(TransportType type)
+{
+	assert(type == TRANSPORT_RAIL || type == TRANSPORT_ROAD);
+	NetworkComponents &nc = _network_components[type];
+	nc.Update();
+	return nc;
+}
+
+/**
+ * Get the connected part of a network a tile belongs to. Trams and road
+ * vehicles share the road network; one way roads, road and rail types and
+ * owners are not taken into account, so vehicles may not be able to reach
+ * all tiles of their component. They can never reach other components.
+ * @param tile The tile.
+ * @param type The network; rail or road.
+ * @return The component, or #INVALID_NETWORK_COMPONENT if the tile is not part of the network.
+ */
+NetworkComponentID GetNetworkComponent(TileIndex tile, TransportType type)
+{
+	NetworkComponents &nc = GetNetworkComponents(type);
+	NetworkComponentID label = nc.labels[tile];
+	return label == INVALID_NETWORK_COMPONENT ? INVALID_NETWORK_COMPONENT : nc.Find(label);
+}
+
+/**
+ * Get the number of connected parts of a network.
+ * @param type The network; rail or road.
+ * @return The number of components.
+ */
+uint GetNetworkComponentCount(TransportType type)
+{
+	return GetNetworkComponents(type).count;
+}
+
+/**
+ * Check whether any tile of a station is in a component of a network.
+ * @param station The station.
+ * @param station_type The part of the station to check.
+ * @param component The component.
+ * @param type The network; rail or road.
+ * @return True iff a tile of the station is in the component.
+ */
+bool IsStationInNetworkComponent(StationID station, StationType station_type, NetworkComponentID component, TransportType type)
+{
+	TileArea ta;
+	BaseStation::Get(station)->GetTileArea(&ta, station_type);
+	TILE_AREA_LOOP(tile, ta) {
+		if (IsTileType(tile, MP_STATION) && GetStationIndex(tile) == station && GetNetworkComponent(tile, type) == component) return true;
+	}
+	return false;
+}
+
+/**
+ * Check whether a train or road vehicle certainly cannot reach the
+ * destination of its current order, so a pathfinder would search the
+ * whole network in vain.
+ * @param v The vehicle.
+ * @param tile The tile the vehicle is about to enter.
+ * @return True iff the destination is in another part of the network.
+ */
+bool IsVehicleDestinationUnreachable(const Vehicle *v, TileIndex tile)
+{
+	assert(v->type == VEH_TRAIN || v->type == VEH_ROAD);
+	TransportType type = (v->type == VEH_TRAIN) ? TRANSPORT_RAIL : TRANSPORT_ROAD;
+
+	NetworkComponentID component = GetNetworkComponent(tile, type);
+	if (component == INVALID_NETWORK_COMPONENT) return false;
+
+	StationType station_type;
+	switch (v->current_order.GetType()) {
+		case OT_GOTO_STATION:
+			station_type = (v->type == VEH_TRAIN) ? STATION_RAIL : (RoadVehicle::From(v)->IsBus() ? STATION_BUS : STATION_TRUCK);
+			break;
+
+		case OT_GOTO_WAYPOINT:
+			station_type = STATION_WAYPOINT;
+			break;
+
+		default: {
+			NetworkComponentID dest = GetNetworkComponent(v->dest_tile, type);
+			return dest != INVALID_NETWORK_COMPONENT && dest != component;
+		}
+	}
+
+	StationID station = v->current_order.GetDestination();
+	return BaseStation::IsValidID(station) && !IsStationInNetworkComponent(station, station_type, component, type);
+}
+
+/**
+ * Tell the components that a network may have changed on a tile.
+ * @param tile The changed tile.
+ * @param type The network; rail or road.
+ */
+void NotifyNetworkComponentChange(TileIndex tile, TransportType type)
+{
+	assert(type == TRANSPORT_RAIL || type == TRANSPORT_ROAD);
+	NetworkComponents &nc = _network_components[type];
+	if (nc.rebuild || tile >= MapSize()) return;
+
+	if (nc.changes.Length() >= MAX_NETWORK_CHANGES) {
+		nc.rebuild = true;
+		nc.changes.Clear();
+		return;
+	}
+	*nc.changes.Append() = tile;
+}
+
+/** Forget the components of all networks, e.g. because another map is loaded. */
+void InitializeNetworkComponents()
+{
+	for (uint i = 0; i < lengthof(_network_components); i++) {
+		_network_components[i].Reset();
+	}
+}
@@ -0,0 +1,38 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file network_components.h Connected components of the rail and road networks, to tell unreachable destinations apart without searching. */
+
+#ifndef NETWORK_COMPONENTS_H
+#define NETWORK_COMPONENTS_H
+
+#include "../tile_type.h"
+#include "../transport_type.h"
+#include "../station_type.h"
+#include "../vehicle_type.h"
+
+/**
+ * Identifier of a connected part of a network. Tiles with the same
+ * identifier may be connected; tiles with different identifiers are
+ * certainly not. The identifiers themselves differ between games that
+ * are in the same state, so only compare them.
+ */
+typedef uint32 NetworkComponentID;
+/** Component of tiles that are not part of the network. */
+static const NetworkComponentID INVALID_NETWORK_COMPONENT = 0;
+
+NetworkComponentID GetNetworkComponent(TileIndex tile, TransportType type);
+uint GetNetworkComponentCount(TransportType type);
+bool IsStationInNetworkComponent(StationID station, StationType station_type, NetworkComponentID component, TransportType type);
+bool IsVehicleDestinationUnreachable(const Vehicle *v, TileIndex tile);
+
+void NotifyNetworkComponentChange(TileIndex tile, TransportType type);
+void InitializeNetworkComponents();
+
+#endif /* NETWORK_COMPONENTS_H */
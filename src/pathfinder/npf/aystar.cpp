@@ -25,6 +25,7 @@
 
 #include "../../stdafx.h"
 #include "../../core/alloc_func.hpp"
+#include "../pf_performance_timer.hpp"
 #include "aystar.h"
 
 /**
@@ -107,6 +108,7 @@ void AyStar::CheckTile(AyStarNode *current, OpenListNode *parent)
 
 	/* Calculate the G-value for this node */
 	new_g = this->CalculateG(this, current, parent);
+	_pathfinder_stats.cost_calcs++;
 	/* If the value was INVALID_NODE, we don't do anything with this node */
 	if (new_g == AYSTAR_INVALID_NODE) return;
 
@@ -178,6 +180,7 @@ int AyStar::Loop()
 
 	/* Add the node to the ClosedList */
 	this->ClosedListAdd(&current->path);
+	_pathfinder_stats.nodes_expanded++;
 
 	/* Load the neighbours */
 	this->GetNeighbours(this, current);
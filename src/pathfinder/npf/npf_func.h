@@ -86,8 +86,9 @@ bool NPFTrainCheckReverse(const Train *v);
  * @param path_found [out] Whether a path has been found (true) or has been guessed (false)
  * @param reserve_track indicates whether YAPF should try to reserve the found path
  * @param target   [out] the target tile of the reservation, free is set to true if path was reserved
+ * @param origin   the end of the current reservation of the train, where the search starts
  * @return         the best track for next turn
  */
-Track NPFTrainChooseTrack(const Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, bool reserve_track, struct PBSTileInfo *target);
+Track NPFTrainChooseTrack(const Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, bool reserve_track, struct PBSTileInfo *target, const struct PBSTileInfo &origin);
 
 #endif /* NPF_FUNC_H */
@@ -12,7 +12,16 @@
 #ifndef PF_PERFORMANCE_TIMER_HPP
 #define PF_PERFORMANCE_TIMER_HPP
 
-extern uint64 ottd_rdtsc();
+extern uint64 ottd_microseconds();
+
+/** Totals of the work done by all pathfinder runs, to compare pathfinders and their optimisations. */
+struct PathfinderStats {
+	uint64 nodes_expanded; ///< Number of nodes whose neighbours were looked at.
+	uint64 cost_calcs;     ///< Number of node costs that had to be calculated.
+	uint64 cache_hits;     ///< Number of node costs that were taken from a cache.
+};
+
+extern PathfinderStats _pathfinder_stats;
 
 struct CPerformanceTimer
 {
@@ -38,12 +47,13 @@ struct CPerformanceTimer
 
 	FORCEINLINE int64 QueryTime()
 	{
-		return ottd_rdtsc();
+		return ottd_microseconds();
 	}
 
+	/** The times are measured in microseconds, whatever the clock speed of the processor. */
 	FORCEINLINE int64 QueryFrequency()
 	{
-		return ((int64)2200 * 1000000);
+		return 1000000;
 	}
 };
 
@@ -0,0 +1,281 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file pf_query_log.cpp Recording the pathfinder queries of a game and replaying them as benchmark. */
+
+#include "../stdafx.h"
+#include "../map_func.h"
+#include "../settings_type.h"
+#include "../train.h"
+#include "../roadveh.h"
+#include "../fios.h"
+#include "../pbs.h"
+#include "../tick_benchmark.h"
+#include "../core/mem_func.hpp"
+#include "../core/smallvec_type.hpp"
+#include "yapf/yapf.h"
+#include "yapf/yapf_cache.h"
+#include "npf/npf_func.h"
+#include "pf_performance_timer.hpp"
+#include "pf_query_log.h"
+
+/** Version of the format of the recorded queries. */
+static const uint PF_QUERY_LOG_VERSION = 2;
+
+uint32 _pathfinder_map_revision = 0;
+PathfinderStats _pathfinder_stats;
+
+static FILE *_pf_query_log = NULL;      ///< File the queries are recorded to, if recording.
+static uint32 _pf_query_log_revision;   ///< Map revision when the recording started.
+
+/** A single track choice of a vehicle, as recorded; without the answer given back then. */
+struct PathfinderQuery {
+	VehicleID vehicle;             ///< The vehicle that asked.
+	VehicleType type;              ///< Type of the vehicle.
+	VehiclePathFinders pathfinder; ///< Pathfinder that answered.
+	uint32 settings;               ///< Hash of the pathfinder settings.
+	uint32 map_revision;           ///< Number of map changes between the start of the recording and the query.
+	TileIndex tile;                ///< Tile the vehicle is about to enter.
+	DiagDirection enterdir;        ///< Direction the tile is entered in.
+	uint choices;                  ///< Tracks (trains) or trackdirs (road vehicles) to choose from.
+	TileIndex origin_tile;         ///< End of the reservation of the train, where the search started.
+	Trackdir origin_trackdir;      ///< Trackdir at the end of the reservation of the train.
+	bool reserve;                  ///< Whether the path was also reserved.
+	uint32 order;                  ///< Packed current order of the vehicle.
+	TileIndex dest_tile;           ///< Destination tile of the vehicle.
+};
+
+/**
+ * Get a hash of the settings that change how the pathfinders choose, but
+ * not which pathfinder is used.
+ * @return The hash.
+ */
+static uint32 GetPathfinderSettingsHash()
+{
+	PathfinderSettings pf;
+	MemCpyT(&pf, &_settings_game.pf);
+	pf.pathfinder_for_trains = 0;
+	pf.pathfinder_for_roadvehs = 0;
+	pf.pathfinder_for_ships = 0;
+
+	const byte *b = (const byte *)&pf;
+	uint32 hash = 2166136261U;
+	for (size_t i = 0; i < sizeof(pf); i++) {
+		hash = (hash ^ b[i]) * 16777619U;
+	}
+	return hash;
+}
+
+/**
+ * Get the pathfinder a type of vehicles uses.
+ * @param type The vehicle type; train or road vehicle.
+ * @return The pathfinder.
+ */
+static VehiclePathFinders GetPathfinderForVehicleType(VehicleType type)
+{
+	return (VehiclePathFinders)(type == VEH_TRAIN ? _settings_game.pf.pathfinder_for_trains : _settings_game.pf.pathfinder_for_roadvehs);
+}
+
+/**
+ * Record a track choice of a train or road vehicle, if recording.
+ * @param v The vehicle.
+ * @param tile The tile the vehicle is about to enter.
+ * @param enterdir The direction the tile is entered in.
+ * @param choices The tracks (trains) or trackdirs (road vehicles) to choose from.
+ * @param origin_tile End of the reservation of a train, where the search starts; INVALID_TILE for road vehicles.
+ * @param origin_trackdir Trackdir at the end of the reservation of a train; INVALID_TRACKDIR for road vehicles.
+ * @param reserve Whether the path was reserved too.
+ * @param result The chosen track or trackdir.
+ * @param path_found Whether a path to the destination was found.
+ */
+void RecordPathfinderQuery(const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint choices, TileIndex origin_tile, Trackdir origin_trackdir, bool reserve, int result, bool path_found)
+{
+	if (_pf_query_log == NULL) return;
+	assert(v->type == VEH_TRAIN || v->type == VEH_ROAD);
+
+	fprintf(_pf_query_log, "%u %u %u %08X %u %u %u %X %d %d %u %08X %u %d %u\n",
+			v->index, v->type, GetPathfinderForVehicleType(v->type), GetPathfinderSettingsHash(),
+			_pathfinder_map_revision - _pf_query_log_revision, tile, enterdir, choices, (int)origin_tile, origin_trackdir, reserve,
+			v->current_order.Pack(), v->dest_tile, result, path_found);
+}
+
+/**
+ * Start recording all track choices of trains and road vehicles. The
+ * queries can only be replayed on the game as it is now, so save it too.
+ * @param filename The file to record to.
+ * @return False if the file could not be written.
+ */
+bool StartPathfinderQueryRecording(const char *filename)
+{
+	StopPathfinderQueryRecording();
+
+	_pf_query_log = fopen(filename, "w");
+	if (_pf_query_log == NULL) return false;
+
+	_pf_query_log_revision = _pathfinder_map_revision;
+	fprintf(_pf_query_log, "OpenTTD pathfinder queries %u %u %u\n", PF_QUERY_LOG_VERSION, MapSizeX(), MapSizeY());
+	return true;
+}
+
+/**
+ * Stop recording track choices.
+ * @return False if nothing was being recorded.
+ */
+bool StopPathfinderQueryRecording()
+{
+	if (_pf_query_log == NULL) return false;
+
+	fclose(_pf_query_log);
+	_pf_query_log = NULL;
+	return true;
+}
+
+/**
+ * Read recorded queries.
+ * @param filename The file with the queries.
+ * @param queries The queries of the file are added to this.
+ */
+static void ReadPathfinderQueries(const char *filename, SmallVector<PathfinderQuery, 256> &queries)
+{
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) usererror("Cannot open pathfinder queries '%s'.", filename);
+
+	uint version, size_x, size_y;
+	if (fscanf(f, "OpenTTD pathfinder queries %u %u %u\n", &version, &size_x, &size_y) != 3 || version != PF_QUERY_LOG_VERSION) {
+		usererror("'%s' does not contain pathfinder queries of this version.", filename);
+	}
+
+	uint vehicle, type, pathfinder, enterdir, reserve, path_found;
+	uint32 settings, map_revision, order;
+	TileIndex tile, dest_tile;
+	uint choices;
+	int origin_tile, origin_trackdir;
+	int result;
+	while (fscanf(f, "%u %u %u %X %u %u %u %X %d %d %u %X %u %d %u\n", &vehicle, &type, &pathfinder, &settings, &map_revision, &tile, &enterdir,
+			&choices, &origin_tile, &origin_trackdir, &reserve, &order, &dest_tile, &result, &path_found) == 15) {
+		if ((type != VEH_TRAIN && type != VEH_ROAD) || (pathfinder != VPF_NPF && pathfinder != VPF_YAPF) || enterdir >= DIAGDIR_END) continue;
+		if (type == VEH_TRAIN && ((uint)origin_tile >= MapSize() || !IsValidTrackdir((Trackdir)origin_trackdir))) continue;
+
+		PathfinderQuery *q = queries.Append();
+		q->vehicle = vehicle;
+		q->type = (VehicleType)type;
+		q->pathfinder = (VehiclePathFinders)pathfinder;
+		q->settings = settings;
+		q->map_revision = map_revision;
+		q->tile = tile;
+		q->enterdir = (DiagDirection)enterdir;
+		q->choices = choices;
+		q->origin_tile = (TileIndex)origin_tile;
+		q->origin_trackdir = (Trackdir)origin_trackdir;
+		q->reserve = reserve != 0;
+		q->order = order;
+		q->dest_tile = dest_tile;
+	}
+	fclose(f);
+
+	if (size_x != MapSizeX() || size_y != MapSizeY()) usererror("The pathfinder queries were recorded on a map of another size.");
+}
+
+/**
+ * Ask a pathfinder a recorded question again. The vehicle gets the order
+ * it had back then for the duration of the query, and trains search from
+ * the recorded end of their reservation; paths are never reserved.
+ * @param q The query.
+ * @param pf The pathfinder to ask.
+ * @param result [out] The chosen track or trackdir.
+ * @param path_found [out] Whether a path to the destination was found.
+ * @return False if the vehicle of the query does not exist in this game.
+ */
+static bool ReplayPathfinderQuery(const PathfinderQuery &q, VehiclePathFinders pf, int *result, bool *path_found)
+{
+	Vehicle *v = Vehicle::GetIfValid(q.vehicle);
+	if (v == NULL || v->type != q.type || !v->IsPrimaryVehicle()) return false;
+
+	Order old_order = v->current_order;
+	TileIndex old_dest_tile = v->dest_tile;
+	v->current_order = Order(q.order);
+	v->dest_tile = q.dest_tile;
+
+	*path_found = true;
+	if (v->type == VEH_TRAIN) {
+		const Train *t = Train::From(v);
+		TrackBits tracks = (TrackBits)q.choices;
+		PBSTileInfo origin(q.origin_tile, q.origin_trackdir, false);
+		*result = (pf == VPF_YAPF) ? YapfTrainChooseTrack(t, q.tile, q.enterdir, tracks, *path_found, false, NULL, origin) : NPFTrainChooseTrack(t, q.tile, q.enterdir, tracks, *path_found, false, NULL, origin);
+	} else {
+		const RoadVehicle *rv = RoadVehicle::From(v);
+		TrackdirBits trackdirs = (TrackdirBits)q.choices;
+		*result = (pf == VPF_YAPF) ? YapfRoadVehicleChooseTrack(rv, q.tile, q.enterdir, trackdirs, *path_found) : NPFRoadVehicleChooseTrack(rv, q.tile, q.enterdir, trackdirs, *path_found);
+	}
+
+	v->current_order = old_order;
+	v->dest_tile = old_dest_tile;
+	return true;
+}
+
+/**
+ * Load the game selected with -g and let YAPF and NPF answer all queries
+ * recorded in a file. For each pathfinder print how much work that was,
+ * how long it took and a checksum of the answers, to compare builds.
+ * The answers are not compared with the recorded game: signals,
+ * reservations and other vehicles are as in the savegame, not as they
+ * were when the question was asked.
+ * @param filename The file with the queries.
+ */
+void RunPathfinderReplayBenchmark(const char *filename)
+{
+	LoadBenchmarkSavegame();
+
+	SmallVector<PathfinderQuery, 256> queries;
+	ReadPathfinderQueries(filename, queries);
+	printf("Replaying %u pathfinder queries on '%s'\n", queries.Length(), _file_to_saveload.name);
+
+	uint32 settings = GetPathfinderSettingsHash();
+	uint other_settings = 0;
+	uint other_map = 0;
+	for (const PathfinderQuery *q = queries.Begin(); q != queries.End(); q++) {
+		if (q->settings != settings) other_settings++;
+		if (q->map_revision != 0) other_map++;
+	}
+	if (other_settings != 0) printf("%u queries were recorded with other pathfinder settings than the savegame has.\n", other_settings);
+	if (other_map != 0) printf("%u queries were recorded after track or road was changed.\n", other_map);
+
+	static const VehiclePathFinders pathfinders[] = { VPF_YAPF, VPF_NPF };
+	for (uint i = 0; i < lengthof(pathfinders); i++) {
+		VehiclePathFinders pf = pathfinders[i];
+
+		/* Every pathfinder starts without anything cached. */
+		YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+		YapfNotifyRoadLayoutChange(INVALID_TILE);
+		MemSetT(&_pathfinder_stats, 0);
+
+		uint replayed = 0;
+		uint found = 0;
+		uint32 checksum = 2166136261U;
+		uint64 start = ottd_microseconds();
+		for (const PathfinderQuery *q = queries.Begin(); q != queries.End(); q++) {
+			int result;
+			bool path_found;
+			if (!ReplayPathfinderQuery(*q, pf, &result, &path_found)) continue;
+
+			replayed++;
+			if (path_found) found++;
+			checksum = (checksum ^ (uint32)result) * 16777619U;
+			checksum = (checksum ^ (uint32)path_found) * 16777619U;
+		}
+		uint64 total = ottd_microseconds() - start;
+
+		printf("%s: %u queries in %u.%03u ms (%u skipped, their vehicle does not exist)\n", pf == VPF_YAPF ? "YAPF" : "NPF",
+				replayed, (uint)(total / 1000), (uint)(total % 1000), queries.Length() - replayed);
+		printf("  nodes expanded: " OTTD_PRINTF64 ", costs calculated: " OTTD_PRINTF64 ", cache hits: " OTTD_PRINTF64 "\n",
+				_pathfinder_stats.nodes_expanded, _pathfinder_stats.cost_calcs, _pathfinder_stats.cache_hits);
+		printf("  paths found: %u, results checksum: %08X\n", found, checksum);
+	}
+	fflush(stdout);
+}
@@ -0,0 +1,29 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file pf_query_log.h Recording the pathfinder queries of a game and replaying them as benchmark. */
+
+#ifndef PF_QUERY_LOG_H
+#define PF_QUERY_LOG_H
+
+#include "../tile_type.h"
+#include "../direction_type.h"
+#include "../track_type.h"
+#include "../vehicle_type.h"
+
+/** Number of changes to the map the pathfinders were told about; to tell queries on different maps apart. */
+extern uint32 _pathfinder_map_revision;
+
+void RecordPathfinderQuery(const Vehicle *v, TileIndex tile, DiagDirection enterdir, uint choices, TileIndex origin_tile, Trackdir origin_trackdir, bool reserve, int result, bool path_found);
+bool StartPathfinderQueryRecording(const char *filename);
+bool StopPathfinderQueryRecording();
+
+void RunPathfinderReplayBenchmark(const char *filename);
+
+#endif /* PF_QUERY_LOG_H */
@@ -0,0 +1,296 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.cpp Dividing the water into regions and patches for high level ship pathfinding. */
+
+#include "../stdafx.h"
+#include "../map_func.h"
+#include "../tile_cmd.h"
+#include "../ship.h"
+#include "../core/alloc_func.hpp"
+#include "../core/mem_func.hpp"
+#include "follow_track.hpp"
+#include "water_regions.h"
+
+#include <map>
+#include <queue>
+
+/** Maximum number of patches a high level search looks at before giving up. */
+static const uint MAX_WATER_REGION_SEARCH_NODES = 2048;
+
+/** The water patches of one water region. */
+struct WaterRegion {
+	bool initialized;                                         ///< Whether the labels are up to date.
+	bool has_cross_region_aqueducts;                          ///< Whether an aqueduct leads from inside the region to another region.
+	byte number_of_patches;                                   ///< Number of patches in the region.
+	WaterRegionPatchLabel labels[WATER_REGION_NUMBER_OF_TILES]; ///< Patch of each tile of the region.
+};
+
+static WaterRegion *_water_regions = NULL; ///< All water regions, row by row.
+static uint _water_regions_x = 0;          ///< Number of water regions along the X axis of the map.
+
+/**
+ * Get the water region a tile is in.
+ * @param tile The tile.
+ * @return Index of the water region in #_water_regions.
+ */
+static FORCEINLINE uint GetWaterRegionIndex(TileIndex tile)
+{
+	return TileY(tile) / WATER_REGION_EDGE_LENGTH * _water_regions_x + TileX(tile) / WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Get the position of a tile within its water region.
+ * @param tile The tile.
+ * @return Index of the tile in WaterRegion::labels.
+ */
+static FORCEINLINE uint GetWaterRegionTileIndex(TileIndex tile)
+{
+	return (TileY(tile) % WATER_REGION_EDGE_LENGTH) * WATER_REGION_EDGE_LENGTH + TileX(tile) % WATER_REGION_EDGE_LENGTH;
+}
+
+/**
+ * Get the trackdirs ships can use on a tile.
+ * @param tile The tile.
+ * @return The trackdirs.
+ */
+static FORCEINLINE TrackdirBits GetWaterTrackdirs(TileIndex tile)
+{
+	return TrackStatusToTrackdirBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+}
+
+/**
+ * Label all tiles of a water region by the patch they are in. Two tiles
+ * are in the same patch when a ship can sail from one to the other
+ * without leaving the region. Sailing is symmetric for ships, so
+ * following the tracks from one tile finds its whole patch.
+ * @param region The region to label.
+ * @param index Index of the region in #_water_regions.
+ */
+static void UpdateWaterRegion(WaterRegion &region, uint index)
+{
+	MemSetT(region.labels, INVALID_WATER_REGION_PATCH, WATER_REGION_NUMBER_OF_TILES);
+	region.has_cross_region_aqueducts = false;
+	region.number_of_patches = 0;
+
+	uint x0 = index % _water_regions_x * WATER_REGION_EDGE_LENGTH;
+	uint y0 = index / _water_regions_x * WATER_REGION_EDGE_LENGTH;
+
+	CFollowTrackWater F(INVALID_OWNER);
+	SmallVector<TileIndex, 32> todo;
+	for (uint i = 0; i < WATER_REGION_NUMBER_OF_TILES; i++) {
+		if (region.labels[i] != INVALID_WATER_REGION_PATCH) continue;
+
+		TileIndex start = TileXY(x0 + i % WATER_REGION_EDGE_LENGTH, y0 + i / WATER_REGION_EDGE_LENGTH);
+		if (GetWaterTrackdirs(start) == TRACKDIR_BIT_NONE) continue;
+
+		/* Should the labels ever run out, the last patches are merged. That only
+		 * makes the regions look better connected than they are, which the low
+		 * level search then finds out. */
+		if (region.number_of_patches < UINT8_MAX) region.number_of_patches++;
+		WaterRegionPatchLabel label = region.number_of_patches;
+		region.labels[i] = label;
+		*todo.Append() = start;
+
+		while (todo.Length() != 0) {
+			TileIndex tile = todo[todo.Length() - 1];
+			todo.Erase(todo.End() - 1);
+
+			TrackdirBits trackdirs = GetWaterTrackdirs(tile);
+			while (trackdirs != TRACKDIR_BIT_NONE) {
+				Trackdir td = RemoveFirstTrackdir(&trackdirs);
+				if (!F.Follow(tile, td)) continue;
+
+				if (GetWaterRegionIndex(F.m_new_tile) != index) {
+					if (F.m_is_bridge) region.has_cross_region_aqueducts = true;
+					continue;
+				}
+
+				WaterRegionPatchLabel &new_label = region.labels[GetWaterRegionTileIndex(F.m_new_tile)];
+				if (new_label != INVALID_WATER_REGION_PATCH) continue;
+				new_label = label;
+				*todo.Append() = F.m_new_tile;
+			}
+		}
+	}
+
+	region.initialized = true;
+}
+
+/**
+ * Get a water region with up to date labels.
+ * @param index Index of the region in #_water_regions.
+ * @return The region.
+ */
+static const WaterRegion &GetUpdatedWaterRegion(uint index)
+{
+	WaterRegion &region = _water_regions[index];
+	if (!region.initialized) UpdateWaterRegion(region, index);
+	return region;
+}
+
+/**
+ * Get the water patch a tile is in.
+ * @param tile The tile.
+ * @return The patch; its label is #INVALID_WATER_REGION_PATCH if ships cannot sail on the tile.
+ */
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile)
+{
+	WaterRegionPatchDesc patch;
+	patch.x = TileX(tile) / WATER_REGION_EDGE_LENGTH;
+	patch.y = TileY(tile) / WATER_REGION_EDGE_LENGTH;
+	patch.label = GetUpdatedWaterRegion(GetWaterRegionIndex(tile)).labels[GetWaterRegionTileIndex(tile)];
+	return patch;
+}
+
+/**
+ * Check whether a tile is part of a water patch.
+ * @param tile The tile.
+ * @param patch The patch.
+ * @return True iff ships can sail on the tile and it is in the patch.
+ */
+bool IsTileInWaterRegionPatch(TileIndex tile, const WaterRegionPatchDesc &patch)
+{
+	if (TileX(tile) / WATER_REGION_EDGE_LENGTH != patch.x || TileY(tile) / WATER_REGION_EDGE_LENGTH != patch.y) return false;
+	return GetUpdatedWaterRegion(GetWaterRegionIndex(tile)).labels[GetWaterRegionTileIndex(tile)] == patch.label;
+}
+
+/**
+ * Find the water patches in other regions ships can sail to directly from a patch.
+ * @param patch The patch to start from.
+ * @param neighbours Found neighbours are added to this list.
+ */
+void GetWaterRegionPatchNeighbours(const WaterRegionPatchDesc &patch, WaterRegionPatchList &neighbours)
+{
+	uint index = patch.y * _water_regions_x + patch.x;
+	const WaterRegion &region = GetUpdatedWaterRegion(index);
+
+	static const uint last = WATER_REGION_EDGE_LENGTH - 1;
+	CFollowTrackWater F(INVALID_OWNER);
+	for (uint i = 0; i < WATER_REGION_NUMBER_OF_TILES; i++) {
+		if (region.labels[i] != patch.label) continue;
+
+		/* Without aqueducts only tiles at the border of the region can lead out of it. */
+		uint x = i % WATER_REGION_EDGE_LENGTH;
+		uint y = i / WATER_REGION_EDGE_LENGTH;
+		if (!region.has_cross_region_aqueducts && x != 0 && x != last && y != 0 && y != last) continue;
+
+		TileIndex tile = TileXY(patch.x * WATER_REGION_EDGE_LENGTH + x, patch.y * WATER_REGION_EDGE_LENGTH + y);
+		TrackdirBits trackdirs = GetWaterTrackdirs(tile);
+		while (trackdirs != TRACKDIR_BIT_NONE) {
+			Trackdir td = RemoveFirstTrackdir(&trackdirs);
+			if (!F.Follow(tile, td) || GetWaterRegionIndex(F.m_new_tile) == index) continue;
+			neighbours.Include(GetWaterRegionPatchInfo(F.m_new_tile));
+		}
+	}
+}
+
+/**
+ * Get the distance between the regions of two water patches.
+ * @param a The first patch.
+ * @param b The second patch.
+ * @return The Manhattan distance in regions.
+ */
+static FORCEINLINE int GetWaterRegionDistance(const WaterRegionPatchDesc &a, const WaterRegionPatchDesc &b)
+{
+	return Delta(a.x, b.x) + Delta(a.y, b.y);
+}
+
+/** Patch in the open list of the high level search. */
+struct WaterRegionSearchNode {
+	int cost;                   ///< Cost from the start of the search.
+	int estimate;               ///< Estimated cost of the path via this patch.
+	uint order;                 ///< Order of insertion, to break ties the same way on every machine.
+	WaterRegionPatchDesc patch; ///< The patch.
+
+	/** The priority queue pops its largest element, so the best node has to be the largest. */
+	FORCEINLINE bool operator <(const WaterRegionSearchNode &other) const
+	{
+		if (this->estimate != other.estimate) return this->estimate > other.estimate;
+		return this->order > other.order;
+	}
+};
+
+/**
+ * Find a path between two water patches. Each step to a neighbouring patch
+ * costs the distance between their regions, so the search favours paths
+ * that cross few regions.
+ * @param from Patch to start at.
+ * @param to Patch to go to.
+ * @param path When a path is found, it is stored here; starting at \a from and ending at \a to.
+ * @return Whether there is a path, whether there is none, or whether the search gave up.
+ */
+WaterRegionPathResult FindWaterRegionPath(const WaterRegionPatchDesc &from, const WaterRegionPatchDesc &to, WaterRegionPatchList &path)
+{
+	assert(from.label != INVALID_WATER_REGION_PATCH && to.label != INVALID_WATER_REGION_PATCH);
+	path.Clear();
+
+	std::priority_queue<WaterRegionSearchNode> open;
+	std::map<WaterRegionPatchDesc, int> costs;
+	std::map<WaterRegionPatchDesc, WaterRegionPatchDesc> parents;
+	uint order = 0;
+	uint expanded = 0;
+
+	WaterRegionSearchNode start = {0, GetWaterRegionDistance(from, to), order++, from};
+	open.push(start);
+	costs[from] = 0;
+
+	WaterRegionPatchList neighbours;
+	while (!open.empty()) {
+		WaterRegionSearchNode node = open.top();
+		open.pop();
+		/* A cheaper way to this patch has been found after this node was added. */
+		if (node.cost > costs[node.patch]) continue;
+
+		if (node.patch == to) {
+			for (WaterRegionPatchDesc patch = to; patch != from; patch = parents[patch]) {
+				*path.Append() = patch;
+			}
+			*path.Append() = from;
+			for (uint i = 0; i < path.Length() / 2; i++) Swap(path[i], path[path.Length() - 1 - i]);
+			return WRPR_FOUND;
+		}
+
+		if (++expanded > MAX_WATER_REGION_SEARCH_NODES) return WRPR_TOO_COMPLEX;
+
+		neighbours.Clear();
+		GetWaterRegionPatchNeighbours(node.patch, neighbours);
+		for (const WaterRegionPatchDesc *neighbour = neighbours.Begin(); neighbour != neighbours.End(); neighbour++) {
+			int cost = node.cost + max(1, GetWaterRegionDistance(node.patch, *neighbour));
+			std::map<WaterRegionPatchDesc, int>::iterator it = costs.find(*neighbour);
+			if (it != costs.end() && it->second <= cost) continue;
+
+			costs[*neighbour] = cost;
+			parents[*neighbour] = node.patch;
+			WaterRegionSearchNode next = {cost, cost + GetWaterRegionDistance(*neighbour, to), order++, *neighbour};
+			open.push(next);
+		}
+	}
+
+	return WRPR_NOT_FOUND;
+}
+
+/**
+ * Mark the water region of a tile as outdated, because ships may
+ * now be able to sail on the tile differently.
+ * @param tile The changed tile.
+ */
+void InvalidateWaterRegion(TileIndex tile)
+{
+	if (_water_regions == NULL || tile >= MapSize()) return;
+	_water_regions[GetWaterRegionIndex(tile)].initialized = false;
+}
+
+/** Throw away all water regions and prepare them for the current map size. */
+void InitializeWaterRegions()
+{
+	free(_water_regions);
+	_water_regions_x = MapSizeX() / WATER_REGION_EDGE_LENGTH;
+	_water_regions = CallocT<WaterRegion>(_water_regions_x * (MapSizeY() / WATER_REGION_EDGE_LENGTH));
+}
@@ -0,0 +1,65 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Dividing the water into regions and patches for high level ship pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+#include "../core/smallvec_type.hpp"
+
+/** Length of the edges of the square water regions, in tiles. */
+static const uint WATER_REGION_EDGE_LENGTH = 16;
+/** Number of tiles in a water region. */
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH;
+
+/** Number of a connected water patch within a water region. */
+typedef byte WaterRegionPatchLabel;
+/** Label of tiles ships cannot sail on. */
+static const WaterRegionPatchLabel INVALID_WATER_REGION_PATCH = 0;
+
+/**
+ * Description of a water patch: a set of water tiles in a single water
+ * region between which ships can sail without leaving the region.
+ */
+struct WaterRegionPatchDesc {
+	uint x;                      ///< X coordinate of the water region, in regions.
+	uint y;                      ///< Y coordinate of the water region, in regions.
+	WaterRegionPatchLabel label; ///< Label of the patch within the region.
+
+	FORCEINLINE bool operator ==(const WaterRegionPatchDesc &other) const { return this->x == other.x && this->y == other.y && this->label == other.label; }
+	FORCEINLINE bool operator !=(const WaterRegionPatchDesc &other) const { return !(*this == other); }
+	FORCEINLINE bool operator <(const WaterRegionPatchDesc &other) const
+	{
+		if (this->y != other.y) return this->y < other.y;
+		if (this->x != other.x) return this->x < other.x;
+		return this->label < other.label;
+	}
+};
+
+/** List of water patches, e.g. a path between them. */
+typedef SmallVector<WaterRegionPatchDesc, 16> WaterRegionPatchList;
+
+/** Result of searching a path between water patches. */
+enum WaterRegionPathResult {
+	WRPR_FOUND,       ///< There is a path.
+	WRPR_NOT_FOUND,   ///< The patches are not connected at all.
+	WRPR_TOO_COMPLEX, ///< The search gave up before finding out.
+};
+
+WaterRegionPatchDesc GetWaterRegionPatchInfo(TileIndex tile);
+bool IsTileInWaterRegionPatch(TileIndex tile, const WaterRegionPatchDesc &patch);
+void GetWaterRegionPatchNeighbours(const WaterRegionPatchDesc &patch, WaterRegionPatchList &neighbours);
+WaterRegionPathResult FindWaterRegionPath(const WaterRegionPatchDesc &from, const WaterRegionPatchDesc &to, WaterRegionPatchList &path);
+
+void InvalidateWaterRegion(TileIndex tile);
+void InitializeWaterRegions();
+
+#endif /* WATER_REGIONS_H */
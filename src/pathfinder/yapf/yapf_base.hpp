@@ -142,6 +142,7 @@ public:
 				break;
 			}
 
+			_pathfinder_stats.nodes_expanded++;
 			Yapf().PfFollowNode(*n);
 			if (m_max_search_nodes == 0 || m_nodes.ClosedCount() < m_max_search_nodes) {
 				m_nodes.PopOpenNode(n->GetKey());
@@ -233,8 +234,10 @@ public:
 		bool bCached = Yapf().PfNodeCacheFetch(n);
 		if (!bCached) {
 			m_stats_cost_calcs++;
+			_pathfinder_stats.cost_calcs++;
 		} else {
 			m_stats_cache_hits++;
+			_pathfinder_stats.cache_hits++;
 		}
 
 		bool bValid = Yapf().PfCalcCost(n, &tf);
@@ -21,4 +21,10 @@
  */
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track);
 
+/**
+ * Use this function to notify YAPF that the road layout (including road stops and depots) has changed.
+ * @param tile the tile that is changed, or INVALID_TILE if everything may have changed
+ */
+void YapfNotifyRoadLayoutChange(TileIndex tile);
+
 #endif /* YAPF_CACHE_H */
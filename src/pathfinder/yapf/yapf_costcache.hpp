@@ -13,6 +13,104 @@
 #define YAPF_COSTCACHE_HPP
 
 #include "../../date_func.h"
+#include "../../map_func.h"
+#include "../../core/smallvec_type.hpp"
+
+#include <map>
+
+/**
+ * Base class for segment cost cache providers. Contains the global logs
+ *  of track and road layout changes and static notification functions called
+ *  whenever the layout changes. It is implemented as base class because it
+ *  needs to be shared between all rail (and all road) YAPF types (one shared
+ *  log, one notification function).
+ */
+struct CSegmentCostCacheBase
+{
+	/** Number of layout changes that are remembered until all caches have seen them. */
+	static const uint CHANGE_LOG_SIZE = 1024;
+	/** Segments are invalidated per square of (1 << REGION_BITS) tiles. */
+	static const uint REGION_BITS = 3;
+
+	typedef SmallVector<uint, 16> RegionList;
+
+	/** The last layout changes of one transport type. */
+	struct ChangeLog {
+		uint32     counter;                ///< number of changes so far
+		TileIndex  tiles[CHANGE_LOG_SIZE]; ///< the changed tiles, indexed by the change counter
+
+		/**
+		 * Remember a change of the layout.
+		 * @param tile The changed tile, or INVALID_TILE to invalidate all segments.
+		 */
+		FORCEINLINE void Add(TileIndex tile)
+		{
+			tiles[counter % CHANGE_LOG_SIZE] = tile;
+			counter++;
+		}
+	};
+
+	static ChangeLog   s_rail_changes;
+	static ChangeLog   s_road_changes;
+
+	/**
+	 * Remember a change of the track layout so the cached segments passing
+	 *  the tile get invalidated.
+	 * @param tile The changed tile, or INVALID_TILE to invalidate all segments.
+	 * @param track The changed track.
+	 */
+	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
+	{
+		s_rail_changes.Add(tile);
+	}
+
+	/**
+	 * Remember a change of the road layout so the cached segments passing
+	 *  the tile get invalidated.
+	 * @param tile The changed tile, or INVALID_TILE to invalidate all segments.
+	 */
+	static void NotifyRoadLayoutChange(TileIndex tile)
+	{
+		s_road_changes.Add(tile);
+	}
+
+	/**
+	 * Get the region a tile is invalidated with.
+	 * @param tile The tile.
+	 * @return Index of the region.
+	 */
+	static FORCEINLINE uint GetRegion(TileIndex tile)
+	{
+		return ((TileY(tile) >> REGION_BITS) << (MapLogX() - REGION_BITS)) | (TileX(tile) >> REGION_BITS);
+	}
+
+	/**
+	 * Add the region of a tile to a list of regions a segment depends on.
+	 * @param regions The list of regions.
+	 * @param tile The tile; ignored when it is not on the map.
+	 */
+	static FORCEINLINE void AddRegion(RegionList &regions, TileIndex tile)
+	{
+		if (tile < MapSize()) regions.Include(GetRegion(tile));
+	}
+
+	/**
+	 * Add the tiles a track follower went over to the regions a segment depends on.
+	 * @param regions The list of regions.
+	 * @param tf The track follower; its new tile and the tiles it skipped are added.
+	 */
+	template <class Tfollower>
+	static FORCEINLINE void AddFollowedTiles(RegionList &regions, const Tfollower &tf)
+	{
+		if (tf.m_new_tile == INVALID_TILE) return;
+		AddRegion(regions, tf.m_new_tile);
+		TileIndexDiff diff = TileOffsByDiagDir(tf.m_exitdir);
+		for (int i = 1; i <= tf.m_tiles_skipped; i++) {
+			AddRegion(regions, tf.m_new_tile - diff * i);
+		}
+	}
+};
+
 
 /**
  * CYapfSegmentCostCacheNoneT - the formal only yapf cost cache provider that implements
@@ -89,23 +187,13 @@ public:
 	FORCEINLINE void PfNodeCacheFlush(Node& n)
 	{
 	}
-};
-
 
-/**
- * Base class for segment cost cache providers. Contains global counter
- *  of track layout changes and static notification function called whenever
- *  the track layout changes. It is implemented as base class because it needs
- *  to be shared between all rail YAPF types (one shared counter, one notification
- *  function.
- */
-struct CSegmentCostCacheBase
-{
-	static int   s_rail_change_counter;
-
-	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
+	/**
+	 * Called by YAPF after calculating the cost of a segment with the regions
+	 *  of all tiles the cost depends on. Local data are never invalidated.
+	 */
+	FORCEINLINE void PfNodeCacheRegister(Node& n, const CSegmentCostCacheBase::RegionList& regions)
 	{
-		s_rail_change_counter++;
 	}
 };
 
@@ -130,20 +218,93 @@ struct CSegmentCostCacheT
 	typedef SmallArray<Tsegment> Heap;
 	typedef typename Tsegment::Key Key;    ///< key to hash table
 
+	typedef std::multimap<uint, Tsegment *> RegionIndex;
+
 	HashTable    m_map;
 	Heap         m_heap;
+	RegionIndex  m_regions;          ///< segments by the regions they depend on
+	uint32       m_change_counter;   ///< value of the change log counter when the changes were last processed
+	uint         m_num_evicted;      ///< number of segments in m_heap that are no longer in m_map
+
+	int          m_stats_lookups;    ///< stats - how many segments were looked up
+	int          m_stats_hits;       ///< stats - how many lookups found a cached segment
+	int          m_stats_evictions;  ///< stats - how many segments were invalidated by a track layout change
+	int          m_stats_flushes;    ///< stats - how many times the whole cache was flushed
 
-	FORCEINLINE CSegmentCostCacheT() {}
+	FORCEINLINE CSegmentCostCacheT() : m_change_counter(0), m_num_evicted(0)
+	{
+		ResetStats();
+	}
 
 	/** flush (clear) the cache */
 	FORCEINLINE void Flush()
 	{
+		if (m_heap.Length() != 0) m_stats_flushes++;
 		m_map.Clear();
 		m_heap.Clear();
+		m_regions.clear();
+		m_num_evicted = 0;
+	}
+
+	/** reset the statistics */
+	FORCEINLINE void ResetStats()
+	{
+		m_stats_lookups = 0;
+		m_stats_hits = 0;
+		m_stats_evictions = 0;
+		m_stats_flushes = 0;
+	}
+
+	/**
+	 * Invalidate all segments depending on a region.
+	 * @param region The region.
+	 */
+	void EvictRegion(uint region)
+	{
+		std::pair<typename RegionIndex::iterator, typename RegionIndex::iterator> range = m_regions.equal_range(region);
+		for (typename RegionIndex::iterator it = range.first; it != range.second; ++it) {
+			Tsegment *item = it->second;
+			/* The segment may have been evicted by another region already. */
+			if (m_map.Find(item->GetKey()) != item) continue;
+			m_map.Pop(*item);
+			m_num_evicted++;
+			m_stats_evictions++;
+		}
+		m_regions.erase(range.first, range.second);
+	}
+
+	/**
+	 * Invalidate the segments affected by the layout changes since the last call.
+	 *  Tsegment::GetChangeLog() tells which layout changes affect the segments.
+	 */
+	void ProcessLayoutChanges()
+	{
+		const ChangeLog &log = Tsegment::GetChangeLog();
+		uint32 changes = log.counter - m_change_counter;
+		if (changes == 0) return;
+
+		if (changes > CHANGE_LOG_SIZE) {
+			/* We missed some changes. */
+			Flush();
+		} else {
+			for (uint32 i = m_change_counter; i != log.counter; i++) {
+				TileIndex tile = log.tiles[i % CHANGE_LOG_SIZE];
+				if (tile == INVALID_TILE) {
+					Flush();
+					break;
+				}
+				EvictRegion(GetRegion(tile));
+			}
+		}
+		m_change_counter = log.counter;
+
+		/* Evicted segments still take their space in the heap; start over once they fill most of it. */
+		if (m_num_evicted >= 1024 && m_num_evicted * 2 > m_heap.Length()) Flush();
 	}
 
 	FORCEINLINE Tsegment& Get(Key& key, bool *found)
 	{
+		m_stats_lookups++;
 		Tsegment *item = m_map.Find(key);
 		if (item == NULL) {
 			*found = false;
@@ -151,9 +312,22 @@ struct CSegmentCostCacheT
 			m_map.Push(*item);
 		} else {
 			*found = true;
+			m_stats_hits++;
 		}
 		return *item;
 	}
+
+	/**
+	 * Remember the regions a newly calculated segment depends on.
+	 * @param item The segment.
+	 * @param regions The regions of all tiles the segment cost was calculated from.
+	 */
+	FORCEINLINE void Register(Tsegment& item, const RegionList& regions)
+	{
+		for (const uint *region = regions.Begin(); region != regions.End(); region++) {
+			m_regions.insert(std::make_pair(*region, &item));
+		}
+	}
 };
 
 /**
@@ -187,7 +361,6 @@ protected:
 
 	FORCEINLINE static Cache& stGetGlobalCache()
 	{
-		static int last_rail_change_counter = 0;
 		static Date last_date = 0;
 		static Cache C;
 
@@ -195,14 +368,15 @@ protected:
 		if (last_date != _date) {
 			last_date = _date;
 			DEBUG(yapf, 2, "Pf time today: %5d ms", _total_pf_time_us / 1000);
+			DEBUG(yapf, 2, "Segment cache: %d segments - hit rate %4.1f%% of %d lookups - %d evicted - %d flushes",
+					C.m_map.Count(), C.m_stats_lookups == 0 ? 0.0f : (float)C.m_stats_hits / (float)C.m_stats_lookups * 100.0f,
+					C.m_stats_lookups, C.m_stats_evictions, C.m_stats_flushes);
 			_total_pf_time_us = 0;
+			C.ResetStats();
 		}
 
-		/* delete the cache sometimes... */
-		if (last_rail_change_counter != Cache::s_rail_change_counter) {
-			last_rail_change_counter = Cache::s_rail_change_counter;
-			C.Flush();
-		}
+		/* invalidate the segments the layout changes affected */
+		C.ProcessLayoutChanges();
 		return C;
 	}
 
@@ -230,6 +404,17 @@ public:
 	FORCEINLINE void PfNodeCacheFlush(Node& n)
 	{
 	}
+
+	/**
+	 * Called by YAPF after calculating the cost of a segment with the regions
+	 *  of all tiles the cost depends on, so the segment gets invalidated when
+	 *  the track layout in one of them changes.
+	 */
+	FORCEINLINE void PfNodeCacheRegister(Node& n, const CSegmentCostCacheBase::RegionList& regions)
+	{
+		if (!Yapf().CanUseGlobalCache(n)) return;
+		m_global_cache.Register(*n.m_segment, regions);
+	}
 };
 
 #endif /* YAPF_COSTCACHE_HPP */
@@ -340,6 +340,10 @@ public:
 
 		TrackFollower tf_local(v, Yapf().GetCompatibleRailTypes(), &Yapf().m_perf_ts_cost);
 
+		/* Regions of the tiles the segment cost depends on; a track layout change in them invalidates the segment. */
+		CSegmentCostCacheBase::RegionList regions;
+		if (!is_cached_segment) CSegmentCostCacheBase::AddFollowedTiles(regions, *tf);
+
 		if (!has_parent) {
 			/* We will jump to the middle of the cost calculator assuming that segment cache is not used. */
 			assert(!is_cached_segment);
@@ -489,7 +493,10 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 			tf = &tf_local;
 			tf_local.Init(v, Yapf().GetCompatibleRailTypes(), &Yapf().m_perf_ts_cost);
 
-			if (!tf_local.Follow(cur.tile, cur.td)) {
+			bool followed = tf_local.Follow(cur.tile, cur.td);
+			/* Even when we can't follow, whether we can depends on the next tile. */
+			CSegmentCostCacheBase::AddFollowedTiles(regions, tf_local);
+			if (!followed) {
 				assert(tf_local.m_err != TrackFollower::EC_NONE);
 				/* Can't move to the next tile (EOL?). */
 				if (tf_local.m_err == TrackFollower::EC_RAIL_TYPE) {
@@ -574,6 +581,8 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 			segment.m_end_segment_reason = end_segment_reason & ESRB_CACHED_MASK;
 			/* Save end of segment back to the node. */
 			n.SetLastTileTrackdir(cur.tile, cur.td);
+			/* Tell the cache which track layout changes invalidate the segment. */
+			Yapf().PfNodeCacheRegister(n, regions);
 		}
 
 		/* Do we have an excuse why not to continue pathfinding in this direction? */
@@ -175,6 +175,12 @@ struct CYapfRailSegment
 		m_hash_next = next;
 	}
 
+	/** The layout changes that invalidate rail segments. */
+	static FORCEINLINE const CSegmentCostCacheBase::ChangeLog& GetChangeLog()
+	{
+		return CSegmentCostCacheBase::s_rail_changes;
+	}
+
 	void Dump(DumpTarget &dmp) const
 	{
 		dmp.WriteStructT("m_key", &m_key);
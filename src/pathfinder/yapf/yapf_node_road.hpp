@@ -12,19 +12,127 @@
 #ifndef YAPF_NODE_ROAD_HPP
 #define YAPF_NODE_ROAD_HPP
 
+/** key for cached segment cost for road YAPF */
+struct CYapfRoadSegmentKey
+{
+	uint32    m_value;
+
+	FORCEINLINE CYapfRoadSegmentKey(const CYapfRoadSegmentKey& src) : m_value(src.m_value) {}
+
+	/**
+	 * Create the key of the segment starting at a node.
+	 * @param node_key The key of the node.
+	 * @param roadtypes The road types the vehicle can drive on; they decide which road bits can be followed.
+	 */
+	FORCEINLINE CYapfRoadSegmentKey(const CYapfNodeKeyExitDir& node_key, RoadTypes roadtypes = ROADTYPES_NONE)
+	{
+		m_value = (((int)node_key.m_tile) << 6) | (roadtypes << 4) | node_key.m_td;
+	}
+
+	FORCEINLINE int32 CalcHash() const
+	{
+		return m_value;
+	}
+
+	FORCEINLINE TileIndex GetTile() const
+	{
+		return (TileIndex)(m_value >> 6);
+	}
+
+	FORCEINLINE RoadTypes GetRoadTypes() const
+	{
+		return (RoadTypes)GB(m_value, 4, 2);
+	}
+
+	FORCEINLINE Trackdir GetTrackdir() const
+	{
+		return (Trackdir)(m_value & 0x0F);
+	}
+
+	FORCEINLINE bool operator == (const CYapfRoadSegmentKey& other) const
+	{
+		return m_value == other.m_value;
+	}
+
+	void Dump(DumpTarget &dmp) const
+	{
+		dmp.WriteTile("tile", GetTile());
+		dmp.WriteLine("roadtypes = %d", GetRoadTypes());
+		dmp.WriteEnumT("td", GetTrackdir());
+	}
+};
+
+/** cached segment cost for road YAPF */
+struct CYapfRoadSegment
+{
+	typedef CYapfRoadSegmentKey Key;
+
+	CYapfRoadSegmentKey    m_key;
+	TileIndex              m_last_tile;
+	Trackdir               m_last_td;
+	int                    m_cost;          ///< cost of the segment without the penalties that depend on the vehicle or on occupied road stops
+	bool                   m_speed_limited; ///< the segment passes a speed limit, so its cost depends on the vehicle and can't be reused
+	bool                   m_infinite_loop; ///< the segment loops back to its start without a junction
+	CYapfRoadSegment      *m_hash_next;
+
+	FORCEINLINE CYapfRoadSegment(const CYapfRoadSegmentKey& key)
+		: m_key(key)
+		, m_last_tile(INVALID_TILE)
+		, m_last_td(INVALID_TRACKDIR)
+		, m_cost(-1)
+		, m_speed_limited(false)
+		, m_infinite_loop(false)
+		, m_hash_next(NULL)
+	{}
+
+	FORCEINLINE const Key& GetKey() const
+	{
+		return m_key;
+	}
+
+	FORCEINLINE CYapfRoadSegment *GetHashNext()
+	{
+		return m_hash_next;
+	}
+
+	FORCEINLINE void SetHashNext(CYapfRoadSegment *next)
+	{
+		m_hash_next = next;
+	}
+
+	/** The layout changes that invalidate road segments. */
+	static FORCEINLINE const CSegmentCostCacheBase::ChangeLog& GetChangeLog()
+	{
+		return CSegmentCostCacheBase::s_road_changes;
+	}
+
+	void Dump(DumpTarget &dmp) const
+	{
+		dmp.WriteStructT("m_key", &m_key);
+		dmp.WriteTile("m_last_tile", m_last_tile);
+		dmp.WriteEnumT("m_last_td", m_last_td);
+		dmp.WriteLine("m_cost = %d", m_cost);
+		dmp.WriteLine("m_speed_limited = %d", m_speed_limited);
+		dmp.WriteLine("m_infinite_loop = %d", m_infinite_loop);
+	}
+};
+
 /** Yapf Node for road YAPF */
 template <class Tkey_>
 struct CYapfRoadNodeT
 	: CYapfNodeT<Tkey_, CYapfRoadNodeT<Tkey_> >
 {
 	typedef CYapfNodeT<Tkey_, CYapfRoadNodeT<Tkey_> > base;
+	typedef CYapfRoadSegment CachedData;
 
-	TileIndex       m_segment_last_tile;
-	Trackdir        m_segment_last_td;
+	CYapfRoadSegment *m_segment;
+	TileIndex         m_segment_last_tile;
+	Trackdir          m_segment_last_td;
 
 	void Set(CYapfRoadNodeT *parent, TileIndex tile, Trackdir td, bool is_choice)
 	{
 		base::Set(parent, tile, td, is_choice);
+		m_segment = NULL;
 		m_segment_last_tile = tile;
 		m_segment_last_td = td;
 	}
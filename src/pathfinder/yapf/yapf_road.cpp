@@ -11,7 +11,10 @@
 
 #include "../../stdafx.h"
 #include "yapf.hpp"
+#include "yapf_cache.h"
 #include "yapf_node_road.hpp"
+#include "../network_components.h"
+#include "../pf_query_log.h"
 #include "../../roadstop_base.h"
 
 
@@ -23,6 +26,7 @@ public:
 	typedef typename Types::TrackFollower TrackFollower; ///< track follower helper
 	typedef typename Types::NodeList::Titem Node; ///< this will be our node type
 	typedef typename Node::Key Key;    ///< key to hash tables
+	typedef typename Node::CachedData CachedData;
 
 protected:
 	/** to access inherited path finder */
@@ -65,24 +69,11 @@ protected:
 					}
 					break;
 
-				case MP_STATION: {
-					const RoadStop *rs = RoadStop::GetByTile(tile, GetRoadStopType(tile));
-					if (IsDriveThroughStopTile(tile)) {
-						/* Increase the cost for drive-through road stops */
-						cost += Yapf().PfGetSettings().road_stop_penalty;
-						DiagDirection dir = TrackdirToExitdir(trackdir);
-						if (!RoadStop::IsDriveThroughRoadStopContinuation(tile, tile - TileOffsByDiagDir(dir))) {
-							/* When we're the first road stop in a 'queue' of them we increase
-							 * cost based on the fill percentage of the whole queue. */
-							const RoadStop::Entry *entry = rs->GetEntry(dir);
-							cost += entry->GetOccupied() * Yapf().PfGetSettings().road_stop_occupied_penalty / entry->GetLength();
-						}
-					} else {
-						/* Increase cost for filled road stops */
-						cost += Yapf().PfGetSettings().road_stop_bay_occupied_penalty * (!rs->IsFreeBay(0) + !rs->IsFreeBay(1)) / 2;
-					}
+				case MP_STATION:
+					/* Increase the cost for drive-through road stops */
+					if (IsDriveThroughStopTile(tile)) cost += Yapf().PfGetSettings().road_stop_penalty;
+					/* How full the road stop is gets added by OccupiedStopCost(). */
 					break;
-				}
 
 				default:
 					break;
@@ -94,6 +85,30 @@ protected:
 		return cost;
 	}
 
+	/**
+	 * Return the penalty for a filled road stop. It changes all the time, so it
+	 *  is not part of the (cached) segment cost. Segments end at road stops, so
+	 *  only the last tile of a segment can be a road stop.
+	 */
+	FORCEINLINE int OccupiedStopCost(TileIndex tile, Trackdir trackdir)
+	{
+		if (!IsDiagonalTrackdir(trackdir) || !IsTileType(tile, MP_STATION)) return 0;
+
+		const RoadStop *rs = RoadStop::GetByTile(tile, GetRoadStopType(tile));
+		if (IsDriveThroughStopTile(tile)) {
+			DiagDirection dir = TrackdirToExitdir(trackdir);
+			if (!RoadStop::IsDriveThroughRoadStopContinuation(tile, tile - TileOffsByDiagDir(dir))) {
+				/* When we're the first road stop in a 'queue' of them we increase
+				 * cost based on the fill percentage of the whole queue. */
+				const RoadStop::Entry *entry = rs->GetEntry(dir);
+				return entry->GetOccupied() * Yapf().PfGetSettings().road_stop_occupied_penalty / entry->GetLength();
+			}
+			return 0;
+		}
+		/* Increase cost for filled road stops */
+		return Yapf().PfGetSettings().road_stop_bay_occupied_penalty * (!rs->IsFreeBay(0) + !rs->IsFreeBay(1)) / 2;
+	}
+
 public:
 	/**
 	 * Called by YAPF to calculate the cost from the origin to the given node.
@@ -102,66 +117,117 @@ public:
 	 */
 	FORCEINLINE bool PfCalcCost(Node& n, const TrackFollower *tf)
 	{
-		int segment_cost = 0;
-		uint tiles = 0;
-		/* start at n.m_key.m_tile / n.m_key.m_td and walk to the end of segment */
-		TileIndex tile = n.m_key.m_tile;
-		Trackdir trackdir = n.m_key.m_td;
-		while (true) {
-			/* base tile cost depending on distance between edges */
-			segment_cost += Yapf().OneTileCost(tile, trackdir);
-
-			const RoadVehicle *v = Yapf().GetVehicle();
-			/* we have reached the vehicle's destination - segment should end here to avoid target skipping */
-			if (Yapf().PfDetectDestinationTile(tile, trackdir)) break;
-
-			/* stop if we have just entered the depot */
-			if (IsRoadDepotTile(tile) && trackdir == DiagDirToDiagTrackdir(ReverseDiagDir(GetRoadDepotDirection(tile)))) {
-				/* next time we will reverse and leave the depot */
-				break;
-			}
-
-			/* if there are no reachable trackdirs on new tile, we have end of road */
-			TrackFollower F(Yapf().GetVehicle());
-			if (!F.Follow(tile, trackdir)) break;
-
-			/* if there are more trackdirs available & reachable, we are at the end of segment */
-			if (KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE) break;
-
-			Trackdir new_td = (Trackdir)FindFirstBit2x64(F.m_new_td_bits);
-
-			/* stop if RV is on simple loop with no junctions */
-			if (F.m_new_tile == n.m_key.m_tile && new_td == n.m_key.m_td) return false;
-
-			/* if we skipped some tunnel tiles, add their cost */
-			segment_cost += F.m_tiles_skipped * YAPF_TILE_LENGTH;
-			tiles += F.m_tiles_skipped + 1;
-
-			/* add hilly terrain penalty */
-			segment_cost += Yapf().SlopeCost(tile, F.m_new_tile, trackdir);
+		const RoadVehicle *v = Yapf().GetVehicle();
+		CachedData &segment = *n.m_segment;
+
+		/* The speed limit penalties depend on the vehicle, so segments with
+		 * speed limits are walked every time. */
+		bool is_cached_segment = (segment.m_cost >= 0 && !segment.m_speed_limited);
+		int speed_cost = 0;
+
+		if (!is_cached_segment) {
+			int segment_cost = 0;
+			uint tiles = 0;
+			bool speed_limited = false;
+			/* regions of the tiles the segment depends on; a road layout change in them invalidates the segment */
+			CSegmentCostCacheBase::RegionList regions;
+			/* start at n.m_key.m_tile / n.m_key.m_td and walk to the end of segment */
+			TileIndex tile = n.m_key.m_tile;
+			Trackdir trackdir = n.m_key.m_td;
+			CSegmentCostCacheBase::AddRegion(regions, tile);
+			while (true) {
+				/* base tile cost depending on distance between edges */
+				segment_cost += Yapf().OneTileCost(tile, trackdir);
+
+				/* we have reached the vehicle's destination - segment should end here to avoid target skipping */
+				if (Yapf().PfDetectDestinationTile(tile, trackdir)) break;
+
+				/* road stops are possible destinations, so segments end at them like at the destination */
+				if (IsTileType(tile, MP_STATION)) break;
+
+				/* Depots are possible destinations as well, so segments end on them
+				 * in both directions. Otherwise a segment leaving a depot would be
+				 * cut short by depot searches only, and the cached segment would
+				 * depend on the search that walked it first. */
+				if (IsRoadDepotTile(tile)) break;
+
+				/* if there are no reachable trackdirs on new tile, we have end of road */
+				TrackFollower F(v);
+				bool followed = F.Follow(tile, trackdir);
+				/* even if we can't enter it, the next tile decides where the segment ends */
+				CSegmentCostCacheBase::AddFollowedTiles(regions, F);
+				if (!followed) break;
+
+				/* if there are more trackdirs available & reachable, we are at the end of segment */
+				if (KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE) break;
+
+				/* depots are possible destinations too; they start a new segment so it does not depend on the depot owner */
+				if (IsRoadDepotTile(F.m_new_tile)) break;
+
+				Trackdir new_td = (Trackdir)FindFirstBit2x64(F.m_new_td_bits);
+
+				/* stop if RV is on simple loop with no junctions */
+				if (F.m_new_tile == n.m_key.m_tile && new_td == n.m_key.m_td) {
+					segment.m_infinite_loop = true;
+					break;
+				}
 
-			/* add min/max speed penalties */
-			int min_speed = 0;
-			int max_veh_speed = v->GetDisplayMaxSpeed();
-			int max_speed = F.GetSpeedLimit(&min_speed);
-			if (max_speed < max_veh_speed) segment_cost += 1 * (max_veh_speed - max_speed);
-			if (min_speed > max_veh_speed) segment_cost += 10 * (min_speed - max_veh_speed);
+				/* if we skipped some tunnel tiles, add their cost */
+				segment_cost += F.m_tiles_skipped * YAPF_TILE_LENGTH;
+				tiles += F.m_tiles_skipped + 1;
+
+				/* add hilly terrain penalty */
+				segment_cost += Yapf().SlopeCost(tile, F.m_new_tile, trackdir);
+
+				/* add min/max speed penalties */
+				int min_speed = 0;
+				int max_veh_speed = v->GetDisplayMaxSpeed();
+				int max_speed = F.GetSpeedLimit(&min_speed);
+				if (max_speed != INT_MAX || min_speed != 0) speed_limited = true;
+				if (max_speed < max_veh_speed) speed_cost += 1 * (max_veh_speed - max_speed);
+				if (min_speed > max_veh_speed) speed_cost += 10 * (min_speed - max_veh_speed);
+
+				/* move to the next tile */
+				tile = F.m_new_tile;
+				trackdir = new_td;
+				if (tiles > MAX_MAP_SIZE) break;
+			}
 
-			/* move to the next tile */
-			tile = F.m_new_tile;
-			trackdir = new_td;
-			if (tiles > MAX_MAP_SIZE) break;
+			/* write back the segment information so it can be reused the next time */
+			bool is_new_segment = (segment.m_cost < 0);
+			segment.m_cost = segment_cost;
+			segment.m_speed_limited = speed_limited;
+			segment.m_last_tile = tile;
+			segment.m_last_td = trackdir;
+			if (is_new_segment) Yapf().PfNodeCacheRegister(n, regions);
 		}
 
+		if (segment.m_infinite_loop) return false;
+
 		/* save end of segment back to the node */
-		n.m_segment_last_tile = tile;
-		n.m_segment_last_td = trackdir;
+		n.m_segment_last_tile = segment.m_last_tile;
+		n.m_segment_last_td = segment.m_last_td;
 
 		/* save also tile cost */
 		int parent_cost = (n.m_parent != NULL) ? n.m_parent->m_cost : 0;
-		n.m_cost = parent_cost + segment_cost;
+		n.m_cost = parent_cost + segment.m_cost + speed_cost + Yapf().OccupiedStopCost(segment.m_last_tile, segment.m_last_td);
 		return true;
 	}
+
+	/**
+	 * Segments can be shared between searches only if the destination check
+	 *  while walking a segment can't end it, i.e. when segments always end at
+	 *  all possible destinations anyway.
+	 */
+	FORCEINLINE bool CanUseGlobalCache(Node& n)
+	{
+		return Yapf().CanCacheSegments();
+	}
+
+	FORCEINLINE void ConnectNodeToCachedData(Node& n, CachedData& ci)
+	{
+		n.m_segment = &ci;
+	}
 };
 
 
@@ -192,6 +258,12 @@ public:
 		return IsRoadDepotTile(tile);
 	}
 
+	/** Depots always start and end a segment, so segments can be shared between searches. */
+	FORCEINLINE bool CanCacheSegments() const
+	{
+		return true;
+	}
+
 	/**
 	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
 	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
@@ -262,6 +334,15 @@ public:
 		return tile == m_destTile && ((m_destTrackdirs & TrackdirToTrackdirBits(trackdir)) != TRACKDIR_BIT_NONE);
 	}
 
+	/**
+	 * Road stops always end a segment, so segments can be shared between
+	 *  searches for stations. Other destinations can end a segment anywhere.
+	 */
+	FORCEINLINE bool CanCacheSegments() const
+	{
+		return m_dest_station != INVALID_STATION;
+	}
+
 	/**
 	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
 	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
@@ -454,6 +535,48 @@ public:
 	}
 };
 
+/**
+ * CYapfSegmentCostCacheRoadT - the global segment cost cache provider for road
+ *  vehicles. Which road bits can be followed depends on the road types of the
+ *  vehicle, so they are part of the cache key.
+ */
+template <class Types>
+class CYapfSegmentCostCacheRoadT
+	: public CYapfSegmentCostCacheGlobalT<Types>
+{
+public:
+	typedef CYapfSegmentCostCacheGlobalT<Types> Tglobal;
+	typedef typename Tglobal::Tlocal Tlocal;
+	typedef typename Types::Tpf Tpf;              ///< the pathfinder class (derived from THIS class)
+	typedef typename Types::NodeList::Titem Node; ///< this will be our node type
+	typedef typename Node::CachedData CachedData;
+	typedef typename CachedData::Key CacheKey;
+
+protected:
+	/** to access inherited path finder */
+	FORCEINLINE Tpf& Yapf()
+	{
+		return *static_cast<Tpf*>(this);
+	}
+
+public:
+	/**
+	 * Called by YAPF to attach cached or local segment cost data to the given node.
+	 *  @return true if globally cached data were used or false if local data was used
+	 */
+	FORCEINLINE bool PfNodeCacheFetch(Node& n)
+	{
+		if (!Yapf().CanUseGlobalCache(n)) {
+			return Tlocal::PfNodeCacheFetch(n);
+		}
+		CacheKey key(n.GetKey(), Yapf().GetVehicle()->compatible_roadtypes);
+		bool found;
+		CachedData& item = this->m_global_cache.Get(key, &found);
+		Yapf().ConnectNodeToCachedData(n, item);
+		return found;
+	}
+};
+
 template <class Tpf_, class Tnode_list, template <class Types> class Tdestination>
 struct CYapfRoad_TypesT
 {
@@ -467,7 +590,7 @@ struct CYapfRoad_TypesT
 	typedef CYapfFollowRoadT<Types>           PfFollow;
 	typedef CYapfOriginTileT<Types>           PfOrigin;
 	typedef Tdestination<Types>               PfDestination;
-	typedef CYapfSegmentCostCacheNoneT<Types> PfCache;
+	typedef CYapfSegmentCostCacheRoadT<Types> PfCache;
 	typedef CYapfCostRoadT<Types>             PfCost;
 };
 
@@ -515,3 +638,15 @@ FindDepotData YapfRoadVehicleFindNearestDepot(const RoadVehicle *v, int max_dist
 	fdd.best_length = ret ? max_distance / 2 : UINT_MAX; // some fake distance or NOT_FOUND
 	return fdd;
 }
+
+/** if any road changes, it is logged here - that will invalidate the affected segments in the segment cost cache */
+CSegmentCostCacheBase::ChangeLog CSegmentCostCacheBase::s_road_changes;
+
+void YapfNotifyRoadLayoutChange(TileIndex tile)
+{
+	CSegmentCostCacheBase::NotifyRoadLayoutChange(tile);
+	if (tile != INVALID_TILE) {
+		NotifyNetworkComponentChange(tile, TRANSPORT_ROAD);
+		_pathfinder_map_revision++;
+	}
+}
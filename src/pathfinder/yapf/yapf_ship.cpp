@@ -11,9 +11,14 @@
 
 #include "../../stdafx.h"
 #include "../../ship.h"
+#include "../../core/random_func.hpp"
+#include "../water_regions.h"
 
 #include "yapf.hpp"
 
+/** Number of water regions beyond the current one a single detailed search plans the route through. */
+static const uint YAPF_SHIP_REGION_LOOKAHEAD = 8;
+
 /** Node Follower module of YAPF for ships */
 template <class Types>
 class CYapfFollowShipT
@@ -25,6 +30,9 @@ public:
 	typedef typename Node::Key Key;                      ///< key to hash tables
 
 protected:
+	const WaterRegionPatchDesc *m_corridor_begin; ///< first water patch the search may use, or NULL if it may use all water
+	const WaterRegionPatchDesc *m_corridor_end;   ///< end of the water patches the search may use
+
 	/** to access inherited path finder */
 	FORCEINLINE Tpf& Yapf()
 	{
@@ -32,6 +40,30 @@ protected:
 	}
 
 public:
+	CYapfFollowShipT() : m_corridor_begin(NULL), m_corridor_end(NULL) {}
+
+	/**
+	 * Restrict the search to some water patches.
+	 * @param begin First patch the search may use.
+	 * @param end End of the patches the search may use.
+	 */
+	FORCEINLINE void SetCorridor(const WaterRegionPatchDesc *begin, const WaterRegionPatchDesc *end)
+	{
+		m_corridor_begin = begin;
+		m_corridor_end = end;
+	}
+
+	/** Check whether the search may use the given tile. */
+	inline bool IsInCorridor(TileIndex tile) const
+	{
+		if (m_corridor_begin == NULL) return true;
+		WaterRegionPatchDesc patch = GetWaterRegionPatchInfo(tile);
+		for (const WaterRegionPatchDesc *it = m_corridor_begin; it != m_corridor_end; it++) {
+			if (*it == patch) return true;
+		}
+		return false;
+	}
+
 	/**
 	 * Called by YAPF to move from the given node to the next tile. For each
 	 *  reachable trackdir on the new tile creates new node, initializes it
@@ -40,7 +72,7 @@ public:
 	inline void PfFollowNode(Node& old_node)
 	{
 		TrackFollower F(Yapf().GetVehicle());
-		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td)) {
+		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td) && IsInCorridor(F.m_new_tile)) {
 			Yapf().AddMultipleNodes(&old_node, F);
 		}
 	}
@@ -69,6 +101,56 @@ public:
 
 		/* convert origin trackdir to TrackdirBits */
 		TrackdirBits trackdirs = TrackdirToTrackdirBits(trackdir);
+
+		/* First plan the route over the water regions. That only looks at the
+		 * regions along the way, so crossing an open sea costs about as much
+		 * as sailing along a canal. The ship enters the next tile in any
+		 * case, so the route starts there. */
+		WaterRegionPatchDesc src_patch = GetWaterRegionPatchInfo(tile);
+		WaterRegionPatchDesc dest_patch = GetWaterRegionPatchInfo(v->dest_tile);
+		if (src_patch.label != INVALID_WATER_REGION_PATCH && dest_patch.label != INVALID_WATER_REGION_PATCH) {
+			WaterRegionPatchList high_level_path;
+			switch (FindWaterRegionPath(src_patch, dest_patch, high_level_path)) {
+				case WRPR_NOT_FOUND: {
+					/* The destination cannot be reached at all, so don't search the whole sea for it. */
+					path_found = false;
+					TrackdirBits next_trackdirs = TrackBitsToTrackdirBits(tracks) & DiagdirReachesTrackdirs(enterdir);
+					for (uint n = RandomRange(CountBits(next_trackdirs)); n > 0; n--) RemoveFirstTrackdir(&next_trackdirs);
+					return FindFirstTrackdir(next_trackdirs);
+				}
+
+				case WRPR_FOUND: {
+					/* Only work out the first regions in detail; the rest is planned again on the way. */
+					uint length = min(high_level_path.Length(), YAPF_SHIP_REGION_LOOKAHEAD + 1);
+					Trackdir next_trackdir = FindShipPath(v, src_tile, trackdirs, tile, high_level_path.Begin(), high_level_path.Begin() + length, path_found);
+					if (path_found) return next_trackdir;
+					/* The detailed search can fail to follow the route over the
+					 * regions, e.g. when 90 degree turns are forbidden. */
+					break;
+				}
+
+				default: break;
+			}
+		}
+
+		return FindShipPath(v, src_tile, trackdirs, tile, NULL, NULL, path_found);
+	}
+
+	/**
+	 * Search a path for a ship and get the first trackdir of it.
+	 * @param v The ship.
+	 * @param src_tile Tile the ship is coming from.
+	 * @param trackdirs Trackdir the ship is coming from.
+	 * @param tile Tile the ship is entering.
+	 * @param corridor_begin First water patch the search may use, or NULL if it may use all water.
+	 * @param corridor_end End of the water patches the search may use. Unless the
+	 *                     last of them contains the destination, the search ends
+	 *                     as soon as it reaches that last patch.
+	 * @param path_found [out] Whether a path was found.
+	 * @return The trackdir on \a tile to take, or INVALID_TRACKDIR if there is none.
+	 */
+	static Trackdir FindShipPath(const Ship *v, TileIndex src_tile, TrackdirBits trackdirs, TileIndex tile, const WaterRegionPatchDesc *corridor_begin, const WaterRegionPatchDesc *corridor_end, bool &path_found)
+	{
 		/* get available trackdirs on the destination tile */
 		TrackdirBits dest_trackdirs = TrackStatusToTrackdirBits(GetTileTrackStatus(v->dest_tile, TRANSPORT_WATER, 0));
 
@@ -77,6 +159,10 @@ public:
 		/* set origin and destination nodes */
 		pf.SetOrigin(src_tile, trackdirs);
 		pf.SetDestination(v->dest_tile, dest_trackdirs);
+		if (corridor_begin != NULL) {
+			pf.SetCorridor(corridor_begin, corridor_end);
+			if (!IsTileInWaterRegionPatch(v->dest_tile, *(corridor_end - 1))) pf.SetDestinationPatch(*(corridor_end - 1));
+		}
 		/* find best path */
 		path_found = pf.FindPath(v);
 
@@ -140,6 +226,94 @@ public:
 	}
 };
 
+/**
+ * Destination provider of YAPF for ships. The destination is either the
+ *  destination tile of the ship or, when the search only plans a part of
+ *  the route, any tile of a water patch along the way.
+ */
+template <class Types>
+class CYapfDestinationShipT
+{
+public:
+	typedef typename Types::Tpf Tpf;              ///< the pathfinder class (derived from THIS class)
+	typedef typename Types::NodeList::Titem Node; ///< this will be our node type
+	typedef typename Node::Key Key;               ///< key to hash tables
+
+protected:
+	TileIndex            m_destTile;              ///< destination tile
+	TrackdirBits         m_destTrackdirs;         ///< destination trackdir mask
+	WaterRegionPatchDesc m_destPatch;             ///< water patch to reach instead of the destination tile, if its label is valid
+
+public:
+	/** set the destination tile / more trackdirs */
+	void SetDestination(TileIndex tile, TrackdirBits trackdirs)
+	{
+		m_destTile = tile;
+		m_destTrackdirs = trackdirs;
+		m_destPatch.label = INVALID_WATER_REGION_PATCH;
+	}
+
+	/** let the search end at any tile of the given water patch */
+	void SetDestinationPatch(const WaterRegionPatchDesc &patch)
+	{
+		m_destPatch = patch;
+	}
+
+protected:
+	/** to access inherited path finder */
+	Tpf& Yapf()
+	{
+		return *static_cast<Tpf*>(this);
+	}
+
+public:
+	/** Called by YAPF to detect if node ends in the desired destination */
+	FORCEINLINE bool PfDetectDestination(Node& n)
+	{
+		if (m_destPatch.label != INVALID_WATER_REGION_PATCH) return IsTileInWaterRegionPatch(n.m_key.m_tile, m_destPatch);
+		return (n.m_key.m_tile == m_destTile) && ((m_destTrackdirs & TrackdirToTrackdirBits(n.GetTrackdir())) != TRACKDIR_BIT_NONE);
+	}
+
+	/**
+	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
+	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
+	 */
+	inline bool PfCalcEstimate(Node& n)
+	{
+		static const int dg_dir_to_x_offs[] = {-1, 0, 1, 0};
+		static const int dg_dir_to_y_offs[] = {0, 1, 0, -1};
+		if (PfDetectDestination(n)) {
+			n.m_estimate = n.m_cost;
+			return true;
+		}
+
+		TileIndex tile = n.GetTile();
+		DiagDirection exitdir = TrackdirToExitdir(n.GetTrackdir());
+		int x1 = 2 * TileX(tile) + dg_dir_to_x_offs[(int)exitdir];
+		int y1 = 2 * TileY(tile) + dg_dir_to_y_offs[(int)exitdir];
+		int x2 = 2 * TileX(m_destTile);
+		int y2 = 2 * TileY(m_destTile);
+		if (m_destPatch.label != INVALID_WATER_REGION_PATCH) {
+			/* head for the closest tile of the region of the patch */
+			x2 = 2 * Clamp(TileX(tile), m_destPatch.x * WATER_REGION_EDGE_LENGTH, (m_destPatch.x + 1) * WATER_REGION_EDGE_LENGTH - 1);
+			y2 = 2 * Clamp(TileY(tile), m_destPatch.y * WATER_REGION_EDGE_LENGTH, (m_destPatch.y + 1) * WATER_REGION_EDGE_LENGTH - 1);
+		}
+		int dx = abs(x1 - x2);
+		int dy = abs(y1 - y2);
+		int dmin = min(dx, dy);
+		int dxy = abs(dx - dy);
+		int d = dmin * YAPF_TILE_CORNER_LENGTH + (dxy - 1) * (YAPF_TILE_LENGTH / 2);
+		if (m_destPatch.label != INVALID_WATER_REGION_PATCH) {
+			/* the closest tile of the region changes along the way, so this estimate is not consistent */
+			n.m_estimate = n.m_cost + max(d, 0);
+			return true;
+		}
+		n.m_estimate = n.m_cost + d;
+		assert(n.m_estimate >= n.m_parent->m_estimate);
+		return true;
+	}
+};
+
 /**
  * Config struct of YAPF for ships.
  *  Defines all 6 base YAPF modules as classes providing services for CYapfBaseT.
@@ -161,7 +335,7 @@ struct CYapfShip_TypesT
 	typedef CYapfBaseT<Types>                 PfBase;        // base pathfinder class
 	typedef CYapfFollowShipT<Types>           PfFollow;      // node follower
 	typedef CYapfOriginTileT<Types>           PfOrigin;      // origin provider
-	typedef CYapfDestinationTileT<Types>      PfDestination; // destination/distance provider
+	typedef CYapfDestinationShipT<Types>      PfDestination; // destination/distance provider
 	typedef CYapfSegmentCostCacheNoneT<Types> PfCache;       // segment cost cache provider
 	typedef CYapfCostShipT<Types>             PfCost;        // cost provider
 };
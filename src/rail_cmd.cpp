@@ -15,6 +15,7 @@
 #include "command_func.h"
 #include "depot_base.h"
 #include "pathfinder/yapf/yapf_cache.h"
+#include "pathfinder/water_regions.h"
 #include "newgrf_debug.h"
 #include "newgrf_railtype.h"
 #include "train.h"
@@ -458,6 +459,7 @@ CommandCost CmdBuildSingleRail(TileIndex tile, DoCommandFlag flags, uint32 p1, u
 					if (flags & DC_EXEC) {
 						MakeRoadCrossing(tile, GetRoadOwner(tile, ROADTYPE_ROAD), GetRoadOwner(tile, ROADTYPE_TRAM), _current_company, (track == TRACK_X ? AXIS_Y : AXIS_X), railtype, roadtypes, GetTownIndex(tile));
 						UpdateLevelCrossing(tile, false);
+						YapfNotifyRoadLayoutChange(tile);
 					}
 					break;
 				}
@@ -554,6 +556,7 @@ CommandCost CmdRemoveSingleRail(TileIndex tile, DoCommandFlag flags, uint32 p1,
 				owner = GetTileOwner(tile);
 				MakeRoadNormal(tile, GetCrossingRoadBits(tile), GetRoadTypes(tile), GetTownIndex(tile), GetRoadOwner(tile, ROADTYPE_ROAD), GetRoadOwner(tile, ROADTYPE_TRAM));
 				DeleteNewGRFInspectWindow(GSF_RAILTYPES, tile);
+				YapfNotifyRoadLayoutChange(tile);
 			}
 			break;
 		}
@@ -594,6 +597,7 @@ CommandCost CmdRemoveSingleRail(TileIndex tile, DoCommandFlag flags, uint32 p1,
 					/* If there is flat water on the lower halftile, convert the tile to shore so the water remains */
 					if (GetRailGroundType(tile) == RAIL_GROUND_WATER && IsSlopeWithOneCornerRaised(tileh)) {
 						MakeShore(tile);
+						InvalidateWaterRegion(tile);
 					} else {
 						DoClearSquare(tile);
 					}
@@ -2692,6 +2696,8 @@ static void ChangeTileOwner_Track(TileIndex tile, Owner old_owner, Owner new_own
 
 	if (new_owner != INVALID_OWNER) {
 		SetTileOwner(tile, new_owner);
+		/* Trains only pass tiles of their own company, so the cached segments changed too. */
+		YapfNotifyTrackLayoutChange(tile, IsRailDepot(tile) ? GetRailDepotTrack(tile) : FindFirstTrack(GetTrackBits(tile)));
 	} else {
 		DoCommand(tile, 0, 0, DC_EXEC | DC_BANKRUPT, CMD_LANDSCAPE_CLEAR);
 	}
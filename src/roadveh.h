@@ -151,13 +151,22 @@ protected: // These functions should not be called outside acceleration code.
 		return 0;
 	}
 
+	/**
+	 * Allows to know the weight of the cargo in this vehicle.
+	 * @return Weight of the cargo in tonnes.
+	 */
+	FORCEINLINE uint16 GetCargoWeight() const
+	{
+		return (CargoSpec::Get(this->cargo_type)->weight * this->cargo.Count()) / 16;
+	}
+
 	/**
 	 * Allows to know the weight value that this vehicle will use.
 	 * @return Weight value from the engine in tonnes.
 	 */
 	FORCEINLINE uint16 GetWeight() const
 	{
-		uint16 weight = (CargoSpec::Get(this->cargo_type)->weight * this->cargo.Count()) / 16;
+		uint16 weight = this->GetCargoWeight();
 
 		/* Vehicle weight is not added for articulated parts. */
 		if (!this->IsArticulatedPart()) {
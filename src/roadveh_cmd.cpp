@@ -14,6 +14,8 @@
 #include "command_func.h"
 #include "news_func.h"
 #include "pathfinder/npf/npf_func.h"
+#include "pathfinder/network_components.h"
+#include "pathfinder/pf_query_log.h"
 #include "station_base.h"
 #include "company_func.h"
 #include "vehicle_gui.h"
@@ -355,7 +357,10 @@ CommandCost CmdTurnRoadVeh(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 
 	if (IsTileType(v->tile, MP_TUNNELBRIDGE) && DirToDiagDir(v->direction) == GetTunnelBridgeDirection(v->tile)) return CMD_ERROR;
 
-	if (flags & DC_EXEC) v->reverse_ctr = 180;
+	if (flags & DC_EXEC) {
+		WakeVehicle(v);
+		v->reverse_ctr = 180;
+	}
 
 	return CommandCost();
 }
@@ -366,7 +371,12 @@ void RoadVehicle::MarkDirty()
 	for (RoadVehicle *v = this; v != NULL; v = v->Next()) {
 		v->UpdateViewport(false, false);
 	}
-	this->CargoChanged();
+	/* The cache of the parts is only filled for realistic acceleration. */
+	if (_settings_game.vehicle.roadveh_acceleration_model != AM_ORIGINAL) {
+		this->CargoAmountChanged();
+	} else {
+		this->CargoChanged();
+	}
 }
 
 void RoadVehicle::UpdateDeltaXY(Direction direction)
@@ -904,11 +914,18 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 		return_track(FindFirstBit2x64(trackdirs));
 	}
 
-	switch (_settings_game.pf.pathfinder_for_roadvehs) {
-		case VPF_NPF:  best_track = NPFRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found); break;
-		case VPF_YAPF: best_track = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found); break;
+	if (IsVehicleDestinationUnreachable(v, tile)) {
+		/* Don't search the whole network for a destination in another part of it. */
+		path_found = false;
+		best_track = (Trackdir)FindFirstBit2x64(trackdirs);
+	} else {
+		switch (_settings_game.pf.pathfinder_for_roadvehs) {
+			case VPF_NPF:  best_track = NPFRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found); break;
+			case VPF_YAPF: best_track = YapfRoadVehicleChooseTrack(v, tile, enterdir, trackdirs, path_found); break;
 
-		default: NOT_REACHED();
+			default: NOT_REACHED();
+		}
+		RecordPathfinderQuery(v, tile, enterdir, trackdirs, INVALID_TILE, INVALID_TRACKDIR, false, best_track, path_found);
 	}
 	v->HandlePathfindingResult(path_found);
 
@@ -27,10 +27,13 @@
 #include "../roadveh.h"
 #include "../train.h"
 #include "../station_base.h"
+#include "../station_func.h"
 #include "../waypoint_base.h"
 #include "../roadstop_base.h"
 #include "../tunnelbridge_map.h"
 #include "../pathfinder/yapf/yapf_cache.h"
+#include "../pathfinder/water_regions.h"
+#include "../pathfinder/network_components.h"
 #include "../elrail_func.h"
 #include "../signs_func.h"
 #include "../aircraft.h"
@@ -255,6 +258,8 @@ static void InitializeWindowsAndCaches()
 	SetCachedEngineCounts();
 
 	Station::RecomputeIndustriesNearForAll();
+	Station::RebuildLoadingStations();
+	RebuildStationRatingCycle();
 	RebuildSubsidisedSourceAndDestinationCache();
 
 	/* Towns have a noise controlled number of airports system
@@ -485,6 +490,10 @@ bool AfterLoadGame()
 
 	TileIndex map_size = MapSize();
 
+	/* The map may have another size now; the water regions are worked out again when ships need them. */
+	InitializeWaterRegions();
+	InitializeNetworkComponents();
+
 	if (IsSavegameVersionBefore(98)) GamelogOldver();
 
 	GamelogTestRevision();
@@ -1218,6 +1227,7 @@ bool AfterLoadGame()
 	}
 
 	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+	YapfNotifyRoadLayoutChange(INVALID_TILE);
 
 	if (IsSavegameVersionBefore(34)) {
 		Company *c;
@@ -65,9 +65,13 @@
 	if (!IsSavegameVersionBefore(68)) {
 		/* Only since version 68 we have cargo packets. Savegames from before used
 		 * 'new CargoPacket' + cargolist.Append so their caches are already
-		 * correct and do not need rebuilding. */
+		 * correct and do not need rebuilding. Appending also lets the packets
+		 * on vehicles age. */
 		Vehicle *v;
-		FOR_ALL_VEHICLES(v) v->cargo.InvalidateCache();
+		FOR_ALL_VEHICLES(v) {
+			v->cargo.StartAging();
+			v->cargo.InvalidateCache();
+		}
 
 		Station *st;
 		FOR_ALL_STATIONS(st) {
@@ -106,6 +110,7 @@ static void Save_CAPA()
 	CargoPacket *cp;
 
 	FOR_ALL_CARGOPACKETS(cp) {
+		cp->UpdateDaysInTransit();
 		SlSetArrayIndex(cp->index);
 		SlObject(cp, GetCargoPacketDesc());
 	}
@@ -71,6 +71,14 @@ const SaveLoad *GetLinkGraphDesc()
 
 /* Edges and nodes are saved in the correct order, so we don't need to save their ids. */
 
+static uint32 _num_edges;  ///< Number of edges starting at the node being saved or loaded.
+static uint32 _capacity;   ///< Capacity of an edge in the dense edge matrix of old savegames.
+static NodeID _next_edge;  ///< Next edge in the dense edge matrix of old savegames.
+static uint32 _num_flows;  ///< Number of fixed flows at the node being saved or loaded.
+static StationID _flow_origin; ///< Origin of the fixed flow being saved or loaded.
+static StationID _flow_via;    ///< Next hop of the fixed flow being saved or loaded.
+static uint32 _flow_planned;   ///< Amount of the fixed flow being saved or loaded.
+
 /**
  * SaveLoad desc for a link graph node.
  */
@@ -78,6 +86,20 @@ static const SaveLoad _node_desc[] = {
 	 SLE_CONDVAR(Node, supply,    SLE_UINT32, SL_COMPONENTS, SL_MAX_VERSION),
 	 SLE_CONDVAR(Node, demand,    SLE_UINT32, SL_COMPONENTS, SL_MAX_VERSION),
 	 SLE_CONDVAR(Node, station,   SLE_UINT16, SL_COMPONENTS, SL_MAX_VERSION),
+	 SLE_CONDVAR(Node, xy,        SLE_UINT32, SL_SPARSE_EDGES, SL_MAX_VERSION),
+	SLEG_CONDVAR(_num_edges,      SLE_UINT32, SL_SPARSE_EDGES, SL_MAX_VERSION),
+	 SLE_CONDVAR(Node, flows_fixed, SLE_BOOL,  SL_INCREMENTAL, SL_MAX_VERSION),
+	SLEG_CONDVAR(_num_flows,      SLE_UINT32,  SL_INCREMENTAL, SL_MAX_VERSION),
+	 SLE_END()
+};
+
+/**
+ * SaveLoad desc for a flow taken over from the last calculation.
+ */
+static const SaveLoad _fixed_flow_desc[] = {
+	SLEG_CONDVAR(_flow_origin,    SLE_UINT16,  SL_INCREMENTAL, SL_MAX_VERSION),
+	SLEG_CONDVAR(_flow_via,       SLE_UINT16,  SL_INCREMENTAL, SL_MAX_VERSION),
+	SLEG_CONDVAR(_flow_planned,   SLE_UINT32,  SL_INCREMENTAL, SL_MAX_VERSION),
 	 SLE_END()
 };
 
@@ -85,26 +107,113 @@ static const SaveLoad _node_desc[] = {
  * SaveLoad desc for a link graph edge.
  */
 static const SaveLoad _edge_desc[] = {
-	 SLE_CONDVAR(Edge, distance,  SLE_UINT32, SL_COMPONENTS, SL_MAX_VERSION),
-	 SLE_CONDVAR(Edge, capacity,  SLE_UINT32, SL_COMPONENTS, SL_MAX_VERSION),
-	 SLE_CONDVAR(Edge, next_edge, SLE_UINT32,        SL_MCF, SL_MAX_VERSION),
+	 SLE_CONDVAR(Edge, to,        SLE_UINT32, SL_SPARSE_EDGES, SL_MAX_VERSION),
+	 SLE_CONDVAR(Edge, capacity,  SLE_UINT32, SL_SPARSE_EDGES, SL_MAX_VERSION),
 	 SLE_END()
 };
 
 /**
- * Save/load a component of a link graph
- * @param comp the component to be saved or loaded
+ * SaveLoad desc for an entry in the dense edge matrix of old savegames.
+ */
+static const SaveLoad _old_edge_desc[] = {
+	SLE_CONDNULL(4,                           SL_COMPONENTS, SL_SPARSE_EDGES - 1),
+	SLEG_CONDVAR(_capacity,       SLE_UINT32, SL_COMPONENTS, SL_SPARSE_EDGES - 1),
+	SLEG_CONDVAR(_next_edge,      SLE_UINT32,        SL_MCF, SL_SPARSE_EDGES - 1),
+	 SLE_END()
+};
+
+/**
+ * Load a row of the dense edge matrix of old savegames and add the edges in it
+ * to the component. Edges are found by following the next_edge chain starting
+ * at the diagonal entry. Before SL_MCF that chain wasn't saved, so all entries
+ * with capacity are taken.
+ * @param comp Component to add the edges to.
+ * @param from Source node of the row.
+ */
+static void Load_OldEdges(LinkGraphComponent &comp, NodeID from)
+{
+	uint size = comp.GetSize();
+	std::vector<uint32> capacities(size);
+	std::vector<NodeID> next_edges(size);
+	for (NodeID to = 0; to < size; ++to) {
+		_capacity = 0;
+		_next_edge = INVALID_NODE;
+		SlObject(NULL, _old_edge_desc);
+		capacities[to] = _capacity;
+		next_edges[to] = _next_edge;
+	}
+
+	if (IsSavegameVersionBefore(SL_MCF)) {
+		for (NodeID to = 0; to < size; ++to) {
+			if (to != from && capacities[to] > 0) comp.AddEdge(from, to, capacities[to]);
+		}
+	} else {
+		for (NodeID to = next_edges[from]; to != INVALID_NODE; to = next_edges[to]) {
+			comp.AddEdge(from, to, capacities[to]);
+		}
+	}
+}
+
+/**
+ * Save a component of a link graph.
+ * @param comp the component to be saved
  */
-static void SaveLoad_LinkGraphComponent(LinkGraphComponent &comp)
+static void Save_LinkGraphComponent(LinkGraphComponent &comp)
+{
+	uint size = comp.GetSize();
+	for (NodeID from = 0; from < size; ++from) {
+		LinkGraphComponent::EdgeIterator begin = comp.GetEdgesBegin(from);
+		LinkGraphComponent::EdgeIterator end = comp.GetEdgesEnd(from);
+		_num_edges = (uint32)(end - begin);
+		FlowMap &fixed_flows = comp.GetNode(from).fixed_flows;
+		_num_flows = 0;
+		for (FlowMap::iterator i = fixed_flows.begin(); i != fixed_flows.end(); ++i) {
+			_num_flows += (uint32)i->second.size();
+		}
+		SlObject(&comp.GetNode(from), _node_desc);
+		for (LinkGraphComponent::EdgeIterator i = begin; i != end; ++i) {
+			SlObject(&*i, _edge_desc);
+		}
+		for (FlowMap::iterator i = fixed_flows.begin(); i != fixed_flows.end(); ++i) {
+			_flow_origin = i->first;
+			for (FlowViaMap::iterator j = i->second.begin(); j != i->second.end(); ++j) {
+				_flow_via = j->first;
+				_flow_planned = j->second;
+				SlObject(NULL, _fixed_flow_desc);
+			}
+		}
+	}
+}
+
+/**
+ * Load a component of a link graph.
+ * @param comp the component to be loaded
+ */
+static void Load_LinkGraphComponent(LinkGraphComponent &comp)
 {
 	uint size = comp.GetSize();
 	for (NodeID from = 0; from < size; ++from) {
 		Node *node = &comp.GetNode(from);
+		_num_flows = 0;
 		SlObject(node, _node_desc);
-		for (NodeID to = 0; to < size; ++to) {
-			SlObject(&comp.GetEdge(from, to), _edge_desc);
+		if (IsSavegameVersionBefore(SL_SPARSE_EDGES)) {
+			Station *st = Station::GetIfValid(node->station);
+			node->xy = st != NULL ? st->xy : 0;
+			Load_OldEdges(comp, from);
+		} else {
+			for (uint i = 0; i < _num_edges; ++i) {
+				Edge edge;
+				edge.Init();
+				SlObject(&edge, _edge_desc);
+				comp.AddEdge(from, edge.to, edge.capacity);
+			}
+		}
+		for (uint i = 0; i < _num_flows; ++i) {
+			SlObject(NULL, _fixed_flow_desc);
+			node->fixed_flows[_flow_origin][_flow_via] = _flow_planned;
 		}
 	}
+	comp.IndexEdges();
 }
 
 /**
@@ -115,7 +224,7 @@ static void DoSave_LGRP(void *)
 	for (CargoID cargo = 0; cargo < NUM_CARGO; ++cargo) {
 		LinkGraph &graph = _link_graphs[cargo];
 		SlObject(&graph, GetLinkGraphDesc());
-		SaveLoad_LinkGraphComponent(graph);
+		Save_LinkGraphComponent(graph);
 	}
 }
 
@@ -129,7 +238,7 @@ static void Load_LGRP()
 		assert(graph.GetSize() == 0);
 		SlObject(&graph, GetLinkGraphDesc());
 		graph.SetSize();
-		SaveLoad_LinkGraphComponent(graph);
+		Load_LinkGraphComponent(graph);
 		for (uint i = 0; i < graph.GetSize(); ++i) {
 			Node &node = graph.GetNode(i);
 			node.undelivered_supply = node.supply;
@@ -138,14 +247,14 @@ static void Load_LGRP()
 }
 
 /**
- * Spawn the threads for running link graph calculations.
+ * Spawn the jobs for running link graph calculations.
  * Has to be done after loading as the cargo classes might have changed.
  */
 void AfterLoadLinkGraphs()
 {
 	for (CargoID cargo = 0; cargo < NUM_CARGO; ++cargo) {
 		LinkGraph &graph = _link_graphs[cargo];
-		if (graph.GetSize() > 0) graph.SpawnThread();
+		if (graph.GetSize() > 0) graph.Spawn();
 	}
 }
 
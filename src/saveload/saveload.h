@@ -560,6 +560,8 @@ enum SaveLoadVersions {
 	SL_FLOWMAP,
 	SL_CARGOMAP,
 	SL_EXT_RATING,
+	SL_SPARSE_EDGES,
+	SL_INCREMENTAL,
 
 	/** Highest possible savegame version. */
 	SL_MAX_VERSION = 255
@@ -11,6 +11,7 @@
 
 #include "../stdafx.h"
 #include "../station_base.h"
+#include "../station_func.h"
 #include "../waypoint_base.h"
 #include "../roadstop_base.h"
 #include "../vehicle_base.h"
@@ -253,6 +254,7 @@ const SaveLoad *GetLinkStatDesc()
 		 SLE_VAR(LinkStat,    capacity,            SLE_UINT32),
 		 SLE_VAR(LinkStat,    frozen,              SLE_UINT32),
 		 SLE_VAR(LinkStat,    usage,               SLE_UINT32),
+		 SLE_CONDVAR(LinkStat, recalc_capacity,    SLE_UINT32, SL_INCREMENTAL, SL_MAX_VERSION),
 		 SLE_END()
 	};
 
@@ -311,6 +313,8 @@ const SaveLoad *GetGoodsDesc()
 		SLEG_CONDVAR(            _num_flows,          SLE_UINT32,         SL_FLOWMAP, SL_MAX_VERSION),
 		 SLE_CONDVAR(GoodsEntry, last_component,      SLE_UINT16,      SL_COMPONENTS, SL_MAX_VERSION),
 		 SLE_CONDVAR(GoodsEntry, max_waiting_cargo,   SLE_UINT32,      SL_EXT_RATING, SL_MAX_VERSION),
+		 SLE_CONDVAR(GoodsEntry, recalc_supply,       SLE_UINT32,     SL_INCREMENTAL, SL_MAX_VERSION),
+		 SLE_CONDVAR(GoodsEntry, recalc_acceptance,   SLE_BOOL,       SL_INCREMENTAL, SL_MAX_VERSION),
 		SLE_END()
 	};
 
@@ -334,17 +338,8 @@ static void SwapPackets(GoodsEntry *ge)
 {
 	StationCargoPacketMap &ge_packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
 
-	if (_packets.empty()) {
-		std::map<StationID, std::list<CargoPacket *> >::iterator it(ge_packets.find(INVALID_STATION));
-		if (it == ge_packets.end()) {
-			return;
-		} else {
-			it->second.swap(_packets);
-		}
-	} else {
-		assert(ge_packets[INVALID_STATION].empty());
-		ge_packets[INVALID_STATION].swap(_packets);
-	}
+	assert(_packets.empty() || ge_packets.GetHops().find(INVALID_STATION) == ge_packets.GetHops().end());
+	ge_packets.SwapHop(INVALID_STATION, _packets);
 }
 
 static void Load_STNS()
@@ -511,8 +506,10 @@ static void RealSave_STNN(BaseStation *bst)
 					SlObject(&fs, GetFlowStatDesc());
 				}
 			}
-			for (StationCargoPacketMap::ConstMapIterator it(st->goods[c].cargo.Packets()->begin()); it != st->goods[c].cargo.Packets()->end(); ++it) {
-				SlObject(const_cast<StationCargoPacketMap::value_type *>(&(*it)), _cargo_list_desc);
+			const StationCargoPacketMap::HopMap &hops = st->goods[c].cargo.Packets()->GetHops();
+			for (StationCargoPacketMap::HopMap::const_iterator it(hops.begin()); it != hops.end(); ++it) {
+				StationCargoPair pair(it->first, std::list<CargoPacket *>(it->second.packets.begin(), it->second.packets.end()));
+				SlObject(&pair, _cargo_list_desc);
 			}
 		}
 	}
@@ -524,6 +521,8 @@ static void RealSave_STNN(BaseStation *bst)
 
 static void Save_STNN()
 {
+	UpdateStationDeleteCounters();
+
 	BaseStation *st;
 	/* Write the stations */
 	FOR_ALL_BASE_STATIONS(st) {
@@ -555,7 +554,7 @@ static void Load_STNN()
 				FlowStat fs;
 				for (uint32 i = 0; i < _num_flows; ++i) {
 					SlObject(&fs, GetFlowStatDesc());
-					st->goods[c].flows[_station_id].insert(fs);
+					st->goods[c].flows[_station_id].Insert(fs);
 				}
 				if (IsSavegameVersionBefore(SL_CARGOMAP -1)) {
 					SwapPackets(&st->goods[c]);
@@ -563,7 +562,7 @@ static void Load_STNN()
 					StationCargoPair pair;
 					for (uint i = 0; i < _num_dests; ++i) {
 						SlObject(&pair, _cargo_list_desc);
-						const_cast<StationCargoPacketMap &>(*(st->goods[c].cargo.Packets()))[pair.first].swap(pair.second);
+						const_cast<StationCargoPacketMap &>(*(st->goods[c].cargo.Packets())).SwapHop(pair.first, pair.second);
 						assert(pair.second.empty());
 					}
 				}
@@ -595,8 +594,16 @@ static void Ptrs_STNN()
 				SwapPackets(ge);
 			} else {
 				SlObject(ge, GetGoodsDesc());
-				for (StationCargoPacketMap::ConstMapIterator it = ge->cargo.Packets()->begin(); it != ge->cargo.Packets()->end(); ++it) {
-					SlObject(const_cast<StationCargoPair *>(&(*it)), _cargo_list_desc);
+				StationCargoPacketMap &packets = const_cast<StationCargoPacketMap &>(*ge->cargo.Packets());
+				std::vector<StationID> next_hops;
+				for (StationCargoPacketMap::HopMap::const_iterator it(packets.GetHops().begin()); it != packets.GetHops().end(); ++it) {
+					next_hops.push_back(it->first);
+				}
+				for (std::vector<StationID>::iterator it(next_hops.begin()); it != next_hops.end(); ++it) {
+					StationCargoPair pair(*it, std::list<CargoPacket *>());
+					packets.SwapHop(*it, pair.second);
+					SlObject(&pair, _cargo_list_desc);
+					packets.SwapHop(*it, pair.second);
 				}
 			}
 		}
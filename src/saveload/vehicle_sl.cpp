@@ -737,6 +737,9 @@ const SaveLoad *GetVehicleDescription(VehicleType vt)
 /** Will be called when the vehicles need to be saved. */
 static void Save_VEHS()
 {
+	/* Catch up on the ticks the sleeping vehicles skipped. */
+	WakeAllVehicles();
+
 	Vehicle *v;
 	/* Write the vehicles */
 	FOR_ALL_VEHICLES(v) {
@@ -32,6 +32,7 @@
 #include "command_func.h"
 #include "console_func.h"
 #include "pathfinder/pathfinder_type.h"
+#include "pathfinder/yapf/yapf_cache.h"
 #include "genworld.h"
 #include "train.h"
 #include "news_func.h"
@@ -64,6 +65,8 @@
 
 #include "void_map.h"
 #include "station_base.h"
+#include "vehicle_func.h"
+#include "linkgraph/linkgraph.h"
 
 #include "table/strings.h"
 #include "table/settings.h"
@@ -870,6 +873,21 @@ static bool RoadVehSlopeSteepnessChanged(int32 p1)
 	return true;
 }
 
+/**
+ * Flush the segment costs cached by YAPF, as they include the penalties of
+ * the pathfinder settings. Otherwise the old costs would be used until the
+ * segments are invalidated by changes around them, and a client joining
+ * later would calculate other routes than the server.
+ * @param p1 Callback parameter.
+ * @return Always true.
+ */
+static bool InvalidatePathfinderCaches(int32 p1)
+{
+	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+	YapfNotifyRoadLayoutChange(INVALID_TILE);
+	return true;
+}
+
 static bool DragSignalsDensityChanged(int32)
 {
 	InvalidateWindowData(WC_BUILD_SIGNAL, 0);
@@ -1414,6 +1414,7 @@ static SettingEntry _settings_linkgraph[] = {
 	SettingEntry("linkgraph.demand_distance"),
 	SettingEntry("linkgraph.demand_size"),
 	SettingEntry("linkgraph.short_path_saturation"),
+	SettingEntry("linkgraph.recalc_threshold"),
 };
 /** Linkgraph sub-page */
 static SettingsPage _settings_linkgraph_page = {_settings_linkgraph, lengthof(_settings_linkgraph)};
@@ -22,6 +22,7 @@
 #include "vehiclelist.h"
 #include "core/pool_func.hpp"
 #include "station_base.h"
+#include "station_func.h"
 #include "roadstop_base.h"
 #include "industry.h"
 #include "core/random_func.hpp"
@@ -57,7 +58,8 @@ Station::Station(TileIndex tile) :
 	indtype(IT_INVALID),
 	time_since_load(255),
 	time_since_unload(255),
-	last_vehicle_type(VEH_INVALID)
+	last_vehicle_type(VEH_INVALID),
+	rating_slot(INVALID_RATING_SLOT)
 {
 	/* this->random_bits is set in Station::AddFacility() */
 
@@ -82,6 +84,8 @@ Station::~Station()
 		this->loading_vehicles.front()->LeaveStation();
 	}
 
+	RemoveStationFromRatingCycle(this);
+
 	Aircraft *a;
 	FOR_ALL_AIRCRAFT(a) {
 		if (!a->IsNormalAircraft()) continue;
@@ -165,6 +169,7 @@ RoadStop *Station::GetPrimaryRoadStop(const RoadVehicle *v) const
  */
 void Station::AddFacility(StationFacility new_facility_bit, TileIndex facil_xy)
 {
+	bool was_in_use = this->IsInUse();
 	if (this->facilities == FACIL_NONE) {
 		this->xy = facil_xy;
 		this->random_bits = Random();
@@ -172,6 +177,66 @@ void Station::AddFacility(StationFacility new_facility_bit, TileIndex facil_xy)
 	this->facilities |= new_facility_bit;
 	this->owner = _current_company;
 	this->build_date = _date;
+	if (!was_in_use) AddStationToRatingCycle(this);
+}
+
+/** Bitmap of the stations with loading vehicles by pool index. */
+static std::vector<uint32> _loading_stations;
+
+/**
+ * Add a vehicle to the end of the queue of vehicles loading at this station.
+ * @param v Vehicle that starts loading.
+ */
+void Station::AddLoadingVehicle(Vehicle *v)
+{
+	this->loading_vehicles.push_back(v);
+
+	size_t word = this->index / 32;
+	if (word >= _loading_stations.size()) _loading_stations.resize(word + 1, 0);
+	SetBit(_loading_stations[word], this->index % 32);
+}
+
+/**
+ * Remove a vehicle from the queue of vehicles loading at this station.
+ * @param v Vehicle that stops loading.
+ */
+void Station::RemoveLoadingVehicle(Vehicle *v)
+{
+	this->loading_vehicles.remove(v);
+	if (this->loading_vehicles.empty() && this->index / 32 < _loading_stations.size()) {
+		ClrBit(_loading_stations[this->index / 32], this->index % 32);
+	}
+}
+
+/**
+ * Find the next station with loading vehicles. Iterating the stations this way
+ * visits them in the same order as FOR_ALL_STATIONS, but skips all stations
+ * where nothing is loaded.
+ * @param index Pool index to start searching at.
+ * @return Pool index of the first station at or after \a index with loading vehicles, or a value >= GetPoolSize() if there is none.
+ */
+/* static */ size_t Station::GetNextLoadingIndex(size_t index)
+{
+	for (size_t word = index / 32; word < _loading_stations.size(); word++, index = word * 32) {
+		uint32 loading = _loading_stations[word] & (UINT32_MAX << (index % 32));
+		if (loading != 0) return word * 32 + FindFirstBit(loading);
+	}
+	return Station::GetPoolSize();
+}
+
+/** Rebuild the set of stations with loading vehicles, e.g. after loading a game. */
+/* static */ void Station::RebuildLoadingStations()
+{
+	_loading_stations.clear();
+
+	Station *st;
+	FOR_ALL_STATIONS(st) {
+		if (st->loading_vehicles.empty()) continue;
+
+		size_t word = st->index / 32;
+		if (word >= _loading_stations.size()) _loading_stations.resize(word + 1, 0);
+		SetBit(_loading_stations[word], st->index % 32);
+	}
 }
 
 /**
@@ -533,4 +598,6 @@ StationRect& StationRect::operator = (const Rect &src)
 void InitializeStations()
 {
 	_station_pool.CleanPool();
+	Station::RebuildLoadingStations();
+	RebuildStationRatingCycle();
 }
@@ -21,11 +21,14 @@
 #include "moving_average.h"
 #include <map>
 #include <set>
+#include <vector>
 
 typedef Pool<BaseStation, StationID, 32, 64000> StationPool;
 extern StationPool _station_pool;
 
 static const byte INITIAL_STATION_RATING = 175;
+static const uint STATION_RATING_TICKS = 185; ///< Number of ticks between two updates of the cargo ratings of a station.
+static const byte INVALID_RATING_SLOT = 0xFF;  ///< Rating slot of stations which aren't rated.
 
 /**
  * Link statistics. They include figures for capacity and usage of a link. Both
@@ -54,6 +57,11 @@ private:
 	 */
 	uint usage;
 
+	/**
+	 * Capacity the last link graph calculation involving this link was based on.
+	 */
+	uint recalc_capacity;
+
 public:
 	/**
 	 * Minimum length of moving averages for capacity and usage.
@@ -63,7 +71,7 @@ public:
 	friend const SaveLoad *GetLinkStatDesc();
 
 	FORCEINLINE LinkStat(uint distance = 1, uint capacity = 0, uint frozen = 0, uint usage = 0) :
-		MovingAverage<uint>(distance), capacity(capacity), frozen(frozen), usage(usage) {}
+		MovingAverage<uint>(distance), capacity(capacity), frozen(frozen), usage(usage), recalc_capacity(0) {}
 
 	/**
 	 * Reset everything to 0.
@@ -159,6 +167,25 @@ public:
 	{
 		return this->capacity == 0;
 	}
+
+	/**
+	 * Get the capacity the last link graph calculation involving this link
+	 * was based on.
+	 * @return Capacity at the time of that calculation.
+	 */
+	FORCEINLINE uint RecalcCapacity() const
+	{
+		return this->recalc_capacity;
+	}
+
+	/**
+	 * Remember the current capacity as the one the link graph calculation is
+	 * based on.
+	 */
+	FORCEINLINE void SetRecalcCapacity()
+	{
+		this->recalc_capacity = this->Capacity();
+	}
 };
 
 /**
@@ -192,13 +219,11 @@ public:
 		MovingAverage<uint>(prev.length), planned(new_plan), sent(prev.sent), via(prev.via) {}
 
 	/**
-	 * Prevents one copy operation when moving a flowstat from one set to another and decreasing it at the same time.
+	 * Decrease the sent value using the moving average.
 	 */
-	FORCEINLINE FlowStat GetDecreasedCopy() const
+	FORCEINLINE void Decrease()
 	{
-		FlowStat ret(this->length, this->via, this->planned, this->sent);
-		this->MovingAverage<uint>::Decrease(ret.sent);
-		return ret;
+		this->MovingAverage<uint>::Decrease(this->sent);
 	}
 
 	/**
@@ -237,30 +262,6 @@ public:
 		return this->via;
 	}
 
-	/**
-	 * Comparator for two flow stats for ordering them in a way that makes
-	 * the next flow stat to sent cargo for show up as first element.
-	 */
-	struct Comparator {
-		/**
-		 * Comparator function. Decides by planned - sent or via, if those
-		 * are equal.
-		 * @param x First flow stat.
-		 * @param y Second flow stat.
-		 * @return True if x.planned - x.sent is greater than y.planned - y.sent.
-		 */
-		bool operator()(const FlowStat &x, const FlowStat &y) const
-		{
-			int diff_x = (int)x.Planned() - (int)x.Sent();
-			int diff_y = (int)y.Planned() - (int)y.Sent();
-			if (diff_x != diff_y) {
-				return diff_x > diff_y;
-			} else {
-				return x.Via() > y.Via();
-			}
-		}
-	};
-
 	/**
 	 * Add up two flow stats' planned and sent figures and assign via from the other one to this one.
 	 * @param other Flow stat to add to this one.
@@ -291,7 +292,66 @@ public:
 	}
 };
 
-typedef std::set<FlowStat, FlowStat::Comparator> FlowStatSet; ///< Percentage of flow to be sent via specified station (or consumed locally).
+/**
+ * Flow stats for all next hops of cargo from one origin. They're kept in a
+ * flat vector ordered by next hop. Cargo is sent to the next hop with the
+ * highest planned minus sent flow, which is found by walking all of them;
+ * there are only as many as the origin has links. Sending cargo only changes
+ * the sent figures, so the flow stats never have to be reordered for that.
+ */
+class FlowStatSet {
+public:
+	typedef std::vector<FlowStat> FlowStatVector;
+	typedef FlowStatVector::const_iterator const_iterator;
+
+	/**
+	 * Get an iterator to the first flow stat.
+	 * @return Iterator to the flow stat with the lowest next hop.
+	 */
+	FORCEINLINE const_iterator begin() const {return this->flows.begin();}
+
+	/**
+	 * Get an iterator past the last flow stat.
+	 * @return End iterator.
+	 */
+	FORCEINLINE const_iterator end() const {return this->flows.end();}
+
+	/**
+	 * Check if there are any flow stats.
+	 * @return If there are no flow stats.
+	 */
+	FORCEINLINE bool empty() const {return this->flows.empty();}
+
+	/**
+	 * Get the number of flow stats.
+	 * @return Number of next hops.
+	 */
+	FORCEINLINE size_t size() const {return this->flows.size();}
+
+	/**
+	 * Remove all flow stats.
+	 */
+	FORCEINLINE void clear() {this->flows.clear();}
+
+	/**
+	 * Exchange the flow stats with another set.
+	 * @param other Set to exchange the flow stats with.
+	 */
+	FORCEINLINE void swap(FlowStatSet &other) {this->flows.swap(other.flows);}
+
+	void Insert(const FlowStat &flow);
+	void Erase(StationID via);
+	void Increase(StationID via, uint count);
+	void RunAverages();
+
+	StationID GetVia() const;
+	StationID GetVia(StationID excluded) const;
+
+private:
+	FlowStatVector flows; ///< Flow stats ordered by next hop.
+
+	FlowStatVector::iterator Find(StationID via);
+};
 
 typedef std::map<StationID, LinkStat> LinkStatMap;
 typedef std::map<StationID, FlowStatSet> FlowStatMap; ///< Flow descriptions by origin stations.
@@ -313,7 +373,9 @@ struct GoodsEntry {
 		supply(0),
 		supply_new(0),
 		last_component(INVALID_LINKGRAPH_COMPONENT),
-		max_waiting_cargo(0)
+		max_waiting_cargo(0),
+		recalc_supply(0),
+		recalc_acceptance(false)
 	{}
 
 	byte acceptance_pickup;
@@ -329,11 +391,11 @@ struct GoodsEntry {
 	LinkStatMap link_stats;              ///< Capacities and usage statistics for outgoing links.
 	LinkGraphComponentID last_component; ///< Component this station was last part of in this cargo's link graph.
 	uint max_waiting_cargo;              ///< Max cargo from this station waiting at any station.
+	uint recalc_supply;                  ///< Supply the last full link graph calculation was based on.
+	bool recalc_acceptance;              ///< Acceptance the last full link graph calculation was based on.
 	FlowStat GetSumFlowVia(StationID via) const;
 
 	void UpdateFlowStats(StationID source, uint count, StationID next);
-	void UpdateFlowStats(FlowStatSet &flow_stats, uint count, StationID next);
-	void UpdateFlowStats(FlowStatSet &flow_stats, FlowStatSet::iterator flow_it, uint count);
 
 	StationID UpdateFlowStatsTransfer(StationID source, uint count, StationID curr);
 };
@@ -480,7 +542,8 @@ public:
 	byte time_since_unload;
 
 	byte last_vehicle_type;
-	std::list<Vehicle *> loading_vehicles;
+	std::list<Vehicle *> loading_vehicles; ///< Vehicles loading or unloading at the station, in the order they arrived. Use AddLoadingVehicle() and RemoveLoadingVehicle() to modify it.
+	byte rating_slot;             ///< Tick of the rating cycle at which the ratings are updated, or INVALID_RATING_SLOT if they aren't. @see AddStationToRatingCycle()
 	GoodsEntry goods[NUM_CARGO];  ///< Goods at this station
 	uint32 always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
@@ -491,6 +554,11 @@ public:
 
 	void AddFacility(StationFacility new_facility_bit, TileIndex facil_xy);
 
+	void AddLoadingVehicle(Vehicle *v);
+	void RemoveLoadingVehicle(Vehicle *v);
+	static size_t GetNextLoadingIndex(size_t index);
+	static void RebuildLoadingStations();
+
 	void MarkTilesDirty(bool cargo_change) const;
 
 	void UpdateVirtCoord();
@@ -52,6 +52,7 @@
 
 #include "table/strings.h"
 #include "newgrf_townname.h"
+#include <algorithm>
 
 /**
  * Check whether the given tile is a hangar.
@@ -715,6 +716,7 @@ static void UpdateStationSignCoord(BaseStation *st)
 static void DeleteStationIfEmpty(BaseStation *st)
 {
 	if (!st->IsInUse()) {
+		if (Station::IsExpected(st)) RemoveStationFromRatingCycle(Station::From(st));
 		st->delete_ctr = 0;
 		InvalidateWindowData(WC_STATION_LIST, st->owner, 0);
 	}
@@ -1357,10 +1359,10 @@ CommandCost CmdBuildRailStation(TileIndex tile_org, DoCommandFlag flags, uint32
 					TriggerStationAnimation(st, tile, SAT_BUILT);
 				}
 
+				YapfNotifyTrackLayoutChange(tile, track);
 				tile += tile_delta;
 			} while (--w);
 			AddTrackToSignalBuffer(tile_org, track, _current_company);
-			YapfNotifyTrackLayoutChange(tile_org, track);
 			tile_org += tile_delta ^ TileDiffXY(1, 1); // perpendicular to tile_delta
 		} while (--numtracks);
 
@@ -1879,6 +1881,7 @@ CommandCost CmdBuildRoadStop(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 			}
 
 			MarkTileDirtyByTile(cur_tile);
+			YapfNotifyRoadLayoutChange(cur_tile);
 		}
 	}
 
@@ -1970,6 +1973,7 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 		} else {
 			DoClearSquare(tile);
 		}
+		YapfNotifyRoadLayoutChange(tile);
 
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, SVW_ROADVEHS);
 		delete cur_stop;
@@ -2048,6 +2052,7 @@ CommandCost CmdRemoveRoadStop(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 		if ((flags & DC_EXEC) && is_drive_through) {
 			MakeRoadNormal(cur_tile, road_bits, rts, ClosestTownFromTile(cur_tile, UINT_MAX)->index,
 					road_owner, tram_owner);
+			YapfNotifyRoadLayoutChange(cur_tile);
 		}
 	}
 
@@ -3346,14 +3351,7 @@ void DeleteStaleFlows(StationID at, CargoID c_id, StationID to)
 	FlowStatMap &flows = Station::Get(at)->goods[c_id].flows;
 	for (FlowStatMap::iterator f_it = flows.begin(); f_it != flows.end();) {
 		FlowStatSet &s_flows = f_it->second;
-		for (FlowStatSet::iterator s_it = s_flows.begin(); s_it != s_flows.end();) {
-			if (s_it->Via() == to) {
-				s_flows.erase(s_it++);
-				break; // There can only be one flow stat for this remote station in each set.
-			} else {
-				++s_it;
-			}
-		}
+		s_flows.Erase(to);
 		if (s_flows.empty()) {
 			flows.erase(f_it++);
 		} else {
@@ -3378,7 +3376,6 @@ uint GetMovingAverageLength(const Station *from, const Station *to)
  */
 void Station::RunAverages()
 {
-	FlowStatSet new_flows;
 	for (int goods_index = 0; goods_index < NUM_CARGO; ++goods_index) {
 		LinkStatMap &links = this->goods[goods_index].link_stats;
 		for (LinkStatMap::iterator i = links.begin(); i != links.end();) {
@@ -3410,14 +3407,7 @@ void Station::RunAverages()
 			if (!Station::IsValidID(i->first)) {
 				flows.erase(i++);
 			} else {
-				FlowStatSet &flow_set = i->second;
-				for (FlowStatSet::iterator j = flow_set.begin(); j != flow_set.end(); ++j) {
-					if (Station::IsValidID(j->Via())) {
-						new_flows.insert(j->GetDecreasedCopy());
-					}
-				}
-				flow_set.swap(new_flows);
-				new_flows.clear();
+				i->second.RunAverages();
 				++i;
 			}
 		}
@@ -3531,16 +3521,71 @@ void IncreaseStats(Station *st, const Vehicle *front, StationID next_station_id,
 	}
 }
 
-/* called for every station each tick */
-static void StationHandleSmallTick(BaseStation *st)
+/**
+ * The ratings of each station in use are updated once every
+ * STATION_RATING_TICKS ticks. Instead of counting down every station every
+ * tick, the stations are sorted into the slots of a wheel by the tick of the
+ * cycle at which they are due, so that only the due stations are touched.
+ * While a station is on the wheel its delete_ctr isn't kept up to date; it
+ * follows from the station's slot and the current tick of the cycle.
+ */
+static std::vector<StationID> _station_rating_cycle[STATION_RATING_TICKS];
+static uint _station_rating_tick; ///< Current tick of the rating cycle.
+
+/**
+ * Put a station which just came into use on the rating wheel. Its ratings
+ * are updated when delete_ctr would wrap around at the end of the cycle.
+ * @param st Station to be added.
+ */
+void AddStationToRatingCycle(Station *st)
 {
-	if ((st->facilities & FACIL_WAYPOINT) != 0 || !st->IsInUse()) return;
+	assert(st->rating_slot == INVALID_RATING_SLOT);
 
-	byte b = st->delete_ctr + 1;
-	if (b >= 185) b = 0;
-	st->delete_ctr = b;
+	uint ticks = st->delete_ctr < STATION_RATING_TICKS ? STATION_RATING_TICKS - st->delete_ctr : 1;
+	st->rating_slot = (_station_rating_tick + ticks) % STATION_RATING_TICKS;
 
-	if (b == 0) UpdateStationRating(Station::From(st));
+	std::vector<StationID> &slot = _station_rating_cycle[st->rating_slot];
+	slot.insert(std::lower_bound(slot.begin(), slot.end(), st->index), st->index);
+}
+
+/**
+ * Take a station which isn't in use anymore off the rating wheel.
+ * @param st Station to be removed.
+ */
+void RemoveStationFromRatingCycle(Station *st)
+{
+	if (st->rating_slot == INVALID_RATING_SLOT) return;
+
+	std::vector<StationID> &slot = _station_rating_cycle[st->rating_slot];
+	std::vector<StationID>::iterator it = std::lower_bound(slot.begin(), slot.end(), st->index);
+	assert(it != slot.end() && *it == st->index);
+	slot.erase(it);
+
+	st->delete_ctr = (_station_rating_tick + STATION_RATING_TICKS - st->rating_slot) % STATION_RATING_TICKS;
+	st->rating_slot = INVALID_RATING_SLOT;
+}
+
+/** Put all stations in use on the rating wheel according to their delete_ctr, e.g. after loading a game. */
+void RebuildStationRatingCycle()
+{
+	for (uint i = 0; i < STATION_RATING_TICKS; i++) _station_rating_cycle[i].clear();
+	_station_rating_tick = 0;
+
+	Station *st;
+	FOR_ALL_STATIONS(st) {
+		st->rating_slot = INVALID_RATING_SLOT;
+		if (st->IsInUse()) AddStationToRatingCycle(st);
+	}
+}
+
+/** Write the position in the rating cycle of all stations on the wheel back to their delete_ctr, e.g. before saving. */
+void UpdateStationDeleteCounters()
+{
+	Station *st;
+	FOR_ALL_STATIONS(st) {
+		if (st->rating_slot == INVALID_RATING_SLOT) continue;
+		st->delete_ctr = (_station_rating_tick + STATION_RATING_TICKS - st->rating_slot) % STATION_RATING_TICKS;
+	}
 }
 
 void OnTick_Station()
@@ -3549,19 +3594,33 @@ void OnTick_Station()
 
 	RunAverages<Station>();
 
-	BaseStation *st;
-	FOR_ALL_BASE_STATIONS(st) {
-		StationHandleSmallTick(st);
-
-		/* Run 250 tick interval trigger for station animation.
-		 * Station index is included so that triggers are not all done
-		 * at the same time. */
-		if ((_tick_counter + st->index) % 250 == 0) {
-			/* Stop processing this station if it was deleted */
-			if (!StationHandleBigTick(st)) continue;
-			TriggerStationAnimation(st, st->xy, SAT_250_TICKS);
-			if (Station::IsExpected(st)) AirportAnimationTrigger(Station::From(st), AAT_STATION_250_TICKS);
+	if (++_station_rating_tick == STATION_RATING_TICKS) _station_rating_tick = 0;
+	const std::vector<StationID> &rated = _station_rating_cycle[_station_rating_tick];
+
+	/* Run 250 tick interval trigger for station animation.
+	 * Station index is included so that triggers are not all done
+	 * at the same time: a station is due if (_tick_counter + index) % 250 == 0.
+	 * The due stations of both kinds are visited in order of their index,
+	 * just like they would be by looping over all stations. */
+	size_t pool_size = BaseStation::GetPoolSize();
+	size_t big_tick = (250 - _tick_counter % 250) % 250;
+	uint i = 0;
+	while (i < rated.size() || big_tick < pool_size) {
+		size_t index = i < rated.size() ? min<size_t>(rated[i], big_tick) : big_tick;
+
+		if (i < rated.size() && rated[i] == index) {
+			UpdateStationRating(Station::Get(index));
+			i++;
 		}
+
+		if (index != big_tick) continue;
+		big_tick += 250;
+
+		BaseStation *st = BaseStation::GetIfValid(index);
+		/* Stop processing this station if it was deleted */
+		if (st == NULL || !StationHandleBigTick(st)) continue;
+		TriggerStationAnimation(st, st->xy, SAT_250_TICKS);
+		if (Station::IsExpected(st)) AirportAnimationTrigger(Station::From(st), AAT_STATION_250_TICKS);
 	}
 }
 
@@ -3611,11 +3670,10 @@ static uint UpdateStationWaiting(Station *st, CargoID type, uint amount, SourceT
 
 	StationID id = st->index;
 	StationID next = INVALID_STATION;
-	FlowStatSet &flow_stats = ge.flows[id];
-	FlowStatSet::iterator i = flow_stats.begin();
-	if (i != flow_stats.end()) {
-		next = i->Via();
-		ge.UpdateFlowStats(flow_stats, i, amount);
+	FlowStatMap::iterator flow_it = ge.flows.find(id);
+	if (flow_it != ge.flows.end()) {
+		next = flow_it->second.GetVia();
+		flow_it->second.Increase(next, amount);
 	}
 
 	ge.cargo.Append(next, new CargoPacket(st->index, st->xy, amount, source_type, source_id));
@@ -3813,6 +3871,7 @@ void BuildOilRig(TileIndex tile)
 	st->dock_tile = tile;
 	st->facilities = FACIL_AIRPORT | FACIL_DOCK;
 	st->build_date = _date;
+	AddStationToRatingCycle(st);
 
 	st->rect.BeforeAddTile(tile, StationRect::ADD_FORCE);
 
@@ -3863,6 +3922,7 @@ static void ChangeTileOwner_Station(TileIndex tile, Owner old_owner, Owner new_o
 	if (new_owner != INVALID_OWNER) {
 		/* for buoys, owner of tile is owner of water, st->owner == OWNER_NONE */
 		SetTileOwner(tile, new_owner);
+		if (HasStationRail(tile)) YapfNotifyTrackLayoutChange(tile, GetRailStationTrack(tile));
 		InvalidateWindowClassesData(WC_STATION_LIST, 0);
 	} else {
 		if (IsDriveThroughStopTile(tile)) {
@@ -3983,37 +4043,111 @@ static CommandCost TerraformTile_Station(TileIndex tile, DoCommandFlag flags, ui
 }
 
 /**
- * Update the flow stats for a specific entry.
- * @param flow_stats Flow stats to update.
- * @param flow_it Iterator pointing to an entry in flow_stats.
- * @param count Amount by which the flow should be increased.
+ * Comparator for finding a flow stat by next hop.
+ * @param flow Flow stat.
+ * @param via Next hop to look for.
+ * @return If the flow stat's next hop is lower than via.
  */
-void GoodsEntry::UpdateFlowStats(FlowStatSet &flow_stats, FlowStatSet::iterator flow_it, uint count)
+static bool CompareFlowVia(const FlowStat &flow, StationID via)
 {
-	FlowStat fs = *flow_it;
-	fs.Increase(count);
-	flow_stats.erase(flow_it);
-	flow_stats.insert(fs);
+	return flow.Via() < via;
 }
 
 /**
- * Update the flow stats for a specific next station.
- * @param flow_stats Flow stats to update.
- * @param count Amount by which the flow should be increased.
- * @param next Next hop for which the flow stats should be updated.
+ * Find the flow stat for a next hop.
+ * @param via Next hop to look for.
+ * @return Iterator to the flow stat, or the end iterator if there is none.
  */
-void GoodsEntry::UpdateFlowStats(FlowStatSet &flow_stats, uint count, StationID next)
+FlowStatSet::FlowStatVector::iterator FlowStatSet::Find(StationID via)
 {
-	FlowStatSet::iterator flow_it = flow_stats.begin();
-	while (flow_it != flow_stats.end()) {
-		StationID via = flow_it->Via();
-		if (via == next) { //usually the first one is the correct one
-			this->UpdateFlowStats(flow_stats, flow_it, count);
-			return;
-		} else {
-			++flow_it;
+	FlowStatVector::iterator i = std::lower_bound(this->flows.begin(), this->flows.end(), via, CompareFlowVia);
+	return (i != this->flows.end() && i->Via() == via) ? i : this->flows.end();
+}
+
+/**
+ * Add a flow stat. If there already is one for the same next hop the new one
+ * is added to it.
+ * @param flow Flow stat to be added.
+ */
+void FlowStatSet::Insert(const FlowStat &flow)
+{
+	FlowStatVector::iterator i = std::lower_bound(this->flows.begin(), this->flows.end(), flow.Via(), CompareFlowVia);
+	if (i != this->flows.end() && i->Via() == flow.Via()) {
+		*i += flow;
+	} else {
+		this->flows.insert(i, flow);
+	}
+}
+
+/**
+ * Remove the flow stat for a next hop, if there is one.
+ * @param via Next hop.
+ */
+void FlowStatSet::Erase(StationID via)
+{
+	FlowStatVector::iterator i = this->Find(via);
+	if (i != this->flows.end()) this->flows.erase(i);
+}
+
+/**
+ * Record that some cargo has been sent to a next hop. Nothing happens if
+ * there is no flow stat for that next hop.
+ * @param via Next hop the cargo has been sent to.
+ * @param count Amount of cargo.
+ */
+void FlowStatSet::Increase(StationID via, uint count)
+{
+	FlowStatVector::iterator i = this->Find(via);
+	if (i != this->flows.end()) i->Increase(count);
+}
+
+/**
+ * Decrease the sent figures of all flow stats using their moving averages
+ * and remove the flow stats for next hops that don't exist anymore.
+ */
+void FlowStatSet::RunAverages()
+{
+	FlowStatVector::iterator dest = this->flows.begin();
+	for (FlowStatVector::iterator i = this->flows.begin(); i != this->flows.end(); ++i) {
+		if (!Station::IsValidID(i->Via())) continue;
+		*dest = *i;
+		dest->Decrease();
+		++dest;
+	}
+	this->flows.erase(dest, this->flows.end());
+}
+
+/**
+ * Choose a next hop for some cargo. That is the one with the highest planned
+ * minus sent flow, or the highest next hop of those with the same.
+ * @return Next hop, or INVALID_STATION if there are no flows.
+ */
+StationID FlowStatSet::GetVia() const
+{
+	return this->GetVia(INVALID_STATION);
+}
+
+/**
+ * Choose a next hop for some cargo, excluding a specific station. That is the
+ * one with the highest planned minus sent flow, or the highest next hop of
+ * those with the same.
+ * @param excluded Station not to be chosen.
+ * @return Next hop, or INVALID_STATION if there is none besides excluded.
+ */
+StationID FlowStatSet::GetVia(StationID excluded) const
+{
+	StationID via = INVALID_STATION;
+	int best = 0;
+	/* The flow stats are ordered by next hop, so with ">=" the highest one wins ties. */
+	for (FlowStatVector::const_iterator i = this->flows.begin(); i != this->flows.end(); ++i) {
+		if (i->Via() == excluded) continue;
+		int diff = (int)i->Planned() - (int)i->Sent();
+		if (via == INVALID_STATION || diff >= best) {
+			via = i->Via();
+			best = diff;
 		}
 	}
+	return via;
 }
 
 /**
@@ -4024,9 +4158,9 @@ void GoodsEntry::UpdateFlowStats(FlowStatSet &flow_stats, uint count, StationID
  */
 void GoodsEntry::UpdateFlowStats(StationID source, uint count, StationID next)
 {
-	if (source == INVALID_STATION || next == INVALID_STATION || this->flows.empty()) return;
-	FlowStatSet &flow_stats = this->flows[source];
-	this->UpdateFlowStats(flow_stats, count, next);
+	if (source == INVALID_STATION || next == INVALID_STATION) return;
+	FlowStatMap::iterator flow_it = this->flows.find(source);
+	if (flow_it != this->flows.end()) flow_it->second.Increase(next, count);
 }
 
 /**
@@ -4038,19 +4172,12 @@ void GoodsEntry::UpdateFlowStats(StationID source, uint count, StationID next)
  */
 StationID GoodsEntry::UpdateFlowStatsTransfer(StationID source, uint count, StationID curr)
 {
-	if (source == INVALID_STATION || this->flows.empty()) return INVALID_STATION;
-	FlowStatSet &flow_stats = this->flows[source];
-	FlowStatSet::iterator flow_it = flow_stats.begin();
-	while (flow_it != flow_stats.end()) {
-		StationID via = flow_it->Via();
-		if (via != curr) {
-			this->UpdateFlowStats(flow_stats, flow_it, count);
-			return via;
-		} else {
-			++flow_it;
-		}
-	}
-	return INVALID_STATION;
+	if (source == INVALID_STATION) return INVALID_STATION;
+	FlowStatMap::iterator flow_it = this->flows.find(source);
+	if (flow_it == this->flows.end()) return INVALID_STATION;
+	StationID via = flow_it->second.GetVia(curr);
+	if (via != INVALID_STATION) flow_it->second.Increase(via, count);
+	return via;
 }
 
 /**
@@ -57,4 +57,9 @@ void IncreaseStats(Station *st, const Vehicle *v, StationID next_station_id, boo
 
 void DeleteStaleFlows(StationID at, CargoID c_id, StationID to);
 
+void AddStationToRatingCycle(Station *st);
+void RemoveStationFromRatingCycle(Station *st);
+void RebuildStationRatingCycle();
+void UpdateStationDeleteCounters();
+
 #endif /* STATION_FUNC_H */
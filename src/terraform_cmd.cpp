@@ -19,6 +19,8 @@
 #include "object_base.h"
 #include "company_base.h"
 #include "company_func.h"
+#include "pathfinder/yapf/yapf_cache.h"
+#include "pathfinder/water_regions.h"
 
 #include "table/strings.h"
 
@@ -372,6 +374,10 @@ CommandCost CmdTerraformLand(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 			TileIndex *ti = ts.tile_table;
 			for (count = ts.tile_table_count; count != 0; count--, ti++) {
 				MarkTileDirtyByTile(*ti);
+				/* Roads may be kept on the changed slopes, so their costs for road vehicles change. */
+				if (IsTileType(*ti, MP_ROAD) || IsTileType(*ti, MP_STATION) || IsTileType(*ti, MP_TUNNELBRIDGE)) YapfNotifyRoadLayoutChange(*ti);
+				/* Shores and half tile rails may be kept too, but ships sail differently on them. */
+				InvalidateWaterRegion(*ti);
 			}
 		}
 
@@ -83,4 +83,10 @@ public:
 	virtual void SendSignal() = 0;
 };
 
+/**
+ * Get the number of processor cores available to this process.
+ * @return The number of cores, at least 1.
+ */
+uint GetCPUCoreCount();
+
 #endif /* THREAD_H */
@@ -197,3 +197,8 @@ private:
 	if (thread != NULL) *thread = to;
 	return true;
 }
+
+uint GetCPUCoreCount()
+{
+	return 1;
+}
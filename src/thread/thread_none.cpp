@@ -31,3 +31,8 @@ public:
 {
 	return new ThreadMutex_None();
 }
+
+uint GetCPUCoreCount()
+{
+	return 1;
+}
@@ -136,3 +136,8 @@ public:
 {
 	return new ThreadMutex_OS2();
 }
+
+uint GetCPUCoreCount()
+{
+	return 1;
+}
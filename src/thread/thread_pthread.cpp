@@ -13,6 +13,7 @@
 #include "thread.h"
 #include <pthread.h>
 #include <errno.h>
+#include <unistd.h>
 
 /**
  * POSIX pthread version for ThreadObject.
@@ -145,3 +146,9 @@ public:
 {
 	return new ThreadMutex_pthread();
 }
+
+uint GetCPUCoreCount()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint)count : 1;
+}
@@ -149,3 +149,10 @@ public:
 {
 	return new ThreadMutex_Win32();
 }
+
+uint GetCPUCoreCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (uint)info.dwNumberOfProcessors : 1;
+}
@@ -0,0 +1,206 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_pool.cpp Implementation of the worker thread pool. */
+
+#include "../stdafx.h"
+#include "worker_pool.h"
+#include <algorithm>
+
+extern uint64 ottd_rdtsc();
+
+/**
+ * Create a task.
+ * @param proc Function to be called when the task is executed.
+ * @param param Parameter to be passed to proc.
+ */
+WorkerTask::WorkerTask(OTTDThreadFunc proc, void *param) :
+	proc(proc), param(param), state(WTS_IDLE), finished(false),
+	done_mutex(ThreadMutex::New()), enqueue_time(0), start_time(0), finish_time(0)
+{}
+
+/**
+ * Create a task doing the same as another one. The other task must not be
+ * queued or running.
+ * @param other Task to be copied.
+ */
+WorkerTask::WorkerTask(const WorkerTask &other) :
+	proc(other.proc), param(other.param), state(WTS_IDLE), finished(false),
+	done_mutex(ThreadMutex::New()), enqueue_time(0), start_time(0), finish_time(0)
+{
+	assert(other.state == WTS_IDLE);
+}
+
+/**
+ * Destroy a task. It must not be queued or running anymore.
+ */
+WorkerTask::~WorkerTask()
+{
+	assert(this->state == WTS_IDLE);
+	delete this->done_mutex;
+}
+
+/**
+ * Create a pool without any threads.
+ */
+WorkerPool::WorkerPool() :
+	queue_mutex(ThreadMutex::New()),
+	exit(false)
+{}
+
+/**
+ * Stop all threads and destroy the pool.
+ */
+WorkerPool::~WorkerPool()
+{
+	this->Stop();
+	delete this->queue_mutex;
+}
+
+/**
+ * Start the given number of worker threads. Running threads are stopped
+ * first. If the threads can't be created the pool continues with as many as
+ * could be started, possibly none.
+ * @param num_threads Number of threads to start.
+ */
+void WorkerPool::Start(uint num_threads)
+{
+	this->Stop();
+	for (uint i = 0; i < num_threads; ++i) {
+		ThreadObject *thread = NULL;
+		if (!ThreadObject::New(&WorkerPool::WorkerThreadProc, this, &thread)) break;
+		this->threads.push_back(thread);
+	}
+}
+
+/**
+ * Stop all worker threads. Tasks that are still queued stay queued and will
+ * be executed by the thread waiting for them.
+ */
+void WorkerPool::Stop()
+{
+	if (this->threads.empty()) return;
+
+	this->queue_mutex->BeginCritical();
+	this->exit = true;
+	this->queue_mutex->SendSignal();
+	this->queue_mutex->EndCritical();
+
+	for (ThreadVector::iterator i = this->threads.begin(); i != this->threads.end(); ++i) {
+		(*i)->Join();
+		delete *i;
+	}
+	this->threads.clear();
+	this->exit = false;
+}
+
+/**
+ * Queue a task for execution. If there are no worker threads the task is
+ * executed right away.
+ * @param task Task to be queued. It must not be queued already.
+ */
+void WorkerPool::Enqueue(WorkerTask *task)
+{
+	assert(task->state == WorkerTask::WTS_IDLE);
+	task->finished = false;
+	task->enqueue_time = ottd_rdtsc();
+
+	if (this->threads.empty()) {
+		task->state = WorkerTask::WTS_RUNNING;
+		this->Execute(task);
+		return;
+	}
+
+	this->queue_mutex->BeginCritical();
+	task->state = WorkerTask::WTS_QUEUED;
+	this->queue.push_back(task);
+	this->queue_mutex->SendSignal();
+	this->queue_mutex->EndCritical();
+}
+
+/**
+ * Wait until the given task has finished. If no worker has picked it up yet
+ * the task is taken out of the queue and executed in the calling thread
+ * instead of waiting for a worker to become free.
+ * @param task Task to wait for.
+ */
+void WorkerPool::Wait(WorkerTask *task)
+{
+	this->queue_mutex->BeginCritical();
+	WorkerTask::State state = task->state;
+	if (state == WorkerTask::WTS_QUEUED) {
+		this->queue.erase(std::find(this->queue.begin(), this->queue.end(), task));
+		task->state = WorkerTask::WTS_RUNNING;
+	}
+	this->queue_mutex->EndCritical();
+
+	if (state == WorkerTask::WTS_IDLE) return;
+	if (state == WorkerTask::WTS_QUEUED) {
+		this->Execute(task);
+	} else {
+		task->done_mutex->BeginCritical();
+		while (!task->finished) task->done_mutex->WaitForSignal();
+		task->done_mutex->EndCritical();
+	}
+
+	task->state = WorkerTask::WTS_IDLE;
+}
+
+/**
+ * Run a task and signal its completion.
+ * @param task Task to be run.
+ */
+void WorkerPool::Execute(WorkerTask *task)
+{
+	task->start_time = ottd_rdtsc();
+	task->proc(task->param);
+	task->finish_time = ottd_rdtsc();
+
+	task->done_mutex->BeginCritical();
+	task->finished = true;
+	task->done_mutex->SendSignal();
+	task->done_mutex->EndCritical();
+}
+
+/**
+ * Entry point of the worker threads.
+ * @param pool Pool the thread is working for.
+ */
+/* static */ void WorkerPool::WorkerThreadProc(void *pool)
+{
+	((WorkerPool *)pool)->WorkerLoop();
+}
+
+/**
+ * Take tasks from the queue and execute them until the pool is stopped.
+ */
+void WorkerPool::WorkerLoop()
+{
+	this->queue_mutex->BeginCritical();
+	for (;;) {
+		while (this->queue.empty() && !this->exit) this->queue_mutex->WaitForSignal();
+		if (this->exit) break;
+
+		WorkerTask *task = this->queue.front();
+		this->queue.pop_front();
+		task->state = WorkerTask::WTS_RUNNING;
+
+		/* Some mutex implementations only remember a single signal. Pass it
+		 * on so that another worker picks up the remaining tasks. */
+		if (!this->queue.empty()) this->queue_mutex->SendSignal();
+		this->queue_mutex->EndCritical();
+
+		this->Execute(task);
+
+		this->queue_mutex->BeginCritical();
+	}
+	/* Wake up the next worker so that it can exit, too. */
+	this->queue_mutex->SendSignal();
+	this->queue_mutex->EndCritical();
+}
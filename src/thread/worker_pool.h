@@ -0,0 +1,101 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_pool.h A fixed set of persistent threads working off a shared task queue. */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "thread.h"
+#include <deque>
+#include <vector>
+
+/**
+ * A unit of work to be executed by a WorkerPool. The task doesn't own its
+ * parameter. Both have to stay valid until the task has been waited for.
+ */
+class WorkerTask {
+public:
+	WorkerTask(OTTDThreadFunc proc, void *param);
+	WorkerTask(const WorkerTask &other);
+	~WorkerTask();
+
+	/**
+	 * Get the time the task spent waiting in the queue before it was started.
+	 * @return Waiting time in CPU cycles.
+	 */
+	FORCEINLINE uint64 GetQueueTime() const {return this->start_time - this->enqueue_time;}
+
+	/**
+	 * Get the time the task took to execute.
+	 * @return Running time in CPU cycles.
+	 */
+	FORCEINLINE uint64 GetRunTime() const {return this->finish_time - this->start_time;}
+
+private:
+	friend class WorkerPool;
+
+	/** Life cycle of a task. */
+	enum State {
+		WTS_IDLE,    ///< Not queued or already waited for.
+		WTS_QUEUED,  ///< Waiting in the queue.
+		WTS_RUNNING, ///< Taken from the queue and being executed.
+	};
+
+	OTTDThreadFunc proc; ///< Function to be executed.
+	void *param;         ///< Parameter for proc.
+	State state;         ///< Current state, protected by the queue mutex of the pool.
+	bool finished;       ///< If the task has finished, protected by done_mutex.
+	ThreadMutex *done_mutex; ///< Mutex used to signal that the task has finished.
+	uint64 enqueue_time; ///< Time the task was queued.
+	uint64 start_time;   ///< Time the task was started.
+	uint64 finish_time;  ///< Time the task finished.
+
+	WorkerTask &operator=(const WorkerTask &other);
+};
+
+/**
+ * A pool of worker threads executing WorkerTasks in the order they were queued.
+ * The threads are kept alive between tasks so that queueing a task is cheap.
+ * If no threads could be started tasks are executed right away in the thread
+ * queueing them. Tasks may queue and wait for further tasks themselves.
+ * @note Only one thread may wait for any given task.
+ */
+class WorkerPool {
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	void Start(uint num_threads);
+	void Stop();
+
+	void Enqueue(WorkerTask *task);
+	void Wait(WorkerTask *task);
+
+	/**
+	 * Get the number of threads working for this pool.
+	 * @return Number of threads; 0 if tasks are run synchronously.
+	 */
+	FORCEINLINE uint GetNumThreads() const {return (uint)this->threads.size();}
+
+private:
+	typedef std::deque<WorkerTask *> TaskQueue;
+	typedef std::vector<ThreadObject *> ThreadVector;
+
+	ThreadMutex *queue_mutex; ///< Mutex protecting the queue, the exit flag and the task states.
+	TaskQueue queue;          ///< Tasks waiting to be executed.
+	ThreadVector threads;     ///< Threads working for this pool.
+	bool exit;                ///< If the threads should exit.
+
+	static void WorkerThreadProc(void *pool);
+	void WorkerLoop();
+	void Execute(WorkerTask *task);
+};
+
+#endif /* WORKER_POOL_H */
@@ -0,0 +1,207 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file tick_benchmark.cpp Running a savegame for a fixed number of ticks from the command line. */
+
+#include "stdafx.h"
+#include "openttd.h"
+#include "map_func.h"
+#include "company_base.h"
+#include "vehicle_base.h"
+#include "station_base.h"
+#include "town.h"
+#include "core/random_func.hpp"
+#include "core/sort_func.hpp"
+#include "fios.h"
+#include "tick_benchmark.h"
+
+#if defined(UNIX)
+#	include <sys/resource.h>
+#endif
+
+extern uint64 ottd_microseconds();
+extern void SwitchToMode(SwitchMode new_mode);
+extern void StateGameLoop();
+
+/**
+ * Get the largest amount of memory the process had in use at any time.
+ * @return The peak resident set size in kilobytes, or 0 if it is not known on this system.
+ */
+static uint64 GetPeakMemoryUsage()
+{
+#if defined(UNIX) && !defined(__MORPHOS__) && !defined(__AMIGA__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+	/* OSX reports bytes, everybody else kilobytes. */
+	return (uint64)usage.ru_maxrss / 1024;
+#else
+	return (uint64)usage.ru_maxrss;
+#endif
+#else
+	return 0;
+#endif
+}
+
+/** FNV-1a hash over the parts of the game state a benchmark may change. */
+struct StateChecksum {
+	uint32 hash; ///< Hash of everything added so far.
+
+	StateChecksum() : hash(2166136261U) {}
+
+	/**
+	 * Add some bytes to the checksum.
+	 * @param data Bytes to add.
+	 * @param size Number of bytes.
+	 */
+	void Add(const void *data, size_t size)
+	{
+		const byte *b = (const byte *)data;
+		for (size_t i = 0; i < size; i++) {
+			this->hash = (this->hash ^ b[i]) * 16777619U;
+		}
+	}
+
+	/**
+	 * Add a value to the checksum.
+	 * @param value Value to add.
+	 */
+	template <typename T>
+	void Add(T value)
+	{
+		this->Add(&value, sizeof(value));
+	}
+};
+
+/**
+ * Calculate a checksum of the game state, so runs of different builds or
+ * settings can be checked to have ended in the same state.
+ * @return The checksum.
+ */
+static uint32 GetStateChecksum()
+{
+	StateChecksum sum;
+	sum.Add(_m, sizeof(Tile) * MapSize());
+	sum.Add(_me, sizeof(TileExtended) * MapSize());
+	sum.Add(_random.state[0]);
+	sum.Add(_random.state[1]);
+
+	const Company *c;
+	FOR_ALL_COMPANIES(c) {
+		sum.Add(c->index);
+		sum.Add((int64)c->money);
+	}
+
+	const Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		sum.Add(v->index);
+		sum.Add(v->tile);
+		sum.Add(v->x_pos);
+		sum.Add(v->y_pos);
+		sum.Add(v->z_pos);
+		sum.Add(v->cur_speed);
+		sum.Add(v->cargo.Count());
+	}
+
+	const Station *st;
+	FOR_ALL_STATIONS(st) {
+		sum.Add(st->index);
+		for (CargoID cargo = 0; cargo < NUM_CARGO; cargo++) {
+			sum.Add(st->goods[cargo].cargo.Count());
+			sum.Add(st->goods[cargo].rating);
+		}
+	}
+
+	const Town *t;
+	FOR_ALL_TOWNS(t) {
+		sum.Add(t->index);
+		sum.Add(t->population);
+	}
+
+	return sum.hash;
+}
+
+/**
+ * Compare two tick times for sorting them ascending.
+ * @param a First time.
+ * @param b Second time.
+ * @return Less than, equal to or greater than zero if a is smaller than, equal to or larger than b.
+ */
+static int CDECL CompareBenchmarkTimes(const uint32 *a, const uint32 *b)
+{
+	return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+/**
+ * Print a time as milliseconds.
+ * @param name What the time is of.
+ * @param us The time in microseconds.
+ */
+static void PrintBenchmarkTime(const char *name, uint64 us)
+{
+	printf("  %-8s %3u.%03u ms/tick\n", name, (uint)(us / 1000), (uint)(us % 1000));
+}
+
+/** Load the game selected with -g to run a benchmark on it; quit if that fails. */
+void LoadBenchmarkSavegame()
+{
+	if (_switch_mode != SM_LOAD) usererror("A benchmark needs a savegame to run; select one with -g.");
+	_switch_mode = SM_NONE;
+	SwitchToMode(SM_LOAD);
+	if (_game_mode != GM_NORMAL) usererror("Failed to load savegame '%s' for the benchmark.", _file_to_saveload.name);
+}
+
+/**
+ * Load the game selected with -g and run it for a number of ticks as fast
+ * as possible, without any frame pacing or drawing. Afterwards print how
+ * long the ticks took, the peak memory usage and a checksum of the state.
+ * @param ticks Number of ticks to run.
+ */
+void RunTickBenchmark(uint ticks)
+{
+	assert(ticks > 0);
+
+	LoadBenchmarkSavegame();
+	if (_pause_mode != PM_UNPAUSED) {
+		printf("The savegame is paused; unpausing it for the benchmark.\n");
+		_pause_mode = PM_UNPAUSED;
+	}
+
+	printf("Running %u ticks of '%s' with %u vehicles\n", ticks, _file_to_saveload.name, (uint)Vehicle::GetNumItems());
+
+	uint32 *times = MallocT<uint32>(ticks);
+	uint64 start = ottd_microseconds();
+	uint64 last = start;
+	for (uint i = 0; i < ticks; i++) {
+		StateGameLoop();
+		uint64 now = ottd_microseconds();
+		times[i] = (uint32)min<uint64>(now - last, UINT32_MAX);
+		last = now;
+	}
+	uint64 total = last - start;
+
+	QSortT(times, ticks, &CompareBenchmarkTimes);
+	printf("Ran %u ticks in %u.%03u s\n", ticks, (uint)(total / 1000000), (uint)(total / 1000 % 1000));
+	PrintBenchmarkTime("avg", total / ticks);
+	PrintBenchmarkTime("min", times[0]);
+	PrintBenchmarkTime("p50", times[ticks / 2]);
+	PrintBenchmarkTime("p90", times[ticks * 90 / 100]);
+	PrintBenchmarkTime("p99", times[ticks * 99 / 100]);
+	PrintBenchmarkTime("max", times[ticks - 1]);
+	free(times);
+
+	uint64 peak = GetPeakMemoryUsage();
+	if (peak != 0) {
+		printf("Peak memory usage: " OTTD_PRINTF64 " kB\n", peak);
+	} else {
+		printf("Peak memory usage: unknown\n");
+	}
+	printf("State checksum: %08X\n", GetStateChecksum());
+	fflush(stdout);
+}
@@ -0,0 +1,132 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file tick_profile.cpp Keeping the measurements of the last ticks and calculating statistics over them. */
+
+#include "stdafx.h"
+#include "core/math_func.hpp"
+#include "core/mem_func.hpp"
+#include "tick_profile.h"
+
+#include <algorithm>
+
+assert_compile(TPS_DISASTERS - TPS_TRAINS == VEH_DISASTER - VEH_TRAIN);
+
+/** Name and nesting depth of a section. */
+struct TickProfileSectionInfo {
+	const char *name; ///< Name used in the output.
+	uint depth;       ///< Number of sections it is part of.
+};
+
+/** Names and depths of all sections. */
+static const TickProfileSectionInfo _section_info[] = {
+	{"game loop",       0},
+	{"tile loop",       1},
+	{"vehicles",        1},
+	{"trains",          2},
+	{"road vehicles",   2},
+	{"ships",           2},
+	{"aircraft",        2},
+	{"effect vehicles", 2},
+	{"disasters",       2},
+	{"landscape",       1},
+	{"towns",           2},
+	{"trees",           2},
+	{"stations",        2},
+	{"industries",      2},
+	{"companies",       2},
+	{"link graph",      2},
+	{"link graph join", 3},
+	{"ai",              1},
+	{"windows",         0},
+	{"drawing",         1},
+};
+assert_compile(lengthof(_section_info) == TPS_END);
+
+uint64 _tick_profile_current[TPS_END]; ///< Measurements of the running tick.
+
+static uint64 _tick_profile_history[TPS_END][TICK_PROFILE_HISTORY]; ///< Measurements of the last ticks.
+static uint _tick_profile_next = 0;    ///< Position in the history the next tick is stored at.
+static uint _tick_profile_samples = 0; ///< Number of ticks in the history.
+
+/**
+ * Finish the measurements of the running tick.
+ * @param record Whether to store the measurements in the history or to
+ *               throw them away, e.g. because the game is paused.
+ */
+void FinishTickProfile(bool record)
+{
+	if (record) {
+		for (uint i = 0; i < TPS_END; i++) {
+			_tick_profile_history[i][_tick_profile_next] = _tick_profile_current[i];
+		}
+		_tick_profile_next = (_tick_profile_next + 1) % TICK_PROFILE_HISTORY;
+		_tick_profile_samples = min(_tick_profile_samples + 1, TICK_PROFILE_HISTORY);
+	}
+	MemSetT(_tick_profile_current, 0, TPS_END);
+}
+
+/** Forget the measurements of all ticks. */
+void ResetTickProfile()
+{
+	MemSetT(_tick_profile_current, 0, TPS_END);
+	_tick_profile_next = 0;
+	_tick_profile_samples = 0;
+}
+
+/**
+ * Calculate the statistics of a section over the last ticks.
+ * @param section Section to get the statistics of.
+ * @param stats Statistics to fill in.
+ * @return Number of ticks the statistics are taken over; 0 if there are no measurements yet.
+ */
+uint GetTickProfileStats(TickProfileSection section, TickProfileStats *stats)
+{
+	MemSetT(stats, 0);
+	if (_tick_profile_samples == 0) return 0;
+
+	/* The history is only filled from the start until it wraps around for the first time. */
+	uint64 samples[TICK_PROFILE_HISTORY];
+	MemCpyT(samples, _tick_profile_history[section], _tick_profile_samples);
+
+	uint64 sum = 0;
+	stats->min_cycles = UINT64_MAX;
+	for (uint i = 0; i < _tick_profile_samples; i++) {
+		sum += samples[i];
+		stats->min_cycles = min(stats->min_cycles, samples[i]);
+		stats->max_cycles = max(stats->max_cycles, samples[i]);
+	}
+	stats->avg_cycles = sum / _tick_profile_samples;
+
+	uint64 *p99 = samples + _tick_profile_samples * 99 / 100;
+	std::nth_element(samples, p99, samples + _tick_profile_samples);
+	stats->p99_cycles = *p99;
+
+	return _tick_profile_samples;
+}
+
+/**
+ * Get the name of a section.
+ * @param section The section.
+ * @return Name of the section.
+ */
+const char *GetTickProfileSectionName(TickProfileSection section)
+{
+	return _section_info[section].name;
+}
+
+/**
+ * Get the number of sections a section is part of.
+ * @param section The section.
+ * @return Nesting depth of the section.
+ */
+uint GetTickProfileSectionDepth(TickProfileSection section)
+{
+	return _section_info[section].depth;
+}
@@ -0,0 +1,97 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file tick_profile.h Measuring how long the parts of a game tick take. */
+
+#ifndef TICK_PROFILE_H
+#define TICK_PROFILE_H
+
+#include "core/enum_type.hpp"
+#include "vehicle_type.h"
+
+extern uint64 ottd_rdtsc();
+
+/**
+ * Parts of a tick which are measured. Sections are nested; the time of a
+ * section includes the time of the sections following it with a larger depth.
+ */
+enum TickProfileSection {
+	TPS_GAME_LOOP,      ///< The whole state game loop.
+	TPS_TILE_LOOP,      ///< RunTileLoop.
+	TPS_VEHICLES,       ///< CallVehicleTicks.
+	TPS_TRAINS,         ///< Ticks of trains.
+	TPS_ROADVEHS,       ///< Ticks of road vehicles.
+	TPS_SHIPS,          ///< Ticks of ships.
+	TPS_AIRCRAFT,       ///< Ticks of aircraft.
+	TPS_EFFECTVEHS,     ///< Ticks of effect vehicles.
+	TPS_DISASTERS,      ///< Ticks of disaster vehicles.
+	TPS_LANDSCAPE,      ///< CallLandscapeTick.
+	TPS_TOWNS,          ///< OnTick_Town.
+	TPS_TREES,          ///< OnTick_Trees.
+	TPS_STATIONS,       ///< OnTick_Station.
+	TPS_INDUSTRIES,     ///< OnTick_Industry.
+	TPS_COMPANIES,      ///< OnTick_Companies.
+	TPS_LINKGRAPH,      ///< OnTick_LinkGraph.
+	TPS_LINKGRAPH_JOIN, ///< Joining the link graph jobs.
+	TPS_AI,             ///< AI::GameLoop.
+	TPS_WINDOWS,        ///< UpdateWindows since the previous tick.
+	TPS_DRAWING,        ///< DrawDirtyBlocks since the previous tick.
+	TPS_END,
+};
+DECLARE_POSTFIX_INCREMENT(TickProfileSection)
+
+/** Number of ticks the statistics are kept over. */
+static const uint TICK_PROFILE_HISTORY = 512;
+
+/** Statistics of a section over the last ticks, in CPU cycles per tick. */
+struct TickProfileStats {
+	uint64 min_cycles; ///< Fastest tick.
+	uint64 avg_cycles; ///< Average of all ticks.
+	uint64 max_cycles; ///< Slowest tick.
+	uint64 p99_cycles; ///< 99th percentile.
+};
+
+extern uint64 _tick_profile_current[TPS_END];
+
+/** Adds the time between its construction and destruction to a section of the current tick. */
+class TickProfileTimer {
+	TickProfileSection section; ///< Section the time is added to.
+	uint64 start;               ///< Time of construction.
+
+public:
+	/**
+	 * Start measuring a section.
+	 * @param section Section to measure.
+	 */
+	FORCEINLINE TickProfileTimer(TickProfileSection section) : section(section), start(ottd_rdtsc()) {}
+
+	/** Stop measuring and add the time to the section. */
+	FORCEINLINE ~TickProfileTimer()
+	{
+		_tick_profile_current[this->section] += ottd_rdtsc() - this->start;
+	}
+};
+
+/**
+ * Get the section the ticks of a type of vehicle are measured in.
+ * @param type Type of the vehicles.
+ * @return The section.
+ */
+static FORCEINLINE TickProfileSection GetVehicleTickProfileSection(VehicleType type)
+{
+	return (TickProfileSection)(TPS_TRAINS + type);
+}
+
+void FinishTickProfile(bool record);
+void ResetTickProfile();
+uint GetTickProfileStats(TickProfileSection section, TickProfileStats *stats);
+const char *GetTickProfileSectionName(TickProfileSection section);
+uint GetTickProfileSectionDepth(TickProfileSection section);
+
+#endif /* TICK_PROFILE_H */
@@ -64,6 +64,43 @@ struct TrainCache {
 	int cached_max_curve_speed; ///< max consist speed limited by curves
 };
 
+/**
+ * Speed calculation of a front engine made in advance in the plan phase of
+ * the vehicle tick, see CallVehicleTicks(). The plan is only used if the train
+ * is still in the state it was made for when it updates its speed; anything
+ * the train did in its own tick before that invalidates the plan.
+ */
+struct TrainSpeedPlan {
+	uint32 epoch;                ///< Vehicle tick the plan was made in, see _vehicle_tick_epoch.
+	int acceleration;            ///< Planned result of GetAcceleration().
+	int max_speed;               ///< Planned result of GetCurrentMaxSpeed().
+
+	/* State of the train the plan was made for. */
+	TileIndex tile;              ///< Tile of the front engine.
+	int32 x_pos;                 ///< X position of the front engine.
+	int32 y_pos;                 ///< Y position of the front engine.
+	uint32 order;                ///< Packed current order.
+	uint32 weight;               ///< Cached weight of the consist.
+	uint32 power;                ///< Cached power of the consist.
+	uint32 max_te;               ///< Cached maximum tractive effort of the consist.
+	uint32 air_drag;             ///< Cached air drag coefficient of the consist.
+	int max_curve_speed;         ///< Cached curve speed limit of the consist.
+	uint16 cur_speed;            ///< Current speed.
+	uint16 flags;                ///< Rail vehicle flags.
+	uint16 gv_flags;             ///< Ground vehicle flags.
+	uint16 axle_resistance;      ///< Cached axle resistance of the consist.
+	uint16 max_track_speed;      ///< Cached track speed limit of the consist.
+	uint16 total_length;         ///< Cached length of the consist.
+	StationID last_station_visited; ///< Last station visited.
+	byte vehstatus;              ///< Vehicle status.
+	byte direction;              ///< Direction of the front engine.
+	byte track;                  ///< Track of the front engine.
+	byte railtype;               ///< Rail type of the front engine.
+
+	void Record(const Train *v);
+	bool Matches(const Train *v) const;
+};
+
 /**
  * 'Train' is either a loco or a wagon.
  */
@@ -84,6 +121,8 @@ struct Train : public GroundVehicle<Train, VEH_TRAIN> {
 	/** Ticks waiting in front of a signal, ticks being stuck or a counter for forced proceeding through signals. */
 	uint16 wait_counter;
 
+	TrainSpeedPlan speed_plan; ///< Speed calculation made in the plan phase of the vehicle tick; not saved.
+
 	/** We don't want GCC to zero our struct! It already is zeroed and has an index! */
 	Train() : GroundVehicleBase() {}
 	/** We want to 'destruct' the right class. */
@@ -118,6 +157,7 @@ struct Train : public GroundVehicle<Train, VEH_TRAIN> {
 
 	void RailtypeChanged();
 
+	void PlanSpeed();
 	int UpdateSpeed();
 
 	void UpdateAcceleration();
@@ -182,13 +222,22 @@ protected: // These functions should not be called outside acceleration code.
 		return 0;
 	}
 
+	/**
+	 * Allows to know the weight of the cargo in this vehicle.
+	 * @return Weight of the cargo in tonnes.
+	 */
+	FORCEINLINE uint16 GetCargoWeight() const
+	{
+		return (CargoSpec::Get(this->cargo_type)->weight * this->cargo.Count() * FreightWagonMult(this->cargo_type)) / 16;
+	}
+
 	/**
 	 * Allows to know the weight value that this vehicle will use.
 	 * @return Weight value from the engine in tonnes.
 	 */
 	FORCEINLINE uint16 GetWeight() const
 	{
-		uint16 weight = (CargoSpec::Get(this->cargo_type)->weight * this->cargo.Count() * FreightWagonMult(this->cargo_type)) / 16;
+		uint16 weight = this->GetCargoWeight();
 
 		/* Vehicle weight is not added for articulated parts. */
 		if (!this->IsArticulatedPart()) {
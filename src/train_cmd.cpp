@@ -15,6 +15,8 @@
 #include "command_func.h"
 #include "pathfinder/npf/npf_func.h"
 #include "pathfinder/yapf/yapf.hpp"
+#include "pathfinder/network_components.h"
+#include "pathfinder/pf_query_log.h"
 #include "news_func.h"
 #include "company_func.h"
 #include "vehicle_gui.h"
@@ -1175,6 +1177,12 @@ CommandCost CmdMoveRailVehicle(TileIndex tile, DoCommandFlag flags, uint32 p1, u
 	/* Check if all vehicles in the destination train are stopped inside a depot. */
 	if (dst_head != NULL && !dst_head->IsStoppedInDepot()) return_cmd_error(STR_ERROR_TRAINS_CAN_ONLY_BE_ALTERED_INSIDE_A_DEPOT);
 
+	/* Parked trains may sleep; catch up before their parts end up in other chains. */
+	if (flags & DC_EXEC) {
+		WakeVehicle(src_head);
+		if (dst_head != NULL) WakeVehicle(dst_head);
+	}
+
 	/* First make a backup of the order of the trains. That way we can do
 	 * whatever we want with the order and later on easily revert. */
 	TrainList original_src;
@@ -1310,6 +1318,9 @@ CommandCost CmdSellRailWagon(DoCommandFlag flags, Vehicle *t, uint16 data, uint3
 
 	if (v->IsRearDualheaded()) return_cmd_error(STR_ERROR_REAR_ENGINE_FOLLOW_FRONT);
 
+	/* The remaining parts may become new chains, which must not be left sleeping. */
+	if (flags & DC_EXEC) WakeVehicle(first);
+
 	/* First make a backup of the order of the train. That way we can do
 	 * whatever we want with the order and later on easily revert. */
 	TrainList original;
@@ -1830,6 +1841,8 @@ CommandCost CmdReverseTrainDirection(TileIndex tile, DoCommandFlag flags, uint32
 				}
 			}
 
+			WakeVehicle(v);
+
 			/* We cancel any 'skip signal at dangers' here */
 			v->force_proceed = TFP_NONE;
 			SetWindowDirty(WC_VEHICLE_VIEW, v->index);
@@ -1871,6 +1884,7 @@ CommandCost CmdForceTrainProceed(TileIndex tile, DoCommandFlag flags, uint32 p1,
 		 * to proceed to the next signal. In the other cases we
 		 * would like to pass the signal at danger and run till the
 		 * next signal we encounter. */
+		WakeVehicle(t);
 		t->force_proceed = t->force_proceed == TFP_SIGNAL ? TFP_NONE : HasBit(t->flags, VRF_TRAIN_STUCK) || t->IsInDepot() ? TFP_STUCK : TFP_SIGNAL;
 		SetWindowDirty(WC_VEHICLE_VIEW, t->index);
 	}
@@ -2166,12 +2180,25 @@ static const byte _initial_tile_subcoord[6][4][3] = {
  */
 static Track DoTrainPathfind(const Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, bool &path_found, bool do_track_reservation, PBSTileInfo *dest)
 {
+	/* Don't search the whole network for a destination in another part of it. */
+	if (IsVehicleDestinationUnreachable(v, tile)) {
+		path_found = false;
+		if (dest != NULL) dest->tile = INVALID_TILE;
+		return FindFirstTrack(tracks);
+	}
+
+	/* The search starts at the end of the current reservation. */
+	PBSTileInfo origin = FollowTrainReservation(v);
+
+	Track track;
 	switch (_settings_game.pf.pathfinder_for_trains) {
-		case VPF_NPF: return NPFTrainChooseTrack(v, tile, enterdir, tracks, path_found, do_track_reservation, dest);
-		case VPF_YAPF: return YapfTrainChooseTrack(v, tile, enterdir, tracks, path_found, do_track_reservation, dest);
+		case VPF_NPF: track = NPFTrainChooseTrack(v, tile, enterdir, tracks, path_found, do_track_reservation, dest, origin); break;
+		case VPF_YAPF: track = YapfTrainChooseTrack(v, tile, enterdir, tracks, path_found, do_track_reservation, dest, origin); break;
 
 		default: NOT_REACHED();
 	}
+	RecordPathfinderQuery(v, tile, enterdir, tracks, origin.tile, origin.trackdir, do_track_reservation, track, path_found);
+	return track;
 }
 
 /**
@@ -2623,10 +2650,93 @@ void Train::MarkDirty()
 	} while ((v = v->Next()) != NULL);
 
 	/* need to update acceleration and cached values since the goods on the train changed. */
-	this->CargoChanged();
+	this->CargoAmountChanged();
 	this->UpdateAcceleration();
 }
 
+/**
+ * Remember the state of a train a speed plan is made for.
+ * @param v Front engine of the train.
+ */
+void TrainSpeedPlan::Record(const Train *v)
+{
+	this->tile = v->tile;
+	this->x_pos = v->x_pos;
+	this->y_pos = v->y_pos;
+	this->order = v->current_order.Pack();
+	this->weight = v->gcache.cached_weight;
+	this->power = v->gcache.cached_power;
+	this->max_te = v->gcache.cached_max_te;
+	this->air_drag = v->gcache.cached_air_drag;
+	this->max_curve_speed = v->tcache.cached_max_curve_speed;
+	this->cur_speed = v->cur_speed;
+	this->flags = v->flags;
+	this->gv_flags = v->gv_flags;
+	this->axle_resistance = v->gcache.cached_axle_resistance;
+	this->max_track_speed = v->gcache.cached_max_track_speed;
+	this->total_length = v->gcache.cached_total_length;
+	this->last_station_visited = v->last_station_visited;
+	this->vehstatus = v->vehstatus;
+	this->direction = v->direction;
+	this->track = v->track;
+	this->railtype = v->railtype;
+}
+
+/**
+ * Check whether a train is still in the state a speed plan was made for.
+ * The positions of the other vehicles of the consist aren't compared as they
+ * only change when the front engine moves, too.
+ * @param v Front engine of the train.
+ * @return True if the plan was made in this vehicle tick and the train didn't change since.
+ */
+bool TrainSpeedPlan::Matches(const Train *v) const
+{
+	return this->epoch == _vehicle_tick_epoch &&
+			this->tile == v->tile &&
+			this->x_pos == v->x_pos &&
+			this->y_pos == v->y_pos &&
+			this->order == v->current_order.Pack() &&
+			this->weight == v->gcache.cached_weight &&
+			this->power == v->gcache.cached_power &&
+			this->max_te == v->gcache.cached_max_te &&
+			this->air_drag == v->gcache.cached_air_drag &&
+			this->max_curve_speed == v->tcache.cached_max_curve_speed &&
+			this->cur_speed == v->cur_speed &&
+			this->flags == v->flags &&
+			this->gv_flags == v->gv_flags &&
+			this->axle_resistance == v->gcache.cached_axle_resistance &&
+			this->max_track_speed == v->gcache.cached_max_track_speed &&
+			this->total_length == v->gcache.cached_total_length &&
+			this->last_station_visited == v->last_station_visited &&
+			this->vehstatus == v->vehstatus &&
+			this->direction == v->direction &&
+			this->track == v->track &&
+			this->railtype == v->railtype;
+}
+
+/**
+ * Calculate the acceleration and the maximum speed of the train in advance
+ * for its next speed update. This only reads the state of the train and the
+ * map, so it may be called for different trains from several threads at once
+ * while no vehicle is ticking.
+ */
+void Train::PlanSpeed()
+{
+	assert(this->IsFrontEngine());
+
+	/* Trains that won't update their speed this tick don't need a plan. */
+	if ((this->vehstatus & VS_CRASHED) || ((this->vehstatus & VS_STOPPED) && this->cur_speed == 0) ||
+			this->current_order.IsType(OT_LOADING) || _settings_game.vehicle.train_acceleration_model != AM_REALISTIC) {
+		this->speed_plan.epoch = 0;
+		return;
+	}
+
+	this->speed_plan.acceleration = this->GetAcceleration();
+	this->speed_plan.max_speed = this->GetCurrentMaxSpeed();
+	this->speed_plan.Record(this);
+	this->speed_plan.epoch = _vehicle_tick_epoch;
+}
+
 /**
  * This function looks at the vehicle and updates its speed (cur_speed
  * and subspeed) variables. Furthermore, it returns the distance that
@@ -2641,8 +2751,18 @@ int Train::UpdateSpeed()
 		case AM_ORIGINAL:
 			return this->DoUpdateSpeed(this->acceleration * (this->GetAccelerationStatus() == AS_BRAKE ? -4 : 2), 0, this->gcache.cached_max_track_speed);
 
-		case AM_REALISTIC:
+		case AM_REALISTIC: {
+			/* A plan is only good for one update; the train changes its state when it moves. */
+			if (this->speed_plan.Matches(this)) {
+				this->speed_plan.epoch = 0;
+#ifdef _DEBUG
+				/* Working out both again serially defeats the plan; only check it in debug builds. */
+				assert(this->speed_plan.acceleration == this->GetAcceleration() && this->speed_plan.max_speed == this->GetCurrentMaxSpeed());
+#endif /* _DEBUG */
+				return this->DoUpdateSpeed(this->speed_plan.acceleration, this->GetAccelerationStatus() == AS_BRAKE ? 0 : 2, this->speed_plan.max_speed);
+			}
 			return this->DoUpdateSpeed(this->GetAcceleration(), this->GetAccelerationStatus() == AS_BRAKE ? 0 : 2, this->GetCurrentMaxSpeed());
+		}
 	}
 }
 
@@ -27,6 +27,7 @@
 #include "landscape_type.h"
 #include "company_base.h"
 #include "core/random_func.hpp"
+#include "pathfinder/water_regions.h"
 
 #include "table/strings.h"
 #include "table/sprites.h"
@@ -102,6 +103,7 @@ static void PlantTreesOnTile(TileIndex tile, TreeType treetype, uint count, uint
 	switch (GetTileType(tile)) {
 		case MP_WATER:
 			ground = TREE_GROUND_SHORE;
+			InvalidateWaterRegion(tile);
 			break;
 
 		case MP_CLEAR:
@@ -703,7 +705,7 @@ static void TileLoop_Trees(TileIndex tile)
 			} else {
 				/* just one tree, change type into MP_CLEAR */
 				switch (GetTreeGround(tile)) {
-					case TREE_GROUND_SHORE: MakeShore(tile); break;
+					case TREE_GROUND_SHORE: MakeShore(tile); InvalidateWaterRegion(tile); break;
 					case TREE_GROUND_GRASS: MakeClear(tile, CLEAR_GRASS, GetTreeDensity(tile)); break;
 					case TREE_GROUND_ROUGH: MakeClear(tile, CLEAR_ROUGH, 3); break;
 					case TREE_GROUND_ROUGH_SNOW: {
@@ -24,6 +24,7 @@
 #include "roadveh.h"
 #include "water_map.h"
 #include "pathfinder/yapf/yapf_cache.h"
+#include "pathfinder/water_regions.h"
 #include "newgrf_sound.h"
 #include "autoslope.h"
 #include "tunnelbridge_map.h"
@@ -440,6 +441,8 @@ CommandCost CmdBuildBridge(TileIndex end_tile, DoCommandFlag flags, uint32 p1, u
 			case TRANSPORT_WATER:
 				MakeAqueductBridgeRamp(tile_start, owner, dir);
 				MakeAqueductBridgeRamp(tile_end,   owner, ReverseDiagDir(dir));
+				InvalidateWaterRegion(tile_start);
+				InvalidateWaterRegion(tile_end);
 				break;
 
 			default:
@@ -457,6 +460,12 @@ CommandCost CmdBuildBridge(TileIndex end_tile, DoCommandFlag flags, uint32 p1, u
 		Track track = AxisToTrack(direction);
 		AddSideToSignalBuffer(tile_start, INVALID_DIAGDIR, _current_company);
 		YapfNotifyTrackLayoutChange(tile_start, track);
+		YapfNotifyTrackLayoutChange(tile_end, track);
+	}
+
+	if ((flags & DC_EXEC) && transport_type == TRANSPORT_ROAD) {
+		YapfNotifyRoadLayoutChange(tile_start);
+		YapfNotifyRoadLayoutChange(tile_end);
 	}
 
 	/* for human player that builds the bridge he gets a selection to choose from bridges (DC_QUERY_COST)
@@ -625,9 +634,12 @@ CommandCost CmdBuildTunnel(TileIndex start_tile, DoCommandFlag flags, uint32 p1,
 			MakeRailTunnel(end_tile,   _current_company, ReverseDiagDir(direction), railtype);
 			AddSideToSignalBuffer(start_tile, INVALID_DIAGDIR, _current_company);
 			YapfNotifyTrackLayoutChange(start_tile, DiagDirToDiagTrack(direction));
+			YapfNotifyTrackLayoutChange(end_tile, DiagDirToDiagTrack(direction));
 		} else {
 			MakeRoadTunnel(start_tile, _current_company, direction,                 rts);
 			MakeRoadTunnel(end_tile,   _current_company, ReverseDiagDir(direction), rts);
+			YapfNotifyRoadLayoutChange(start_tile);
+			YapfNotifyRoadLayoutChange(end_tile);
 		}
 	}
 
@@ -735,6 +747,8 @@ static CommandCost DoClearTunnel(TileIndex tile, DoCommandFlag flags)
 		} else {
 			DoClearSquare(tile);
 			DoClearSquare(endtile);
+			YapfNotifyRoadLayoutChange(tile);
+			YapfNotifyRoadLayoutChange(endtile);
 		}
 	}
 	return CommandCost(EXPENSES_CONSTRUCTION, _price[PR_CLEAR_TUNNEL] * (GetTunnelBridgeLength(tile, endtile) + 2));
@@ -781,6 +795,7 @@ static CommandCost DoClearBridge(TileIndex tile, DoCommandFlag flags)
 	if (flags & DC_EXEC) {
 		/* read this value before actual removal of bridge */
 		bool rail = GetTunnelBridgeTransportType(tile) == TRANSPORT_RAIL;
+		bool road = GetTunnelBridgeTransportType(tile) == TRANSPORT_ROAD;
 		Owner owner = GetTileOwner(tile);
 		uint height = GetBridgeHeight(tile);
 		Train *v = NULL;
@@ -813,6 +828,11 @@ static CommandCost DoClearBridge(TileIndex tile, DoCommandFlag flags)
 
 			if (v != NULL) TryPathReserve(v, true);
 		}
+
+		if (road) {
+			YapfNotifyRoadLayoutChange(tile);
+			YapfNotifyRoadLayoutChange(endtile);
+		}
 	}
 
 	return CommandCost(EXPENSES_CONSTRUCTION, (GetTunnelBridgeLength(tile, endtile) + 2) * base_cost);
@@ -1485,6 +1505,7 @@ static void ChangeTileOwner_TunnelBridge(TileIndex tile, Owner old_owner, Owner
 
 	if (new_owner != INVALID_OWNER) {
 		SetTileOwner(tile, new_owner);
+		if (GetTunnelBridgeTransportType(tile) == TRANSPORT_RAIL) YapfNotifyTrackLayoutChange(tile, DiagDirToDiagTrack(GetTunnelBridgeDirection(tile)));
 	} else {
 		if (GetTunnelBridgeTransportType(tile) == TRANSPORT_RAIL) {
 			/* Since all of our vehicles have been removed, it is safe to remove the rail
@@ -52,21 +52,174 @@
 #include "bridge_map.h"
 #include "tunnel_map.h"
 #include "depot_map.h"
+#include "thread/worker_pool.h"
+#include "tick_profile.h"
 
-#include "table/strings.h"
+#include <vector>
 
-#define GEN_HASH(x, y) ((GB((y), 6, 6) << 6) + GB((x), 7, 6))
+#include "table/strings.h"
 
 VehicleID _new_vehicle_id;
 uint16 _returned_refit_capacity;      ///< Stores the capacity after a refit operation.
 uint16 _returned_mail_refit_capacity; ///< Stores the mail capacity after a refit operation (Aircraft only).
 byte _age_cargo_skip_counter;         ///< Skip aging of cargo?
+uint32 _vehicle_tick_epoch;           ///< Number of vehicle ticks run so far; plans of earlier ticks are stale.
+uint8 _vehicle_tick_threads;          ///< Number of threads helping with the plan phase of the vehicle tick; 0 for one less than the number of CPU cores.
+bool _serial_vehicle_ticks;           ///< Skip the plan phase and run the whole vehicle tick in the main thread.
+
+static WorkerPool _vehicle_tick_workers; ///< Threads running the plan phase of the vehicle tick.
+
+/**
+ * Vehicles with an index below this one have already ticked in the current
+ * vehicle tick; UINT_MAX between the vehicle ticks.
+ */
+static uint _vehicle_ticks_done = UINT_MAX;
+static std::vector<uint32> _sleeping_vehicles; ///< Bitmap of the sleeping vehicles by pool index.
 
 
 /** The pool with all our precious vehicles. */
 VehiclePool _vehicle_pool("Vehicle");
 INSTANTIATE_POOL_METHODS(Vehicle)
 
+/**
+ * Check whether the vehicle with the given index is sleeping.
+ * @param index Pool index of the vehicle.
+ * @return True if the vehicle doesn't tick until it is woken up.
+ */
+static FORCEINLINE bool IsVehicleSleeping(size_t index)
+{
+	size_t word = index / 32;
+	return word < _sleeping_vehicles.size() && HasBit(_sleeping_vehicles[word], index % 32);
+}
+
+/**
+ * Find the first vehicle index which isn't sleeping, skipping whole words
+ * of sleeping vehicles at once.
+ * @param index Index to start searching at.
+ * @return First index at or after \a index which isn't sleeping; it might not be in use.
+ */
+static FORCEINLINE size_t NextAwakeVehicle(size_t index)
+{
+	for (size_t word = index / 32; word < _sleeping_vehicles.size(); word++, index = word * 32) {
+		uint32 awake = ~_sleeping_vehicles[word] & (UINT32_MAX << (index % 32));
+		if (awake != 0) return word * 32 + FindFirstBit(awake);
+	}
+	return index;
+}
+
+/**
+ * Get the last vehicle tick a vehicle took part in or would have taken part
+ * in if it had been awake.
+ * @param v Vehicle to check.
+ * @return Vehicle tick, see _vehicle_tick_epoch.
+ */
+static FORCEINLINE uint32 GetLastVehicleTick(const Vehicle *v)
+{
+	return v->index >= _vehicle_ticks_done ? _vehicle_tick_epoch - 1 : _vehicle_tick_epoch;
+}
+
+/**
+ * Get the number of ticks a vehicle skipped while sleeping. Anything
+ * reading the counters a vehicle increases in its tick has to add these.
+ * @param v Vehicle to check.
+ * @return Skipped ticks; 0 if the vehicle is awake.
+ */
+uint32 GetSleptTicks(const Vehicle *v)
+{
+	return IsVehicleSleeping(v->index) ? GetLastVehicleTick(v) - v->sleep_epoch : 0;
+}
+
+/**
+ * Check whether a vehicle is parked in a depot in a way that its tick only
+ * increases its counters, so it can sleep until something happens to it.
+ * @param v Vehicle which just ticked.
+ * @return True if the vehicle can sleep.
+ */
+static bool IsVehicleParked(const Vehicle *v)
+{
+	if (v->breakdown_ctr != 0 || v->cur_speed != 0 || (v->vehstatus & VS_CRASHED) || !v->IsStoppedInDepot()) return false;
+
+	switch (v->type) {
+		case VEH_TRAIN: {
+			const Train *t = Train::From(v);
+			return t->IsFrontEngine() && t->force_proceed == TFP_NONE && !HasBit(t->flags, VRF_REVERSING);
+		}
+
+		case VEH_ROAD: return RoadVehicle::From(v)->IsFrontEngine();
+		case VEH_SHIP: return true;
+		default: return false;
+	}
+}
+
+/**
+ * Take a vehicle out of the tick loop until it is woken up by WakeVehicle().
+ * The vehicle must only be put to sleep if its tick wouldn't do anything but
+ * increase the counters which are caught up on in WakeVehicle(), see
+ * IsVehicleParked(). Waking up a vehicle is always safe, so anything which
+ * could change that has to wake it.
+ * @param v First vehicle of the chain to put to sleep.
+ */
+void SleepVehicle(Vehicle *v)
+{
+	for (Vehicle *u = v; u != NULL; u = u->Next()) {
+		if (IsVehicleSleeping(u->index)) continue;
+
+		size_t word = u->index / 32;
+		if (word >= _sleeping_vehicles.size()) _sleeping_vehicles.resize(word + 1, 0);
+		SetBit(_sleeping_vehicles[word], u->index % 32);
+		u->sleep_epoch = GetLastVehicleTick(u);
+	}
+}
+
+/**
+ * Bring a sleeping vehicle back into the tick loop and increase its counters
+ * by the ticks it skipped, so it is in the same state as if it never slept.
+ * @param v Any vehicle of the chain to wake up; it is fine if it doesn't sleep.
+ */
+void WakeVehicle(Vehicle *v)
+{
+	for (Vehicle *u = v->First(); u != NULL; u = u->Next()) {
+		if (!IsVehicleSleeping(u->index)) continue;
+
+		uint32 ticks = GetSleptTicks(u);
+		ClrBit(_sleeping_vehicles[u->index / 32], u->index % 32);
+
+		/* These are the counters increased by the ticks of parked vehicles. */
+		switch (u->type) {
+			case VEH_TRAIN:
+				u->tick_counter += ticks;
+				if (Train::From(u)->IsFrontEngine()) u->current_order_time += ticks;
+				break;
+
+			case VEH_ROAD: {
+				RoadVehicle *rv = RoadVehicle::From(u);
+				if (!rv->IsFrontEngine()) break;
+				rv->tick_counter += ticks;
+				rv->current_order_time += ticks;
+				rv->reverse_ctr = ticks < rv->reverse_ctr ? rv->reverse_ctr - ticks : 0;
+				break;
+			}
+
+			case VEH_SHIP:
+				u->tick_counter += ticks;
+				u->current_order_time += ticks;
+				break;
+
+			default: NOT_REACHED();
+		}
+	}
+}
+
+/** Wake up all vehicles, e.g. to save their actual state. */
+void WakeAllVehicles()
+{
+	for (size_t word = 0; word < _sleeping_vehicles.size(); word++) {
+		while (_sleeping_vehicles[word] != 0) {
+			WakeVehicle(Vehicle::Get(word * 32 + FindFirstBit(_sleeping_vehicles[word])));
+		}
+	}
+}
+
 /**
  * Function to tell if a vehicle needs to be autorenewed
  * @param *c The vehicle owner
@@ -179,6 +332,9 @@ uint Vehicle::Crash(bool flooded)
 	assert((this->vehstatus & VS_CRASHED) == 0);
 	assert(this->Previous() == NULL); // IsPrimaryVehicle fails for free-wagon-chains
 
+	/* Crashed vehicles have to tick. */
+	WakeVehicle(this);
+
 	uint pass = 0;
 	/* Stop the vehicle. */
 	if (this->IsPrimaryVehicle()) this->vehstatus |= VS_STOPPED;
@@ -256,26 +412,95 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/**
+ * Index of the vehicles by the tile they are on. The map is divided into
+ * square blocks of tiles which each have their own chain of vehicles. The
+ * size of the blocks is chosen from the size of the map and the number of
+ * vehicles in the index, so the chains stay short on large maps without
+ * wasting memory on small ones.
+ */
+struct VehicleTileHash {
+	/* Minimum and maximum number of blocks; the minimum is the size of the old fixed hash. */
+	static const uint MIN_BUCKETS = 1 << 14;
+	static const uint MAX_BUCKETS = 1 << 20;
+	/* Number of blocks to aim for per vehicle, as vehicles tend to cluster. */
+	static const uint BUCKETS_PER_VEHICLE = 16;
+
+	Vehicle **buckets; ///< First vehicle in the chain of each block.
+	uint res;          ///< Size of the blocks, 0 = 1*1 tile, 1 = 2*2 tiles, etc.
+	uint bits_x;       ///< Number of blocks in x direction as power of 2.
+	uint mask_x;       ///< Mask for the x coordinate of a block.
+	uint mask_y;       ///< Mask for the y coordinate of a block.
+	uint map_size;     ///< Size of the map the blocks were chosen for.
+	uint count;        ///< Number of vehicles in the index.
+	uint capacity;     ///< Number of vehicles the blocks were chosen for.
+	uint64 lookups;    ///< Number of lookups so far.
+	uint64 visits;     ///< Number of vehicles visited in lookups so far.
+
+	/**
+	 * Get the chain of the block containing a tile, or of a block with the
+	 * same index modulo the size of the index if it was made for a smaller map.
+	 * @param x X coordinate of the tile.
+	 * @param y Y coordinate of the tile.
+	 * @return Pointer to the first vehicle of the chain.
+	 */
+	FORCEINLINE Vehicle **GetBucket(uint x, uint y)
+	{
+		return &this->buckets[(((y >> this->res) & this->mask_y) << this->bits_x) | ((x >> this->res) & this->mask_x)];
+	}
+};
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+static VehicleTileHash _vehicle_tile_hash;
 
-static Vehicle *_new_vehicle_position_hash[TOTAL_HASH_SIZE];
+/**
+ * Choose the size of the blocks of the tile hash for the current map and
+ * the given number of vehicles and fill the hash with the vehicles which
+ * were in it before.
+ * @param capacity Number of vehicles to plan for.
+ */
+static void RebuildVehicleTileHash(uint capacity)
+{
+	VehicleTileHash &h = _vehicle_tile_hash;
+
+	uint wanted = Clamp(capacity * VehicleTileHash::BUCKETS_PER_VEHICLE, VehicleTileHash::MIN_BUCKETS, VehicleTileHash::MAX_BUCKETS);
+	uint res = 0;
+	while ((MapSize() >> (2 * res)) > wanted && res < min(MapLogX(), MapLogY())) res++;
+
+	h.capacity = capacity;
+	if (h.buckets != NULL && res == h.res && h.map_size == MapSize()) return;
+
+	free(h.buckets);
+	h.res = res;
+	h.bits_x = MapLogX() - res;
+	h.mask_x = (1 << h.bits_x) - 1;
+	h.mask_y = (1 << (MapLogY() - res)) - 1;
+	h.map_size = MapSize();
+	h.buckets = CallocT<Vehicle *>(MapSize() >> (2 * res));
+
+	/* Put the vehicles back; the order within the chains doesn't matter. */
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (v->old_new_hash == NULL) continue;
+
+		Vehicle **hash = h.GetBucket(TileX(v->tile), TileY(v->tile));
+		v->next_new_hash = *hash;
+		if (v->next_new_hash != NULL) v->next_new_hash->prev_new_hash = &v->next_new_hash;
+		v->prev_new_hash = hash;
+		*hash = v;
+		v->old_new_hash = hash;
+	}
+}
 
-static Vehicle *VehicleFromHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
+static Vehicle *VehicleFromHash(uint xl, uint yl, uint xu, uint yu, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _new_vehicle_position_hash[(x + y) & TOTAL_HASH_MASK];
+	VehicleTileHash &h = _vehicle_tile_hash;
+	h.lookups++;
+
+	for (uint y = yl; ; y = (y + 1) & h.mask_y) {
+		for (uint x = xl; ; x = (x + 1) & h.mask_x) {
+			Vehicle *v = h.buckets[(y << h.bits_x) | x];
 			for (; v != NULL; v = v->next_new_hash) {
+				h.visits++;
 				Vehicle *a = proc(v, data);
 				if (find_first && a != NULL) return a;
 			}
@@ -302,12 +527,13 @@ static Vehicle *VehicleFromHash(int xl, int yl, int xu, int yu, void *data, Vehi
 static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *proc, bool find_first)
 {
 	const int COLL_DIST = 6;
+	const VehicleTileHash &h = _vehicle_tile_hash;
 
 	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	uint xl = ((uint)((x - COLL_DIST) / TILE_SIZE) >> h.res) & h.mask_x;
+	uint xu = ((uint)((x + COLL_DIST) / TILE_SIZE) >> h.res) & h.mask_x;
+	uint yl = ((uint)((y - COLL_DIST) / TILE_SIZE) >> h.res) & h.mask_y;
+	uint yu = ((uint)((y + COLL_DIST) / TILE_SIZE) >> h.res) & h.mask_y;
 
 	return VehicleFromHash(xl, yl, xu, yu, data, proc, find_first);
 }
@@ -359,11 +585,12 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
  */
 static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
+	VehicleTileHash &h = _vehicle_tile_hash;
+	h.lookups++;
 
-	Vehicle *v = _new_vehicle_position_hash[(x + y) & TOTAL_HASH_MASK];
+	Vehicle *v = *h.GetBucket(TileX(tile), TileY(tile));
 	for (; v != NULL; v = v->next_new_hash) {
+		h.visits++;
 		if (v->tile != tile) continue;
 
 		Vehicle *a = proc(v, data);
@@ -502,19 +729,27 @@ CommandCost EnsureNoTrainOnTrackBits(TileIndex tile, TrackBits track_bits)
 
 static void UpdateNewVehiclePosHash(Vehicle *v, bool remove)
 {
-	Vehicle **old_hash = v->old_new_hash;
+	VehicleTileHash &h = _vehicle_tile_hash;
 	Vehicle **new_hash;
 
 	if (remove) {
 		new_hash = NULL;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_new_vehicle_position_hash[(x + y) & TOTAL_HASH_MASK];
+		/* Adapt the blocks to the map and the number of vehicles before adding a vehicle. */
+		if (v->old_new_hash == NULL && h.count >= h.capacity) {
+			RebuildVehicleTileHash(max(h.capacity * 2, 1U));
+		} else if (h.map_size != MapSize()) {
+			RebuildVehicleTileHash(h.capacity);
+		}
+		new_hash = h.GetBucket(TileX(v->tile), TileY(v->tile));
 	}
 
+	Vehicle **old_hash = v->old_new_hash;
 	if (old_hash == new_hash) return;
 
+	if (old_hash == NULL) h.count++;
+	if (new_hash == NULL) h.count--;
+
 	/* Remove from the old position in the hash table */
 	if (old_hash != NULL) {
 		if (v->next_new_hash != NULL) v->next_new_hash->prev_new_hash = v->prev_new_hash;
@@ -533,18 +768,77 @@ static void UpdateNewVehiclePosHash(Vehicle *v, bool remove)
 	v->old_new_hash = new_hash;
 }
 
-static Vehicle *_vehicle_position_hash[0x1000];
+/**
+ * Index of the vehicles by their position in the viewport, used to find the
+ * vehicles to draw. Each chain holds the vehicles whose bounding box starts in
+ * an area of 128 * 64 pixels; the areas wrap around at the size of the index,
+ * which is chosen from the size of the map.
+ */
+struct VehicleViewportHash {
+	Vehicle **buckets; ///< First vehicle in the chain of each area.
+	uint bits;         ///< Number of areas in either direction as power of 2.
+	uint map_size;     ///< Size of the map the index was made for.
+
+	/**
+	 * Get the chain of the area containing a point.
+	 * @param x X coordinate of the point in the viewport.
+	 * @param y Y coordinate of the point in the viewport.
+	 * @return Pointer to the first vehicle of the chain.
+	 */
+	FORCEINLINE Vehicle **GetBucket(int x, int y)
+	{
+		return &this->buckets[(GB(y, 6, this->bits) << this->bits) + GB(x, 7, this->bits)];
+	}
+};
+
+static VehicleViewportHash _vehicle_viewport_hash;
+
+/** Resize the viewport hash for the current map and empty it. */
+static void ClearVehicleViewportHash()
+{
+	VehicleViewportHash &h = _vehicle_viewport_hash;
+
+	free(h.buckets);
+	/* One bit more per axis for each doubling of the map beyond 256 tiles; 6 bits is the size of the old fixed hash. */
+	h.bits = Clamp((int)max(MapLogX(), MapLogY()) - 2, 6, 9);
+	h.map_size = MapSize();
+	h.buckets = CallocT<Vehicle *>(1 << (2 * h.bits));
+}
+
+/**
+ * Resize the viewport hash for the current map and fill it with the vehicles
+ * which were in it before.
+ */
+static void RebuildVehicleViewportHash()
+{
+	VehicleViewportHash &h = _vehicle_viewport_hash;
+	ClearVehicleViewportHash();
+
+	Vehicle *v;
+	FOR_ALL_VEHICLES(v) {
+		if (v->coord.left == INVALID_COORD) continue;
+
+		Vehicle **hash = h.GetBucket(v->coord.left, v->coord.top);
+		v->next_hash = *hash;
+		if (v->next_hash != NULL) v->next_hash->prev_hash = &v->next_hash;
+		v->prev_hash = hash;
+		*hash = v;
+	}
+}
 
 static void UpdateVehiclePosHash(Vehicle *v, int x, int y)
 {
 	UpdateNewVehiclePosHash(v, x == INVALID_COORD);
 
+	VehicleViewportHash &h = _vehicle_viewport_hash;
+	if (h.map_size != MapSize()) RebuildVehicleViewportHash();
+
 	Vehicle **old_hash, **new_hash;
 	int old_x = v->coord.left;
 	int old_y = v->coord.top;
 
-	new_hash = (x == INVALID_COORD) ? NULL : &_vehicle_position_hash[GEN_HASH(x, y)];
-	old_hash = (old_x == INVALID_COORD) ? NULL : &_vehicle_position_hash[GEN_HASH(old_x, old_y)];
+	new_hash = (x == INVALID_COORD) ? NULL : h.GetBucket(x, y);
+	old_hash = (old_x == INVALID_COORD) ? NULL : h.GetBucket(old_x, old_y);
 
 	if (old_hash == new_hash) return;
 
@@ -567,8 +861,54 @@ void ResetVehiclePosHash()
 {
 	Vehicle *v;
 	FOR_ALL_VEHICLES(v) { v->old_new_hash = NULL; }
-	memset(_vehicle_position_hash, 0, sizeof(_vehicle_position_hash));
-	memset(_new_vehicle_position_hash, 0, sizeof(_new_vehicle_position_hash));
+
+	/* Start over with the smallest tile hash for the current map; it grows with the number of vehicles. */
+	free(_vehicle_tile_hash.buckets);
+	_vehicle_tile_hash.buckets = NULL;
+	_vehicle_tile_hash.count = 0;
+	RebuildVehicleTileHash(0);
+	/* Only empty it; callers put the vehicles back in with VehicleMove after invalidating their coordinates. */
+	ClearVehicleViewportHash();
+}
+
+/**
+ * Get statistics about the lengths of the chains in the vehicle position hashes.
+ * @param tile_hash Statistics of the hash by tile.
+ * @param viewport_hash Statistics of the hash by viewport position.
+ */
+void GetVehicleHashStats(VehicleHashStats *tile_hash, VehicleHashStats *viewport_hash)
+{
+	const VehicleTileHash &th = _vehicle_tile_hash;
+	tile_hash->buckets = th.buckets == NULL ? 0 : th.map_size >> (2 * th.res);
+	tile_hash->block_size = 1 << th.res;
+	tile_hash->lookups = th.lookups;
+	tile_hash->visits = th.visits;
+
+	const VehicleViewportHash &vh = _vehicle_viewport_hash;
+	viewport_hash->buckets = vh.buckets == NULL ? 0 : 1 << (2 * vh.bits);
+	viewport_hash->block_size = 0;
+	viewport_hash->lookups = 0;
+	viewport_hash->visits = 0;
+
+	VehicleHashStats *stats[] = {tile_hash, viewport_hash};
+	for (uint i = 0; i < lengthof(stats); i++) {
+		VehicleHashStats *s = stats[i];
+		s->vehicles = 0;
+		s->used_buckets = 0;
+		s->max_chain = 0;
+		for (uint b = 0; b < s->buckets; b++) {
+			uint length = 0;
+			if (i == 0) {
+				for (const Vehicle *v = th.buckets[b]; v != NULL; v = v->next_new_hash) length++;
+			} else {
+				for (const Vehicle *v = vh.buckets[b]; v != NULL; v = v->next_hash) length++;
+			}
+			if (length == 0) continue;
+			s->vehicles += length;
+			s->used_buckets++;
+			s->max_chain = max(s->max_chain, length);
+		}
+	}
 }
 
 void ResetVehicleColourMap()
@@ -593,6 +933,8 @@ void InitializeVehicles()
 
 	_vehicles_to_autoreplace.Reset();
 	ResetVehiclePosHash();
+
+	_sleeping_vehicles.clear();
 }
 
 uint CountVehiclesInChain(const Vehicle *v)
@@ -674,7 +1016,7 @@ void Vehicle::PreDestructor()
 
 	if (Station::IsValidID(this->last_station_visited)) {
 		Station *st = Station::Get(this->last_station_visited);
-		st->loading_vehicles.remove(this);
+		st->RemoveLoadingVehicle(this);
 
 		HideFillingPercent(&this->fill_percent_te_id);
 		this->CancelReservation(INVALID_STATION, st);
@@ -739,6 +1081,8 @@ Vehicle::~Vehicle()
 
 	if (CleaningPool()) return;
 
+	if (IsVehicleSleeping(this->index)) ClrBit(_sleeping_vehicles[this->index / 32], this->index % 32);
+
 	/* sometimes, eg. for disaster vehicles, when company bankrupts, when removing crashed/flooded vehicles,
 	 * it may happen that vehicle chain is deleted when visible */
 	if (!(this->vehstatus & VS_HIDDEN)) MarkSingleVehicleDirty(this);
@@ -798,21 +1142,94 @@ static void RunVehicleDayProc()
 	}
 }
 
+/** A range of the vehicle pool to be planned by one task. */
+struct VehiclePlanBlock {
+	size_t first; ///< First pool index of the block.
+	size_t end;   ///< Pool index after the last one of the block.
+};
+
+/**
+ * Plan the tick of the vehicles in a range of the vehicle pool. Planning only
+ * reads the game state and writes the plans of the vehicles in the range, so
+ * the blocks can be planned in parallel and the order doesn't matter.
+ * @param block Range of vehicles to be planned.
+ */
+static void PlanVehicleBlock(void *block)
+{
+	const VehiclePlanBlock *b = (const VehiclePlanBlock *)block;
+	for (size_t i = b->first; i < b->end; i++) {
+		if (IsVehicleSleeping(i)) continue;
+		Vehicle *v = Vehicle::GetIfValid(i);
+		if (v != NULL && v->type == VEH_TRAIN && Train::From(v)->IsFrontEngine()) Train::From(v)->PlanSpeed();
+	}
+}
+
+/**
+ * Run the plan phase of the vehicle tick: calculate everything the vehicles
+ * need for their tick that only depends on their own state and the map in
+ * parallel. The vehicles then tick in the main thread in the usual order and
+ * use their plans if they didn't change in the meantime, so the result is
+ * exactly the same as without planning.
+ */
+static void PlanVehicleTicks()
+{
+	/* Don't bother splitting up small pools. */
+	static const size_t MIN_BLOCK_SIZE = 1024;
+
+	uint num_threads = _vehicle_tick_threads != 0 ? _vehicle_tick_threads : max(GetCPUCoreCount(), 1U) - 1;
+	if (_vehicle_tick_workers.GetNumThreads() != num_threads) {
+		_vehicle_tick_workers.Start(num_threads);
+		DEBUG(misc, 1, "Started %d vehicle tick worker threads", _vehicle_tick_workers.GetNumThreads());
+	}
+
+	size_t pool_size = Vehicle::GetPoolSize();
+	uint num_blocks = (uint)Clamp(pool_size / MIN_BLOCK_SIZE, 1, _vehicle_tick_workers.GetNumThreads() + 1);
+
+	std::vector<VehiclePlanBlock> blocks(num_blocks);
+	std::vector<WorkerTask> tasks;
+	tasks.reserve(num_blocks);
+	for (uint i = 0; i < num_blocks; ++i) {
+		blocks[i].first = pool_size * i / num_blocks;
+		blocks[i].end = pool_size * (i + 1) / num_blocks;
+		tasks.push_back(WorkerTask(&PlanVehicleBlock, &blocks[i]));
+	}
+	/* queue all blocks but the first one and plan that one in this thread */
+	for (uint i = 1; i < num_blocks; ++i) _vehicle_tick_workers.Enqueue(&tasks[i]);
+	PlanVehicleBlock(&blocks[0]);
+	for (uint i = 1; i < num_blocks; ++i) _vehicle_tick_workers.Wait(&tasks[i]);
+}
+
 void CallVehicleTicks()
 {
+	TickProfileTimer timer(TPS_VEHICLES);
+
 	_vehicles_to_autoreplace.Clear();
 
 	_age_cargo_skip_counter = (_age_cargo_skip_counter == 0) ? 184 : (_age_cargo_skip_counter - 1);
 
 	RunVehicleDayProc();
 
-	Station *st;
-	FOR_ALL_STATIONS(st) LoadUnloadStation(st);
+	for (size_t index = Station::GetNextLoadingIndex(0); index < Station::GetPoolSize(); index = Station::GetNextLoadingIndex(index + 1)) {
+		LoadUnloadStation(Station::Get(index));
+	}
+
+	/* Plans from earlier ticks must not be used, even if nothing is planned this tick. */
+	_vehicle_tick_epoch++;
+	_vehicle_ticks_done = 0;
+	if (!_serial_vehicle_ticks) PlanVehicleTicks();
 
 	Vehicle *v;
-	FOR_ALL_VEHICLES(v) {
+	for (size_t vehicle_index = NextAwakeVehicle(0); vehicle_index < Vehicle::GetPoolSize(); vehicle_index = NextAwakeVehicle(vehicle_index + 1)) {
+		v = Vehicle::Get(vehicle_index);
+		if (v == NULL) continue;
+		_vehicle_ticks_done = (uint)vehicle_index + 1;
+
 		/* Vehicle could be deleted in this tick */
-		if (!v->Tick()) {
+		TickProfileSection section = GetVehicleTickProfileSection(v->type);
+		uint64 start = ottd_rdtsc();
+		bool alive = v->Tick();
+		_tick_profile_current[section] += ottd_rdtsc() - start;
+		if (!alive) {
 			assert(Vehicle::Get(vehicle_index) == NULL);
 			continue;
 		}
@@ -826,8 +1243,6 @@ void CallVehicleTicks()
 			case VEH_ROAD:
 			case VEH_AIRCRAFT:
 			case VEH_SHIP:
-				if (_age_cargo_skip_counter == 0) v->cargo.AgeCargo();
-
 				if (v->type == VEH_TRAIN && Train::From(v)->IsWagon()) continue;
 				if (v->type == VEH_AIRCRAFT && v->subtype != AIR_HELICOPTER) continue;
 				if (v->type == VEH_ROAD && !RoadVehicle::From(v)->IsFrontEngine()) continue;
@@ -839,7 +1254,16 @@ void CallVehicleTicks()
 				/* Play an alterate running sound every 16 ticks */
 				if (GB(v->tick_counter, 0, 4) == 0) PlayVehicleSound(v, v->cur_speed > 0 ? VSE_RUNNING_16 : VSE_STOPPED_16);
 		}
+
+		/* Parked vehicles don't need to tick until something happens to them.
+		 * Vehicles which just entered a depot look parked, as they are always
+		 * stopped there, but they are restarted below if they didn't want to stop. */
+		if (IsVehicleParked(v) && !_vehicles_to_autoreplace.Contains(v)) SleepVehicle(v);
 	}
+	_vehicle_ticks_done = UINT_MAX;
+
+	/* Age the cargo on all vehicles at once; the packets derive their age from the epoch. */
+	if (_age_cargo_skip_counter == 0) _cargo_age_epoch++;
 
 	Backup<CompanyByte> cur_company(_current_company, FILE_LINE);
 	for (AutoreplaceMap::iterator it = _vehicles_to_autoreplace.Begin(); it != _vehicles_to_autoreplace.End(); it++) {
@@ -851,6 +1275,8 @@ void CallVehicleTicks()
 		 * We need to stop them between VehicleEnteredDepotThisTick() and here or we risk that
 		 * they are already leaving the depot again before being replaced. */
 		if (it->second) v->vehstatus &= ~VS_STOPPED;
+		/* Otherwise it would not leave the depot in the next tick. */
+		assert(!IsVehicleSleeping(v->index));
 
 		/* Store the position of the effect as the vehicle pointer will become invalid later */
 		int x = v->x_pos;
@@ -920,29 +1346,31 @@ void ViewportAddVehicles(DrawPixelInfo *dpi)
 	const int b = dpi->top + dpi->height;
 
 	/* The hash area to scan */
-	int xl, xu, yl, yu;
+	const VehicleViewportHash &h = _vehicle_viewport_hash;
+	const uint mask = (1 << h.bits) - 1;
+	uint xl, xu, yl, yu;
 
-	if (dpi->width + 70 < (1 << (7 + 6))) {
-		xl = GB(l - 70, 7, 6);
-		xu = GB(r,      7, 6);
+	if (dpi->width + 70 < (1 << (7 + h.bits))) {
+		xl = GB(l - 70, 7, h.bits);
+		xu = GB(r,      7, h.bits);
 	} else {
 		/* scan whole hash row */
 		xl = 0;
-		xu = 0x3F;
+		xu = mask;
 	}
 
-	if (dpi->height + 70 < (1 << (6 + 6))) {
-		yl = GB(t - 70, 6, 6) << 6;
-		yu = GB(b,      6, 6) << 6;
+	if (dpi->height + 70 < (1 << (6 + h.bits))) {
+		yl = GB(t - 70, 6, h.bits);
+		yu = GB(b,      6, h.bits);
 	} else {
 		/* scan whole column */
 		yl = 0;
-		yu = 0x3F << 6;
+		yu = mask;
 	}
 
-	for (int y = yl;; y = (y + (1 << 6)) & (0x3F << 6)) {
-		for (int x = xl;; x = (x + 1) & 0x3F) {
-			const Vehicle *v = _vehicle_position_hash[x + y]; // already masked & 0xFFF
+	for (uint y = yl;; y = (y + 1) & mask) {
+		for (uint x = xl;; x = (x + 1) & mask) {
+			const Vehicle *v = h.buckets[(y << h.bits) + x];
 
 			while (v != NULL) {
 				if (!(v->vehstatus & VS_HIDDEN) ) {
@@ -1860,7 +2288,7 @@ void Vehicle::BeginLoading()
 	}
 
 	Station *curr_station = Station::Get(this->last_station_visited);
-	curr_station->loading_vehicles.push_back(this);
+	curr_station->AddLoadingVehicle(this);
 
 	StationID next_station_id = INVALID_STATION;
 	OrderList *orders = this->orders.list;
@@ -1935,7 +2363,7 @@ void Vehicle::LeaveStation()
 
 	this->current_order.MakeLeaveStation();
 	Station *st = Station::Get(this->last_station_visited);
-	st->loading_vehicles.remove(this);
+	st->RemoveLoadingVehicle(this);
 
 	OrderList *orders = this->orders.list;
 	if (orders != NULL) {
@@ -117,6 +117,8 @@ struct LoadgameState;
 extern bool LoadOldVehicle(LoadgameState *ls, int num);
 extern void FixOldVehicles();
 
+uint32 GetSleptTicks(const Vehicle *v);
+
 /** %Vehicle data structure. */
 struct Vehicle : VehiclePool::PoolItem<&_vehicle_pool>, BaseVehicle {
 private:
@@ -134,9 +136,39 @@ public:
 	friend void AfterLoadVehicles(bool part_of_load);             ///< So we can set the previous and first pointers while loading
 	friend bool LoadOldVehicle(LoadgameState *ls, int num);       ///< So we can set the proper next pointer while loading
 
-	char *name;                         ///< Name of vehicle
-
+	/*
+	 * The state touched in (nearly) every tick of a vehicle comes first, so
+	 * ticking and moving a vehicle needs as few cache lines as possible. The
+	 * rarely used data follows below.
+	 */
 	TileIndex tile;                     ///< Current tile index
+	int32 x_pos;                        ///< x coordinate.
+	int32 y_pos;                        ///< y coordinate.
+	byte z_pos;                         ///< z coordinate.
+	DirectionByte direction;            ///< facing
+	byte vehstatus;                     ///< Status
+	byte subtype;                       ///< subtype (Filled with values from #EffectVehicles/#TrainSubTypes/#AircraftSubTypes)
+
+	uint16 cur_speed;                   ///< current speed
+	byte subspeed;                      ///< fractional speed
+	byte acceleration;                  ///< used by train & aircraft
+	uint32 motion_counter;              ///< counter to occasionally play a vehicle sound.
+	byte progress;                      ///< The percentage (if divided by 256) this vehicle already crossed the tile unit.
+	byte tick_counter;                  ///< Increased by one for each tick
+	byte running_ticks;                 ///< Number of ticks this vehicle was not stopped this day
+	byte breakdown_ctr;                 ///< Counter for managing breakdown events. @see Vehicle::HandleBreakdown
+
+	byte vehicle_flags;                 ///< Used for gradual loading and other miscellaneous things (@see VehicleFlags enum)
+	uint16 load_unload_ticks;           ///< Ticks to wait before starting next cycle.
+	uint32 current_order_time;          ///< How many ticks have passed since this order started.
+	Order current_order;                ///< The current order (+ status, like: loading)
+	VehicleOrderID cur_real_order_index;///< The index to the current real (non-automatic) order
+	VehicleOrderID cur_auto_order_index;///< The index to the current automatic order
+
+	union {
+		OrderList *list;            ///< Pointer to the order list for this vehicle
+		Order     *old;             ///< Only used during conversion of old save games
+	} orders;                           ///< The orders currently assigned to the vehicle.
 
 	/**
 	 * Heading for this tile.
@@ -145,16 +177,21 @@ public:
 	 */
 	TileIndex dest_tile;
 
-	Money profit_this_year;             ///< Profit this year << 8, low 8 bits are fract
-	Money profit_last_year;             ///< Profit last year << 8, low 8 bits are fract
-	Money value;                        ///< Value of the vehicle
-
-	CargoPayment *cargo_payment;        ///< The cargo payment we're currently in
+	StationID last_station_visited;     ///< The last station we stopped at.
+	StationID last_loading_station;     ///< Last station the vehicle has stopped at and could possibly leave from with any cargo loaded.
 
-	/* Used for timetabling. */
-	uint32 current_order_time;          ///< How many ticks have passed since this order started.
-	int32 lateness_counter;             ///< How many ticks late (or early if negative) this vehicle is.
-	Date timetable_start;               ///< When the vehicle is supposed to start the timetable.
+	/* Updated whenever the vehicle moves a step. */
+	SpriteID cur_image;                 ///< sprite number for this vehicle
+	byte x_extent;                      ///< x-extent of vehicle bounding box
+	byte y_extent;                      ///< y-extent of vehicle bounding box
+	byte z_extent;                      ///< z-extent of vehicle bounding box
+	int8 x_offs;                        ///< x offset for vehicle sprite
+	int8 y_offs;                        ///< y offset for vehicle sprite
+	byte spritenum;                     ///< currently displayed sprite index
+	                                    ///< 0xfd == custom sprite, 0xfe == custom second head sprite
+	                                    ///< 0xff == reserved for another custom sprite
+	OwnerByte owner;                    ///< Which company owns the vehicle?
+	EngineID engine_type;               ///< The type of engine used for this vehicle.
 
 	Rect coord;                         ///< NOSAVE: Graphical bounding box of the vehicle, i.e. what to redraw on moves.
 
@@ -165,7 +202,21 @@ public:
 	Vehicle **prev_new_hash;            ///< NOSAVE: Previous vehicle in the tile location hash.
 	Vehicle **old_new_hash;             ///< NOSAVE: Cache of the current hash chain.
 
+	/* Rarely used data. */
+	char *name;                         ///< Name of vehicle
+
+	Money profit_this_year;             ///< Profit this year << 8, low 8 bits are fract
+	Money profit_last_year;             ///< Profit last year << 8, low 8 bits are fract
+	Money value;                        ///< Value of the vehicle
+
+	CargoPayment *cargo_payment;        ///< The cargo payment we're currently in
+
+	/* Used for timetabling. */
+	int32 lateness_counter;             ///< How many ticks late (or early if negative) this vehicle is.
+	Date timetable_start;               ///< When the vehicle is supposed to start the timetable.
+
 	SpriteID colourmap;                 ///< NOSAVE: cached colour mapping
+	uint32 sleep_epoch;                 ///< NOSAVE: Last vehicle tick the vehicle ticked in before it fell asleep, see SleepVehicle().
 
 	/* Related to age and service time */
 	Year build_year;                    ///< Year the vehicle has been built.
@@ -175,67 +226,24 @@ public:
 	Date service_interval;              ///< The interval for (automatic) servicing; either in days or %.
 	uint16 reliability;                 ///< Reliability.
 	uint16 reliability_spd_dec;         ///< Reliability decrease speed.
-	byte breakdown_ctr;                 ///< Counter for managing breakdown events. @see Vehicle::HandleBreakdown
 	byte breakdown_delay;               ///< Counter for managing breakdown length.
 	byte breakdowns_since_last_service; ///< Counter for the amount of breakdowns.
 	byte breakdown_chance;              ///< Current chance of breakdowns.
 
-	int32 x_pos;                        ///< x coordinate.
-	int32 y_pos;                        ///< y coordinate.
-	byte z_pos;                         ///< z coordinate.
-	DirectionByte direction;            ///< facing
-
-	OwnerByte owner;                    ///< Which company owns the vehicle?
-	byte spritenum;                     ///< currently displayed sprite index
-	                                    ///< 0xfd == custom sprite, 0xfe == custom second head sprite
-	                                    ///< 0xff == reserved for another custom sprite
-	SpriteID cur_image;                 ///< sprite number for this vehicle
-	byte x_extent;                      ///< x-extent of vehicle bounding box
-	byte y_extent;                      ///< y-extent of vehicle bounding box
-	byte z_extent;                      ///< z-extent of vehicle bounding box
-	int8 x_offs;                        ///< x offset for vehicle sprite
-	int8 y_offs;                        ///< y offset for vehicle sprite
-	EngineID engine_type;               ///< The type of engine used for this vehicle.
-
 	TextEffectID fill_percent_te_id;    ///< a text-effect id to a loading indicator object
 	UnitID unitnumber;                  ///< unit number, for display purposes only
 
-	uint16 cur_speed;                   ///< current speed
-	byte subspeed;                      ///< fractional speed
-	byte acceleration;                  ///< used by train & aircraft
-	uint32 motion_counter;              ///< counter to occasionally play a vehicle sound.
-	byte progress;                      ///< The percentage (if divided by 256) this vehicle already crossed the tile unit.
-
 	byte random_bits;                   ///< Bits used for determining which randomized variational spritegroups to use when drawing.
 	byte waiting_triggers;              ///< Triggers to be yet matched before rerandomizing the random bits.
 
-	StationID last_station_visited;     ///< The last station we stopped at.
-	StationID last_loading_station;     ///< Last station the vehicle has stopped at and could possibly leave from with any cargo loaded.
-
 	CargoID cargo_type;                 ///< type of cargo this vehicle is carrying
 	byte cargo_subtype;                 ///< Used for livery refits (NewGRF variations)
 	uint16 cargo_cap;                   ///< total capacity
 	VehicleCargoList cargo;             ///< The cargo this vehicle is carrying
 
 	byte day_counter;                   ///< Increased by one for each day
-	byte tick_counter;                  ///< Increased by one for each tick
-	byte running_ticks;                 ///< Number of ticks this vehicle was not stopped this day
 
-	byte vehstatus;                     ///< Status
-	Order current_order;                ///< The current order (+ status, like: loading)
-	VehicleOrderID cur_real_order_index;///< The index to the current real (non-automatic) order
-	VehicleOrderID cur_auto_order_index;///< The index to the current automatic order
-
-	union {
-		OrderList *list;            ///< Pointer to the order list for this vehicle
-		Order     *old;             ///< Only used during conversion of old save games
-	} orders;                           ///< The orders currently assigned to the vehicle.
-
-	byte vehicle_flags;                 ///< Used for gradual loading and other miscellaneous things (@see VehicleFlags enum)
-
-	uint16 load_unload_ticks;           ///< Ticks to wait before starting next cycle.
 	GroupID group_id;                   ///< Index of group Pool array
-	byte subtype;                       ///< subtype (Filled with values from #EffectVehicles/#TrainSubTypes/#AircraftSubTypes)
 
 	NewGRFCache grf_cache;              ///< Cache of often used calculated NewGRF values
 	VehicleCache vcache;                ///< Cache of often used vehicle values.
@@ -560,7 +568,7 @@ public:
 		this->profit_this_year = src->profit_this_year;
 		this->profit_last_year = src->profit_last_year;
 
-		this->current_order_time = src->current_order_time;
+		this->current_order_time = src->current_order_time + GetSleptTicks(src);
 		this->lateness_counter = src->lateness_counter;
 		this->timetable_start = src->timetable_start;
 
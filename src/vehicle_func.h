@@ -36,10 +36,26 @@ void FindVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPos(TileIndex tile, void *data, VehicleFromPosProc *proc);
 bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc);
 void CallVehicleTicks();
+void SleepVehicle(Vehicle *v);
+void WakeVehicle(Vehicle *v);
+void WakeAllVehicles();
 uint8 CalcPercentVehicleFilled(const Vehicle *v, StringID *colour);
 
 byte VehicleRandomBits();
 void ResetVehiclePosHash();
+
+/** Statistics about the chains of a vehicle position hash. */
+struct VehicleHashStats {
+	uint buckets;      ///< Number of chains.
+	uint block_size;   ///< Number of tiles per side of the area covered by a chain; 0 if not tile based.
+	uint vehicles;     ///< Number of vehicles in the hash.
+	uint used_buckets; ///< Number of non-empty chains.
+	uint max_chain;    ///< Length of the longest chain.
+	uint64 lookups;    ///< Number of lookups so far.
+	uint64 visits;     ///< Number of vehicles visited in lookups so far.
+};
+
+void GetVehicleHashStats(VehicleHashStats *tile_hash, VehicleHashStats *viewport_hash);
 void ResetVehicleColourMap();
 
 byte GetBestFittingSubType(Vehicle *v_from, Vehicle *v_for);
@@ -162,6 +178,9 @@ extern VehicleID _new_vehicle_id;
 extern uint16 _returned_refit_capacity;
 extern uint16 _returned_mail_refit_capacity;
 extern byte _age_cargo_skip_counter;
+extern uint32 _vehicle_tick_epoch;
+extern uint8 _vehicle_tick_threads;
+extern bool _serial_vehicle_ticks;
 
 bool CanVehicleUseStation(EngineID engine_type, const struct Station *st);
 bool CanVehicleUseStation(const Vehicle *v, const struct Station *st);
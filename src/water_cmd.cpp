@@ -35,6 +35,7 @@
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
 #include "date_func.h"
+#include "pathfinder/water_regions.h"
 
 #include "table/strings.h"
 
@@ -136,6 +137,8 @@ CommandCost CmdBuildShipDepot(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 
 		MakeShipDepot(tile,  _current_company, depot->index, DEPOT_NORTH, axis, wc1);
 		MakeShipDepot(tile2, _current_company, depot->index, DEPOT_SOUTH, axis, wc2);
+		InvalidateWaterRegion(tile);
+		InvalidateWaterRegion(tile2);
 		MarkTileDirtyByTile(tile);
 		MarkTileDirtyByTile(tile2);
 		MakeDefaultName(depot);
@@ -245,6 +248,9 @@ static CommandCost DoBuildLock(TileIndex tile, DiagDirection dir, DoCommandFlag
 
 	if (flags & DC_EXEC) {
 		MakeLock(tile, _current_company, dir, wc_lower, wc_upper);
+		InvalidateWaterRegion(tile);
+		InvalidateWaterRegion(tile - delta);
+		InvalidateWaterRegion(tile + delta);
 		MarkTileDirtyByTile(tile);
 		MarkTileDirtyByTile(tile - delta);
 		MarkTileDirtyByTile(tile + delta);
@@ -1006,6 +1012,9 @@ void DoFloodTile(TileIndex target)
 	}
 
 	if (flooded) {
+		/* Ships may be able to sail on the flooded tile now */
+		InvalidateWaterRegion(target);
+
 		/* Mark surrounding canal tiles dirty too to avoid glitches */
 		MarkCanalsAndRiversAroundDirty(target);
 
@@ -1037,6 +1046,7 @@ static void DoDryUp(TileIndex tile)
 				default: NOT_REACHED();
 			}
 			SetRailGroundType(tile, new_ground);
+			InvalidateWaterRegion(tile);
 			MarkTileDirtyByTile(tile);
 			break;
 
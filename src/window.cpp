@@ -31,6 +31,7 @@
 #include "hotkeys.h"
 #include "toolbar_gui.h"
 #include "statusbar_gui.h"
+#include "tick_profile.h"
 
 
 static Point _drag_delta; ///< delta between mouse cursor and upper left corner of dragged window
@@ -2412,6 +2413,7 @@ void InputLoop()
  */
 void UpdateWindows()
 {
+	TickProfileTimer timer(TPS_WINDOWS);
 	Window *w;
 	static int we4_timer = 0;
 	int t = we4_timer + 1;